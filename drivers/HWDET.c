@@ -13,9 +13,40 @@
 * Major driver functions:
 *
 * 	o HWDET_initialize: initialize the peripheral into the correct mode
+*	o HWDET_LookupConfig / HWDET_CfgInitialize: set up a driver instance from xparameters.h
 * 	o HWDET_get_count: get the timer count for the high/low intervals
 *	o HWDET_calc_freq: capture a frequency reading from the sensor
+*	o HWDET_set_range: fixed or automatic prescaler range for very low frequencies
 *	o HWDET_calc_duty: calculate the duty cycle of the input signal
+*	o HWDET_get_snapshot: read high/low/period/sequence of one complete period
+*	o HWDET_get_measurement: frequency & duty cycle from one complete period
+*	o HWDET_get_edge_times: snapshot plus the 64-bit cycle count of both of its edges
+*	o HWDET_get_freq_hz: frequency computed by the hardware (single read, no divide)
+*	o HWDET_get_duty_q16: duty cycle computed by the hardware (single read, no divide)
+*	o HWDET_read_burst: drain every queued period from the sample FIFO
+*	o HWDET_SetHandler / HWDET_EnableInterrupt: measurement-ready interrupts
+*	o HWDET_get_freq_recip: high-resolution frequency from the reciprocal counter
+*	o HWDET_set_sync_window / HWDET_get_freq_sync: frequency over whole PWM carrier periods
+*	o HWDET_get_freq_estimate: frequency that reacts before a long period completes
+*	o HWDET_set_deglitch: reject short glitches on the input in hardware
+*	o HWDET_set_filter / HWDET_get_filtered_freq_hz: median & moving-average filtered frequency
+*	o HWDET_get_stats: period min/max/mean/variance over a window of periods
+*	o HWDET_read_histogram: read back the hardware period histogram
+*	o HWDET_get_counters: edge, period & overrun counters for tuning sample rates
+*	o HWDET_set_loopback: measure the internal pulse generator instead of the sensor
+*	o HWDET_stream_start / HWDET_stream_peek: capture every period into a DDR ring via AXI DMA
+*	o HWDET_ctl_start / HWDET_ctl_get_telemetry: bang-bang or PID loop closed in the fabric
+*	o HWDET_get_count_ch / HWDET_get_freq_hz_ch / ...: the same readings for any channel
+*	o HWDET_read_all: frequency & duty cycle of every channel in one call
+*	o HWDET_div_u32: divide by a measured period without a hardware divider
+*	o HWDET_duty_pct: duty cycle in % of any high interval & period
+*
+* The peripheral can be built with up to HWDET_MAX_CHANNELS inputs, each with its
+* own bank of registers. Functions without a _ch suffix work on channel 0.
+*
+* Every function takes a pointer to a HWDET instance, so several HWDET
+* peripherals can be used at the same time. HWDET_l.h has static inline
+* register accessors for reads in the control loop.
 */
 
 /****************************************************************************/
@@ -29,6 +60,7 @@
 #include "xparameters.h"
 #include "stdio.h"
 #include "xil_io.h"
+#include "xil_cache.h"
 #include "HWDET_l.h"
 #include "HWDET.h"
 
@@ -48,40 +80,392 @@
 #define LED_SCALING_FACTOR (1)
 #endif
 
-/****************************************************************************/
-/************************** Variable Definitions ****************************/
-/****************************************************************************/
+// Register reads to wait for the record stream to finish the record it is
+// sending, or for the AXI DMA to come out of reset (a few bus cycles each)
 
-// Need to provide the Base Address for the HWDET peripheral
-// so that memory reads & writes can be accomplished
+#ifndef HWDET_STREAM_POLLS
+#define HWDET_STREAM_POLLS (1000)
+#endif
+
+// Reciprocal seeds for HWDET_div_u32(): entry i is 2^24 / (257 + i), i.e.
+// 2^63 / d rounded down for the largest normalized divisor d in bin i, so
+// the seed never overestimates the reciprocal
 
-u32 HWDET_BaseAddress;
+static const u16 HWDET_recip_seed[256] = {
+	0xFF00, 0xFE03, 0xFD08, 0xFC0F, 0xFB18, 0xFA23, 0xF92F, 0xF83E,
+	0xF74E, 0xF660, 0xF574, 0xF489, 0xF3A0, 0xF2B9, 0xF1D4, 0xF0F0,
+	0xF00F, 0xEF2E, 0xEE50, 0xED73, 0xEC97, 0xEBBD, 0xEAE5, 0xEA0E,
+	0xE939, 0xE865, 0xE793, 0xE6C2, 0xE5F3, 0xE525, 0xE459, 0xE38E,
+	0xE2C4, 0xE1FC, 0xE135, 0xE070, 0xDFAC, 0xDEE9, 0xDE27, 0xDD67,
+	0xDCA8, 0xDBEB, 0xDB2F, 0xDA74, 0xD9BA, 0xD901, 0xD84A, 0xD794,
+	0xD6DF, 0xD62B, 0xD578, 0xD4C7, 0xD417, 0xD368, 0xD2BA, 0xD20D,
+	0xD161, 0xD0B6, 0xD00D, 0xCF64, 0xCEBC, 0xCE16, 0xCD71, 0xCCCC,
+	0xCC29, 0xCB87, 0xCAE5, 0xCA45, 0xC9A6, 0xC907, 0xC86A, 0xC7CE,
+	0xC732, 0xC698, 0xC5FE, 0xC565, 0xC4CE, 0xC437, 0xC3A1, 0xC30C,
+	0xC278, 0xC1E4, 0xC152, 0xC0C0, 0xC030, 0xBFA0, 0xBF11, 0xBE82,
+	0xBDF5, 0xBD69, 0xBCDD, 0xBC52, 0xBBC8, 0xBB3E, 0xBAB6, 0xBA2E,
+	0xB9A7, 0xB921, 0xB89B, 0xB817, 0xB793, 0xB70F, 0xB68D, 0xB60B,
+	0xB58A, 0xB509, 0xB48A, 0xB40B, 0xB38C, 0xB30F, 0xB292, 0xB216,
+	0xB19A, 0xB11F, 0xB0A5, 0xB02C, 0xAFB3, 0xAF3A, 0xAEC3, 0xAE4C,
+	0xADD5, 0xAD60, 0xACEB, 0xAC76, 0xAC02, 0xAB8F, 0xAB1C, 0xAAAA,
+	0xAA39, 0xA9C8, 0xA957, 0xA8E8, 0xA879, 0xA80A, 0xA79C, 0xA72F,
+	0xA6C2, 0xA655, 0xA5E9, 0xA57E, 0xA513, 0xA4A9, 0xA440, 0xA3D7,
+	0xA36E, 0xA306, 0xA29E, 0xA237, 0xA1D1, 0xA16B, 0xA105, 0xA0A0,
+	0xA03C, 0x9FD8, 0x9F74, 0x9F11, 0x9EAE, 0x9E4C, 0x9DEB, 0x9D89,
+	0x9D29, 0x9CC8, 0x9C69, 0x9C09, 0x9BAA, 0x9B4C, 0x9AEE, 0x9A90,
+	0x9A33, 0x99D7, 0x997A, 0x991F, 0x98C3, 0x9868, 0x980E, 0x97B4,
+	0x975A, 0x9701, 0x96A8, 0x964F, 0x95F7, 0x95A0, 0x9548, 0x94F2,
+	0x949B, 0x9445, 0x93EF, 0x939A, 0x9345, 0x92F1, 0x929C, 0x9249,
+	0x91F5, 0x91A2, 0x9150, 0x90FD, 0x90AB, 0x905A, 0x9009, 0x8FB8,
+	0x8F67, 0x8F17, 0x8EC7, 0x8E78, 0x8E29, 0x8DDA, 0x8D8B, 0x8D3D,
+	0x8CF0, 0x8CA2, 0x8C55, 0x8C08, 0x8BBC, 0x8B70, 0x8B24, 0x8AD8,
+	0x8A8D, 0x8A42, 0x89F8, 0x89AE, 0x8964, 0x891A, 0x88D1, 0x8888,
+	0x883F, 0x87F7, 0x87AF, 0x8767, 0x8720, 0x86D9, 0x8692, 0x864B,
+	0x8605, 0x85BF, 0x8579, 0x8534, 0x84EE, 0x84A9, 0x8465, 0x8421,
+	0x83DC, 0x8399, 0x8355, 0x8312, 0x82CF, 0x828C, 0x824A, 0x8208,
+	0x81C6, 0x8184, 0x8143, 0x8102, 0x80C1, 0x8080, 0x8040, 0x8000
+};
 
 /****************************************************************************/
 /************************** Driver Functions ********************************/
 /****************************************************************************/
 
+/********************** Divide without a hardware divider ******************/
+/**
+* Returns n / d rounded down, the same result as the C '/' operator, without
+* dividing. Selected by HWDET_DIV() when HWDET_DIV_RECIP is set.
+*
+* A MicroBlaze built without the optional hardware divider calls a library
+* routine for every '/', which loops once per quotient bit. Here the divisor
+* is normalized to [2^31, 2^32), a reciprocal seed good to 8 bits is looked up
+* in HWDET_recip_seed[] and refined with two Newton-Raphson steps to about 32
+* bits. The quotient is then n times the reciprocal, and a remainder check
+* fixes the last bit.
+*
+* @param	n is the dividend
+* @param	d is the divisor
+*
+* @return	n / d (0 if d is 0)
+*
+* @note		Every step rounds the reciprocal down, so the first estimate of
+* 			the quotient is never too large and is at most one below n / d.
+* @note		Uses only shifts, adds and 32x32 -> 64-bit multiplies.
+* 			software/divbench measures it against the '/' operator.
+*
+*****************************************************************************/
+
+u32 HWDET_div_u32(u32 n, u32 d) {
+
+	u32 dn 	= d;		// divisor normalized to [2^31, 2^32)
+	u32 s 	= 0;		// dn = d << s
+	u32 q 	= 0;
+	u32 r 	= 0;
+	u64 x 	= 0;		// 2^63 / dn, rounded down
+	u64 e 	= 0;		// 2^63 - dn * x, error of the reciprocal
+
+	if (d == 0) {
+		return 0;
+	}
+
+	// count leading zeros without a library call
+
+	if (!(dn & 0xFFFF0000)) { s += 16; dn <<= 16; }
+	if (!(dn & 0xFF000000)) { s += 8; dn <<= 8; }
+	if (!(dn & 0xF0000000)) { s += 4; dn <<= 4; }
+	if (!(dn & 0xC0000000)) { s += 2; dn <<= 2; }
+	if (!(dn & 0x80000000)) { s += 1; dn <<= 1; }
+
+	// seed from the 8 bits below the leading one, then x += x * e / 2^63
+	// twice (8 -> 16 -> 32 bits)
+
+	x = (u64) HWDET_recip_seed[(dn >> 23) & 0xFF] << 16;
+
+	e = (1ULL << 63) - (u64) dn * x;
+	x += (x * (e >> 32)) >> 31;
+
+	e = (1ULL << 63) - (u64) dn * x;
+	x += (x * (e >> 16)) >> 47;
+
+	// n / d = n * (2^63 / dn) / 2^(63 - s)
+
+	q = (u32) (((u64) n * x) >> (63 - s));
+	r = n - (q * d);
+
+	while (r >= d) {
+		q++;
+		r -= d;
+	}
+
+	return q;
+}
+
+/********************* Duty cycle of a measured period *********************/
+/**
+* Returns 100 * high / period rounded down (the duty cycle in %) for any
+* 32-bit high interval and period, dividing with HWDET_DIV().
+*
+* 100 * high only fits in 32 bits below about 43M clocks (0.43s at 100MHz).
+* For longer intervals the quotient is estimated from both values shifted
+* right by 7 bits and corrected with 64-bit multiplies, so a 64-bit divide
+* is never needed.
+*
+* @param	high is the high interval (the high count + 1)
+* @param	period is the period, in the same units as high
+*
+* @return	duty cycle in % (0 if period is 0, 100 if high >= period)
+*
+* @note		In the long case period >> 7 is at least 335k and the quotient
+* 			at most 100, so the estimate is off by at most one.
+*
+*****************************************************************************/
+
+u32 HWDET_duty_pct(u32 high, u32 period) {
+
+	u64 n 	= 100 * (u64) high;
+	u32 q 	= 0;
+
+	if (period == 0) {
+		return 0;
+	}
+
+	if (high >= period) {
+		return 100;
+	}
+
+	if (n <= 0xFFFFFFFF) {
+		return HWDET_DIV((u32) n, period);
+	}
+
+	q = HWDET_DIV((u32) (n >> 7), period >> 7);
+
+	while ((u64) q * period > n) {
+		q--;
+	}
+
+	while ((u64) (q + 1) * period <= n) {
+		q++;
+	}
+
+	return q;
+}
+
+/********************** Scale a period to a frequency **********************/
+/**
+* Converts a period measured in prescaled counts to a frequency.
+*
+* @param	clk_hz is the frequency of the measurement clock
+* @param	period is the period in counts of 2^range clock cycles
+* @param	range is the prescaler range the period was counted in
+*
+* @return	frequency in Hz (0 if period is 0)
+*
+* @note		Ranges above 0 only occur below about 0.1Hz. A scaled period that
+* 			no longer fits in 32 bits is longer than one second, so the
+* 			result is 0 and no 64-bit divide is needed.
+*
+*****************************************************************************/
+
+static unsigned int HWDET_scale_freq(u32 clk_hz, u32 period, u32 range) {
+
+	if (period == 0) {
+		return 0;
+	}
+
+	if (((u64) period << range) > clk_hz) {
+		return 0;
+	}
+
+	return HWDET_DIV(clk_hz, period << range);
+}
+
+/************************* Look up device configuration *******************/
+/**
+* Looks up the configuration of a HWDET device in the table generated from
+* xparameters.h (see HWDET_g.c).
+*
+* @param	DeviceId is the unique ID of the device (XPAR_HWDET_n_DEVICE_ID)
+*
+* @return	pointer to the device's configuration, or NULL if there is no
+* 			device with that ID
+*
+*****************************************************************************/
+
+HWDET_Config *HWDET_LookupConfig(u16 DeviceId) {
+
+	HWDET_Config *CfgPtr = NULL;
+	unsigned int i = 0;
+
+	for (i = 0; i < HWDET_NUM_INSTANCES; i++) {
+
+		if (HWDET_ConfigTable[i].DeviceId == DeviceId) {
+			CfgPtr = &HWDET_ConfigTable[i];
+			break;
+		}
+	}
+
+	return CfgPtr;
+}
+
+/******************* Initialize a driver instance **************************/
+/**
+* Initializes a HWDET instance from a device configuration. Reads the
+* number of channels and the measurement clock frequency from the peripheral
+* and leaves every interrupt source disabled and acknowledged. No self-tests
+* are run.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	Config is a pointer to the device configuration
+* @param	EffectiveAddr is the base address to use (normally
+* 			Config->BaseAddress, or the mapped address under an MMU)
+*
+* @return	XST_SUCCESS
+*
+* @note		The instance must not be used before this function returns.
+*
+*****************************************************************************/
+
+int HWDET_CfgInitialize(HWDET *InstancePtr, HWDET_Config *Config, u32 EffectiveAddr) {
+
+	unsigned int ch = 0;
+	u32 base = 0x00000000;
+
+	Xil_AssertNonvoid(InstancePtr != NULL);
+	Xil_AssertNonvoid(Config != NULL);
+
+	InstancePtr->IsReady = 0;
+	InstancePtr->DeviceId = Config->DeviceId;
+	InstancePtr->BaseAddress = EffectiveAddr;
+	InstancePtr->Handler = NULL;
+	InstancePtr->CallBackRef = NULL;
+	InstancePtr->Ring = NULL;
+	InstancePtr->RingRecords = 0;
+	InstancePtr->BlockRecords = 0;
+	InstancePtr->BdRing = NULL;
+	InstancePtr->DmaBaseAddress = 0;
+
+	InstancePtr->NumChannels = (HWDET_ReadReg(EffectiveAddr, HWDET_INFO_OFFSET) &
+								HWDET_INFO_NUM_CHANNELS_MASK) >> HWDET_INFO_NUM_CHANNELS_SHIFT;
+	InstancePtr->NumChannels = MAX(MIN(InstancePtr->NumChannels, HWDET_MAX_CHANNELS), 1);
+
+	// the channels may count in a clock of their own; bitstreams without the
+	// CLK_FREQ register read 0 there and count in the CPU clock
+
+	InstancePtr->ClockFreqHz = HWDET_ReadReg(EffectiveAddr, HWDET_CLK_FREQ_OFFSET);
+
+	if (InstancePtr->ClockFreqHz == 0) {
+		InstancePtr->ClockFreqHz = CPU_CLOCK_FREQ_HZ;
+	}
+
+	// start with all interrupts disabled and acknowledged
+
+	for (ch = 0; ch < HWDET_MAX_CHANNELS; ch++) {
+
+		InstancePtr->IrqEnabled[ch] = 0x00000000;
+
+		if (ch < InstancePtr->NumChannels) {
+			base = HWDET_mChannelBase(EffectiveAddr, ch);
+			HWDET_WriteReg(base, HWDET_IRQ_ENABLE_OFFSET, 0x00000000);
+			HWDET_WriteReg(base, HWDET_IRQ_STATUS_OFFSET, HWDET_IRQ_ALL_MASK);
+		}
+	}
+
+	// the record stream is stopped until HWDET_stream_start() is called
+
+	base = EffectiveAddr + HWDET_STREAM_BANK_OFFSET;
+
+	InstancePtr->StreamIrqEnabled = 0x00000000;
+	HWDET_WriteReg(base, HWDET_STREAM_CTRL_OFFSET, 0x00000000);
+	HWDET_WriteReg(base, HWDET_STREAM_IRQ_ENABLE_OFFSET, 0x00000000);
+	HWDET_WriteReg(base, HWDET_STREAM_IRQ_STATUS_OFFSET, HWDET_IRQ_STREAM_MASK >> HWDET_IRQ_STREAM_SHIFT);
+
+	// the AXI timer keeps the LED until HWDET_ctl_start() is called
+
+	HWDET_WriteReg(EffectiveAddr + HWDET_CTL_BANK_OFFSET, HWDET_CTL_CTRL_OFFSET, 0x00000000);
+
+	InstancePtr->IsReady = XIL_COMPONENT_IS_READY;
+
+	return XST_SUCCESS;
+}
+
 /****************** Initialization & Configuration ************************/
 /**
 * Initialize the HWDET peripheral driver
 *
-* Saves the Base address of the HWDET peripheral and runs the self-test
+* Looks up the device, initializes the instance and runs the self-tests on
+* every channel: a scratch register write/read test and an end-to-end
+* loopback test of the measurement path. Neither prints anything, and both
+* together take about 150us per channel, so they can run on every boot.
 *
-* @param	BaseAddr is the base address of the HWDET register set
+* The loopback data left behind by the test is discarded before returning.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	DeviceId is the unique ID of the device (XPAR_HWDET_n_DEVICE_ID)
 *
 * @return
-* 			- XST_SUCCESS	Initialization was successful.
-			- XST_FAILURE 	Initialization failed on memory read & write tests.
+* 			- XST_SUCCESS			Initialization was successful.
+*			- XST_DEVICE_NOT_FOUND	No device with that ID in xparameters.h
+*			- XST_FAILURE 			Initialization failed on memory read & write tests
+*									or on the loopback measurement test.
 *
 * @note		This function can hang if the peripheral was not created correctly
-* @note		The Base Address of the HWDET peripheral will be in xparameters.h
 *
 *****************************************************************************/
 
-int HWDET_initialize(u32 BaseAddr) {
+int HWDET_initialize(HWDET *InstancePtr, u16 DeviceId) {
+
+	XStatus status = XST_SUCCESS;
+	HWDET_Config *CfgPtr = NULL;
+	unsigned int ch = 0;
+	u32 base = 0x00000000;
+	u32 ctrl = 0x00000000;
+
+	CfgPtr = HWDET_LookupConfig(DeviceId);
+
+	if (CfgPtr == NULL) {
+		return XST_DEVICE_NOT_FOUND;
+	}
+
+	HWDET_CfgInitialize(InstancePtr, CfgPtr, CfgPtr->BaseAddress);
+
+	for (ch = 0; ch < InstancePtr->NumChannels; ch++) {
+
+		base = HWDET_mChannelBase(InstancePtr->BaseAddress, ch);
+
+		if (HWDET_Reg_SelfTest(base) != XST_SUCCESS) {
+			return XST_FAILURE;
+		}
+
+		if (HWDET_Loopback_SelfTest(base) != XST_SUCCESS) {
+			status = XST_FAILURE;
+		}
+
+		// throw away the loopback periods so they don't show up as sensor data
+
+		ctrl = HWDET_ReadReg(base, HWDET_FIFO_CTRL_OFFSET) & HWDET_FIFO_THRESHOLD_MASK;
+		HWDET_WriteReg(base, HWDET_FIFO_CTRL_OFFSET, ctrl | HWDET_FIFO_FLUSH_MASK | HWDET_FIFO_CLR_OVERFLOW_MASK);
+		HWDET_WriteReg(base, HWDET_STATS_COUNT_OFFSET, 0);
+		HWDET_WriteReg(base, HWDET_IRQ_STATUS_OFFSET, HWDET_IRQ_ALL_MASK);
+	}
+
+	return status;
+}
+
+/************************* Get number of channels **************************/
+/**
+* Returns the number of channels the HWDET peripheral was built with
+* (the NUM_CHANNELS parameter of the IP).
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+*
+* @return	number of channels, range [1 , HWDET_MAX_CHANNELS]
+*
+* @note		Valid after HWDET_initialize().
+*
+*****************************************************************************/
+
+unsigned int HWDET_get_num_channels(HWDET *InstancePtr) {
 
-	HWDET_BaseAddress = BaseAddr;
-	return HWDET_Reg_SelfTest(HWDET_BaseAddress);
+	return InstancePtr->NumChannels;
 }
 
 /******************** Get count for high / low interval ********************/	
@@ -93,6 +477,8 @@ int HWDET_initialize(u32 BaseAddr) {
 * This works through a simple read on the slv_reg0 / slv_reg_0 memory addresses,
 * which is at (BaseAddress + 0) / (BaseAddress + 4) respectively.
 *
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	ch is the channel to read (HWDET_get_count_ch only)
 * @param	Register to be read (valid inputs: HIGH, LOW)
 *
 * @return	Value of the high / low count register from hw_detect.v
@@ -104,18 +490,24 @@ int HWDET_initialize(u32 BaseAddr) {
 *
 *****************************************************************************/
 
-unsigned int HWDET_get_count(_HWDET_register reg) {
+unsigned int HWDET_get_count(HWDET *InstancePtr, _HWDET_register reg) {
+
+	return HWDET_get_count_ch(InstancePtr, 0, reg);
+}
+
+unsigned int HWDET_get_count_ch(HWDET *InstancePtr, unsigned int ch, _HWDET_register reg) {
 	
 	unsigned int count = 0x00000000;
+	u32 base = HWDET_mChannelBase(InstancePtr->BaseAddress, ch);
 
 	switch (reg) {
 
 		case HIGH: 
-			count = HWDET_mReadReg(HWDET_BaseAddress, HWDET_HIGH_COUNT_OFFSET);
+			count = HWDET_ReadHighCount(base);
 			break;
 
 		case LOW:
-			count = HWDET_mReadReg(HWDET_BaseAddress, HWDET_LOW_COUNT_OFFSET);
+			count = HWDET_ReadLowCount(base);
 			break;
 
 		default:
@@ -135,33 +527,46 @@ unsigned int HWDET_get_count(_HWDET_register reg) {
 * frequency of 500kHz without saturation, and a 0.4Hz frequency for
 * 0 uW/cm^2 light incidence.
 *
-* @param	None
+* The full period is read from the snapshot register, so this takes a
+* single bus read and can never mix intervals from two different periods.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	ch is the channel to read (HWDET_calc_freq_ch only)
 *
 * @return	output frequency of the TSL235R light sensor.
 * 			Provided as an unsigned integer in little-endian format.
 * 			Restricted to the range [0 , 10MEG] 
 *
 * @note		See the TSL235R datasheet for details on output characteristics.
+* @note		The period is converted with the measurement clock frequency the
+* 			peripheral reports in CLK_FREQ (read by HWDET_CfgInitialize()).
+* @note		Returns 0 until the first complete period has been measured, and
+* 			for a period that saturated the counter (the input is slower than
+* 			the prescaler range can measure).
 *
 *****************************************************************************/
 
-unsigned int HWDET_calc_freq(void) {
+unsigned int HWDET_calc_freq(HWDET *InstancePtr) {
 
-	unsigned int high_count = 0x00000000;
-	unsigned int low_count 	= 0x00000000;
-	unsigned int sum 		= 0x00000000;
-	unsigned int freq 		= 0x00000000;
+	return HWDET_calc_freq_ch(InstancePtr, 0);
+}
 
-	_HWDET_register reg_high = HIGH;
-	_HWDET_register reg_low = LOW;
+unsigned int HWDET_calc_freq_ch(HWDET *InstancePtr, unsigned int ch) {
 
-	high_count = HWDET_get_count(reg_high);
-	low_count = HWDET_get_count(reg_low);
+	unsigned int period 	= 0x00000000;
+	u32 range 				= 0x00000000;
+	u32 base = HWDET_mChannelBase(InstancePtr->BaseAddress, ch);
 
-	sum = (high_count + 1) + (low_count + 1);
-	freq = (CPU_CLOCK_FREQ_HZ / sum);
+	// the period must be read first --> it freezes the range it was counted in
 
-	return freq;
+	period = HWDET_ReadSnapPeriod(base);
+	range = HWDET_ReadReg(base, HWDET_RANGE_OFFSET);
+
+	if (range & HWDET_RANGE_SAT_MASK) {
+		return 0;
+	}
+
+	return HWDET_scale_freq(InstancePtr->ClockFreqHz, period, range & HWDET_RANGE_SNAP_MASK);
 }
 
 /*************** Calculate duty cycle from light intensity ***************/	
@@ -172,31 +577,1698 @@ unsigned int HWDET_calc_freq(void) {
 * the HWDET hardware module. The PWM signal should be limited to the 
 * range 1% - 100% by the pwm0 output from AXI Timer.
 *
-* @param	None
+* @param	InstancePtr is a pointer to the HWDET instance
 *
 * @return	output duty cycle of the TSL235R light sensor.
 * 			Provided as an unsigned integer in little-endian format.
 * 			Restricted to the range [1 , 100] 
 *
 * @note		See the TSL235R datasheet for details on output characteristics.
+* @note		Returns 0 until the first complete period has been measured.
 *
 *****************************************************************************/
 
-unsigned int HWDET_calc_duty(void) {
+unsigned int HWDET_calc_duty(HWDET *InstancePtr) {
 
-	unsigned int high_count = 0x00000000;
-	unsigned int low_count 	= 0x00000000;
-	unsigned int sum 		= 0x00000000;
 	unsigned int duty 		= 0x00000000;
-	
-	_HWDET_register reg_high = HIGH;
-	_HWDET_register reg_low = LOW;
 
-	high_count = HWDET_get_count(reg_high);
-	low_count = HWDET_get_count(reg_low);
-	
-	sum = (high_count + 1) + (low_count + 1);
-	duty = (100 * (high_count + 1)) / sum;
+	HWDET_get_measurement(InstancePtr, NULL, &duty);
 
 	return duty;
+}
+
+/****************** Read a coherent period snapshot ************************/
+/**
+* Reads the snapshot of the last complete period from the HWDET peripheral.
+*
+* hw_detect.v latches the high interval, low interval, full period and a
+* sequence number on every low-to-high transition. Reading the period
+* register freezes the other three values, so all of the fields in the
+* returned snapshot describe the same period.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	ch is the channel to read (HWDET_get_snapshot_ch only)
+* @param	snap is a pointer to the snapshot structure to fill in
+*
+* @return
+* 			- XST_SUCCESS	snapshot holds a complete period
+*			- XST_NO_DATA	no complete period has been measured yet
+*
+* @note		Comparing 'seq' between two calls shows how many periods
+* 			completed in between (0 means the same period was read twice).
+*
+*****************************************************************************/
+
+XStatus HWDET_get_snapshot(HWDET *InstancePtr, _HWDET_snapshot *snap) {
+
+	return HWDET_get_snapshot_ch(InstancePtr, 0, snap);
+}
+
+XStatus HWDET_get_snapshot_ch(HWDET *InstancePtr, unsigned int ch, _HWDET_snapshot *snap) {
+
+	u32 base = HWDET_mChannelBase(InstancePtr->BaseAddress, ch);
+
+	// the period must be read first --> it freezes the other registers
+
+	snap->period 	= HWDET_ReadReg(base, HWDET_SNAP_PERIOD_OFFSET);
+	snap->high 		= HWDET_ReadReg(base, HWDET_SNAP_HIGH_OFFSET);
+	snap->low 		= HWDET_ReadReg(base, HWDET_SNAP_LOW_OFFSET);
+	snap->seq 		= HWDET_ReadReg(base, HWDET_SNAP_SEQ_OFFSET);
+
+	return (snap->period != 0) ? XST_SUCCESS : XST_NO_DATA;
+}
+
+/************* Read a snapshot together with its edge times ****************/
+/**
+* Reads the snapshot of the last complete period along with the values of the
+* free-running 64-bit cycle counter at its two edges.
+*
+* The timestamps are frozen by the same read as the rest of the snapshot, so
+* they always belong to the returned period. The time between the rising
+* edges of two snapshots with consecutive 'seq' values equals the period, so
+* jitter and the phase of the input against the control loop can be measured
+* to one clock cycle (10ns at 100MHz) without software timestamps.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	ch is the channel to read (HWDET_get_edge_times_ch only)
+* @param	snap is a pointer to the snapshot structure to fill in
+* @param	times is a pointer to the edge times structure to fill in
+*
+* @return
+* 			- XST_SUCCESS	snapshot & edge times hold a complete period
+*			- XST_NO_DATA	no complete period has been measured yet
+*
+* @note		The deglitch filter and the input synchronizer delay both
+* 			edges by the same fixed number of clock cycles.
+*
+*****************************************************************************/
+
+XStatus HWDET_get_edge_times(HWDET *InstancePtr, _HWDET_snapshot *snap, _HWDET_edge_times *times) {
+
+	return HWDET_get_edge_times_ch(InstancePtr, 0, snap, times);
+}
+
+XStatus HWDET_get_edge_times_ch(HWDET *InstancePtr, unsigned int ch, _HWDET_snapshot *snap, _HWDET_edge_times *times) {
+
+	XStatus status = XST_SUCCESS;
+	u32 base = HWDET_mChannelBase(InstancePtr->BaseAddress, ch);
+
+	// reading the snapshot freezes the timestamps as well
+
+	status = HWDET_get_snapshot_ch(InstancePtr, ch, snap);
+
+	times->rise 	= HWDET_ReadReg(base, HWDET_RISE_TS_LO_OFFSET);
+	times->rise    |= (u64) HWDET_ReadReg(base, HWDET_RISE_TS_HI_OFFSET) << 32;
+	times->fall 	= HWDET_ReadReg(base, HWDET_FALL_TS_LO_OFFSET);
+	times->fall    |= (u64) HWDET_ReadReg(base, HWDET_FALL_TS_HI_OFFSET) << 32;
+
+	return status;
+}
+
+/********************** Read the 64-bit cycle counter **********************/
+/**
+* Returns the current value of the free-running 64-bit cycle counter that
+* timestamps the input edges. All channels share the same counter.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+*
+* @return	clock cycles since the peripheral came out of reset
+*
+* @note		Reading the lower half freezes the upper half, so the value
+* 			can't tear when the lower half wraps around between the reads.
+*
+*****************************************************************************/
+
+u64 HWDET_get_cycle_count(HWDET *InstancePtr) {
+
+	u64 count = 0;
+
+	count 	= HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_TIME_LO_OFFSET);
+	count  |= (u64) HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_TIME_HI_OFFSET) << 32;
+
+	return count;
+}
+
+/************ Calculate frequency & duty cycle from one snapshot ***********/
+/**
+* Returns the frequency (Hz) and duty cycle (%) of the sensor output, both
+* computed from the same complete period.
+*
+* Only three bus reads are needed (full period, then the frozen range and
+* high interval), compared to four for HWDET_calc_freq() followed by
+* HWDET_calc_duty() in the previous version of the driver.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	ch is the channel to read (HWDET_get_measurement_ch only)
+* @param	freq is a pointer to the frequency result (may be NULL)
+* @param	duty is a pointer to the duty cycle result (may be NULL)
+*
+* @return
+* 			- XST_SUCCESS	results are valid
+*			- XST_NO_DATA	no complete period yet, or the period saturated
+*							the counter; results are set to 0
+*
+*****************************************************************************/
+
+XStatus HWDET_get_measurement(HWDET *InstancePtr, unsigned int *freq, unsigned int *duty) {
+
+	return HWDET_get_measurement_ch(InstancePtr, 0, freq, duty);
+}
+
+XStatus HWDET_get_measurement_ch(HWDET *InstancePtr, unsigned int ch, unsigned int *freq, unsigned int *duty) {
+
+	unsigned int period 	= 0x00000000;
+	unsigned int high_count = 0x00000000;
+	u32 range 				= 0x00000000;
+	u32 base = HWDET_mChannelBase(InstancePtr->BaseAddress, ch);
+
+	// the period must be read first --> it freezes the range & high count
+
+	period = HWDET_ReadReg(base, HWDET_SNAP_PERIOD_OFFSET);
+	range = HWDET_ReadReg(base, HWDET_RANGE_OFFSET);
+
+	if ((period == 0) || (range & HWDET_RANGE_SAT_MASK)) {
+
+		if (freq != NULL) *freq = 0;
+		if (duty != NULL) *duty = 0;
+		return XST_NO_DATA;
+	}
+
+	if (freq != NULL) {
+		*freq = HWDET_scale_freq(InstancePtr->ClockFreqHz, period, range & HWDET_RANGE_SNAP_MASK);
+	}
+
+	// a saturated high count stays at 0xFFFFFFFF instead of wrapping to 0
+
+	if (duty != NULL) {
+		high_count = HWDET_ReadReg(base, HWDET_SNAP_HIGH_OFFSET);
+		*duty = HWDET_duty_pct((high_count == 0xFFFFFFFF) ? high_count : (high_count + 1), period);
+	}
+
+	return XST_SUCCESS;
+}
+
+/************** Get frequency from the hardware arithmetic unit ************/
+/**
+* Returns the output frequency of the TSL235R sensor in Hz, as computed by
+* the divider inside hw_detect.v from the last complete period.
+*
+* This is the fast path for the control loop: a single bus read and no
+* software division. The result matches HWDET_calc_freq() when the
+* peripheral's clock frequency register is correct.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	ch is the channel to read (HWDET_get_freq_hz_ch only)
+*
+* @return	output frequency of the TSL235R light sensor (Hz).
+* 			Returns 0 until the first complete period has been measured.
+*
+* @note		The hardware result trails the snapshot registers by about
+* 			50 clock cycles while the divider runs.
+*
+*****************************************************************************/
+
+unsigned int HWDET_get_freq_hz(HWDET *InstancePtr) {
+
+	return HWDET_get_freq_hz_ch(InstancePtr, 0);
+}
+
+unsigned int HWDET_get_freq_hz_ch(HWDET *InstancePtr, unsigned int ch) {
+
+	return HWDET_ReadFreqHz(HWDET_mChannelBase(InstancePtr->BaseAddress, ch));
+}
+
+/************** Get duty cycle from the hardware arithmetic unit ***********/
+/**
+* Returns the duty cycle of the sensor output as computed by the divider
+* inside hw_detect.v, either as a raw Q16 fraction (HWDET_get_duty_q16)
+* or in percent (HWDET_get_duty).
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	ch is the channel to read (HWDET_get_duty_q16_ch only)
+*
+* @return	HWDET_get_duty_q16:	duty cycle in Q16 (HWDET_DUTY_Q16_ONE = 100%)
+* 			HWDET_get_duty:		duty cycle in percent, range [0 , 100]
+*
+* @note		The percent conversion is a multiply and a shift, no division.
+*
+*****************************************************************************/
+
+unsigned int HWDET_get_duty_q16(HWDET *InstancePtr) {
+
+	return HWDET_get_duty_q16_ch(InstancePtr, 0);
+}
+
+unsigned int HWDET_get_duty_q16_ch(HWDET *InstancePtr, unsigned int ch) {
+
+	return HWDET_ReadDutyQ16(HWDET_mChannelBase(InstancePtr->BaseAddress, ch));
+}
+
+unsigned int HWDET_get_duty(HWDET *InstancePtr) {
+
+	unsigned int duty_q16 = 0x00000000;
+
+	duty_q16 = HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_DUTY_Q16_OFFSET);
+
+	return (100 * duty_q16) >> HWDET_DUTY_Q16_SHIFT;
+}
+
+/************** Read frequency & duty cycle of every channel ***************/
+/**
+* Copies the hardware frequency and duty cycle results of channels 0, 1, ...
+* into 'buf', one entry per channel.
+*
+* The hardware updates both values of a channel in the same clock, but they
+* are two separate bus reads, so an update can land between them. FREQ_HZ is
+* read again after DUTY_Q16 and the pair is read again if it changed, so
+* both values of a channel describe the same period. Each channel takes
+* three bus reads (more only when an update lands in between) and no
+* division.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	buf is a pointer to an array of at least 'max' readings
+* @param	max is the maximum number of channels to read
+*
+* @return	number of channels copied into 'buf'
+*
+* @note		The channels are read one after the other, so readings of
+* 			different channels are a few bus cycles apart.
+*
+*****************************************************************************/
+
+unsigned int HWDET_read_all(HWDET *InstancePtr, _HWDET_reading *buf, unsigned int max) {
+
+	unsigned int ch 	= 0x00000000;
+	u32 base 			= 0x00000000;
+
+	max = MIN(max, InstancePtr->NumChannels);
+
+	for (ch = 0; ch < max; ch++) {
+
+		base = HWDET_mChannelBase(InstancePtr->BaseAddress, ch);
+
+		// an unchanged frequency means the duty cycle read in between
+		// belongs to the same update
+
+		do {
+			buf[ch].freq_hz 	= HWDET_ReadFreqHz(base);
+			buf[ch].duty_q16 	= HWDET_ReadDutyQ16(base);
+		} while (HWDET_ReadFreqHz(base) != buf[ch].freq_hz);
+	}
+
+	return max;
+}
+
+/******************** Drain periods from the sample FIFO ********************/
+/**
+* Copies up to 'max' complete periods from the HWDET sample FIFO into 'buf',
+* oldest first. Every period that completes is queued in hardware, so no
+* period is lost as long as the FIFO is drained before it fills up.
+*
+* The FIFO level is read once and then the entries are drained in a tight
+* loop of two reads each (reading the 'low' register pops the FIFO).
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	buf is a pointer to an array of at least 'max' samples
+* @param	max is the maximum number of samples to copy
+*
+* @return	number of samples copied into 'buf'
+*
+* @note		Check HWDET_get_fifo_status() for HWDET_FIFO_OVERFLOW_MASK to
+* 			find out whether periods were dropped since the last clear.
+* @note		Meant to be called from a HWDET_IRQ_FIFO_THRESH_MASK callback
+* 			so the FIFO is drained without polling.
+*
+*****************************************************************************/
+
+unsigned int HWDET_read_burst(HWDET *InstancePtr, _HWDET_sample *buf, unsigned int max) {
+
+	unsigned int level 	= 0x00000000;
+	unsigned int n 		= 0x00000000;
+
+	level = HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_FIFO_STATUS_OFFSET) & HWDET_FIFO_LEVEL_MASK;
+	level = MIN(level, max);
+
+	for (n = 0; n < level; n++) {
+		buf[n].high = HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_FIFO_HIGH_OFFSET);
+		buf[n].low 	= HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_FIFO_LOW_OFFSET);
+	}
+
+	return level;
+}
+
+/******************** Sample FIFO status & control *************************/
+/**
+* Returns the sample FIFO status register, flushes the FIFO, clears the
+* sticky overflow flag or sets the interrupt threshold.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	threshold is the FIFO level that raises HWDET_IRQ_FIFO_THRESH_MASK
+* 			(0 disables the threshold event)
+*
+* @return	HWDET_get_fifo_status: FIFO status register. Use the
+* 			HWDET_FIFO_xxx_MASK bit masks in HWDET.h to decode it.
+*
+* @note		The flush / clear strobes share a register with the threshold,
+* 			so the threshold is written back with every strobe.
+*
+*****************************************************************************/
+
+u32 HWDET_get_fifo_status(HWDET *InstancePtr) {
+
+	return HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_FIFO_STATUS_OFFSET);
+}
+
+void HWDET_fifo_flush(HWDET *InstancePtr) {
+
+	u32 ctrl = HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_FIFO_CTRL_OFFSET) & HWDET_FIFO_THRESHOLD_MASK;
+
+	HWDET_WriteReg(InstancePtr->BaseAddress, HWDET_FIFO_CTRL_OFFSET, ctrl | HWDET_FIFO_FLUSH_MASK);
+}
+
+void HWDET_fifo_clear_overflow(HWDET *InstancePtr) {
+
+	u32 ctrl = HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_FIFO_CTRL_OFFSET) & HWDET_FIFO_THRESHOLD_MASK;
+
+	HWDET_WriteReg(InstancePtr->BaseAddress, HWDET_FIFO_CTRL_OFFSET, ctrl | HWDET_FIFO_CLR_OVERFLOW_MASK);
+}
+
+void HWDET_set_fifo_threshold(HWDET *InstancePtr, unsigned int threshold) {
+
+	HWDET_WriteReg(InstancePtr->BaseAddress, HWDET_FIFO_CTRL_OFFSET,
+					(threshold << HWDET_FIFO_THRESHOLD_SHIFT) & HWDET_FIFO_THRESHOLD_MASK);
+}
+
+/**************** Configure the reciprocal frequency counter ***************/
+/**
+* Enables or disables the reciprocal (multi-period) counter in hw_detect.v
+* and sets its gate time.
+*
+* In reciprocal mode the hardware counts whole input periods together with
+* the clock cycles they took. Each gate opens on a low-to-high transition and
+* closes on the first low-to-high transition after the gate time has
+* elapsed, so the result always covers an integer number of periods and the
+* +/- 1 count error is spread over all of them.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	enable turns the reciprocal counter on (true) or off (false)
+* @param	gate_time_us is the minimum gate time in microseconds
+*
+* @return	None
+*
+* @note		Resolution is roughly 1 / (gate time * measurement clock), e.g.
+* 			0.1 ppm of the reading for a 100ms gate at 100MHz.
+* @note		The first result is available one gate time after enabling.
+*
+*****************************************************************************/
+
+void HWDET_set_recip_mode(HWDET *InstancePtr, bool enable, unsigned int gate_time_us) {
+
+	u32 ctrl = HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_CTRL_OFFSET);
+
+	HWDET_WriteReg(InstancePtr->BaseAddress, HWDET_GATE_TIME_OFFSET,
+					gate_time_us * (InstancePtr->ClockFreqHz / 1000000));
+
+	if (enable) {
+		ctrl |= HWDET_CTRL_RECIP_EN_MASK;
+	}
+
+	else {
+		ctrl &= ~HWDET_CTRL_RECIP_EN_MASK;
+	}
+
+	HWDET_WriteReg(InstancePtr->BaseAddress, HWDET_CTRL_OFFSET, ctrl);
+}
+
+/****************** Read the reciprocal counter results ********************/
+/**
+* Reads the result of the last completed gate of the reciprocal counter.
+*
+* Reading the period count freezes the clock count, so both values always
+* come from the same gate.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	periods is a pointer to the number of whole input periods
+* @param	clocks is a pointer to the clock cycles taken by those periods
+*
+* @return
+* 			- XST_SUCCESS	results are valid
+*			- XST_NO_DATA	no gate has completed yet (or the mode is off)
+*
+*****************************************************************************/
+
+XStatus HWDET_get_recip_counts(HWDET *InstancePtr, u32 *periods, u32 *clocks) {
+
+	// the period count must be read first --> it freezes the clock count
+
+	*periods 	= HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_RECIP_PERIODS_OFFSET);
+	*clocks 	= HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_RECIP_CLOCKS_OFFSET);
+
+	return ((*periods != 0) && (*clocks != 0)) ? XST_SUCCESS : XST_NO_DATA;
+}
+
+/************* High-resolution frequency from the reciprocal counter *******/
+/**
+* Returns the input frequency in Hz, computed from the last gate of the
+* reciprocal counter as (periods * measurement clock) / clocks.
+*
+* Unlike HWDET_calc_freq(), which is limited to whole Hz and to the +/- 1
+* count error of a single period, the result has fractional resolution that
+* improves with the gate time set by HWDET_set_recip_mode().
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+*
+* @return	input frequency in Hz, or 0.0 if no gate has completed yet
+*
+*****************************************************************************/
+
+float HWDET_get_freq_recip(HWDET *InstancePtr) {
+
+	u32 periods 	= 0x00000000;
+	u32 clocks 		= 0x00000000;
+
+	if (HWDET_get_recip_counts(InstancePtr, &periods, &clocks) != XST_SUCCESS) {
+		return 0.0f;
+	}
+
+	return ((float) periods * (float) InstancePtr->ClockFreqHz) / (float) clocks;
+}
+
+/************** Configure the carrier-synchronous measurement **************/
+/**
+* Sets the length of the measurement windows that are locked to the PWM
+* carrier driving the LED, or turns them off.
+*
+* The peripheral's 'pwm_trig' input is the carrier itself. Each window opens
+* on a rising edge of the carrier and closes 'carrier_periods' rising edges
+* later, so the light ripple at the PWM frequency averages out of the reading
+* instead of showing up as noise that depends on the PWM phase.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	carrier_periods is the number of PWM periods per window (1 - 65535),
+* 			or 0 to turn the windows off
+*
+* @return	None
+*
+* @note		The window time is carrier_periods / PWM frequency, e.g. 1ms for
+* 			10 periods of a 10kHz carrier. It should cover several sensor
+* 			periods at the lowest light level that matters.
+* @note		The first result is available one window after enabling.
+*
+*****************************************************************************/
+
+void HWDET_set_sync_window(HWDET *InstancePtr, unsigned int carrier_periods) {
+
+	HWDET_WriteReg(InstancePtr->BaseAddress, HWDET_SYNC_PERIODS_OFFSET, MIN(carrier_periods, 0xFFFF));
+}
+
+/**************** Read the carrier-synchronous window results *************/
+/**
+* Reads the result of the last completed carrier-synchronous window.
+*
+* Reading the edge count freezes the other values, so all of them always
+* come from the same window.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	sync is a pointer to the structure that receives the window
+*
+* @return
+* 			- XST_SUCCESS	results are valid
+*			- XST_NO_DATA	no window has completed yet (or the mode is off)
+*
+*****************************************************************************/
+
+XStatus HWDET_get_sync_counts(HWDET *InstancePtr, _HWDET_sync *sync) {
+
+	// the edge count must be read first --> it freezes the other registers
+
+	sync->edges 	= HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_SYNC_EDGES_OFFSET);
+	sync->clocks 	= HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_SYNC_CLOCKS_OFFSET);
+	sync->span 		= HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_SYNC_SPAN_OFFSET);
+	sync->seq 		= HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_SYNC_SEQ_OFFSET);
+
+	return (sync->clocks != 0) ? XST_SUCCESS : XST_NO_DATA;
+}
+
+/*************** Frequency over whole PWM carrier periods ******************/
+/**
+* Returns the input frequency in Hz, measured over the last carrier-synchronous
+* window set up by HWDET_set_sync_window().
+*
+* The result is the number of whole sensor periods between the first and the
+* last sensor edge in the window divided by the time they took, which resolves
+* one clock like the reciprocal counter. A window with fewer than two edges
+* holds no whole period, so it gives no reading.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+*
+* @return	input frequency in Hz, or 0.0 if no window has completed yet or
+* 			the last window had fewer than two sensor edges in it (the input
+* 			is slower than the window; use HWDET_get_freq_hz() instead)
+*
+*****************************************************************************/
+
+float HWDET_get_freq_sync(HWDET *InstancePtr) {
+
+	_HWDET_sync sync;
+
+	if (HWDET_get_sync_counts(InstancePtr, &sync) != XST_SUCCESS) {
+		return 0.0f;
+	}
+
+	if ((sync.edges < 2) || (sync.span == 0)) {
+		return 0.0f;
+	}
+
+	return ((float) (sync.edges - 1) * (float) InstancePtr->ClockFreqHz) / (float) sync.span;
+}
+
+/******************** Interval in progress & staleness *********************/
+/**
+* Returns the running count of the interval in progress, the number of clock
+* cycles since the last complete period was measured, or whether the last
+* measurement is stale.
+*
+* The last measurement is stale once the period in progress has already
+* lasted longer than the last complete period. With the LED dim the sensor
+* period can be hundreds of milliseconds, so this can be true for a long time.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+*
+* @return	HWDET_get_live_count:	clock cycles in the interval in progress
+* 			HWDET_get_meas_age:		clock cycles since the last snapshot
+* 			HWDET_is_stale:			true if the snapshot is stale
+*
+* @note		The age saturates at 0xFFFFFFFF (about 43 seconds at 100MHz).
+*
+*****************************************************************************/
+
+unsigned int HWDET_get_live_count(HWDET *InstancePtr) {
+
+	return HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_LIVE_COUNT_OFFSET);
+}
+
+unsigned int HWDET_get_meas_age(HWDET *InstancePtr) {
+
+	return HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_MEAS_AGE_OFFSET);
+}
+
+bool HWDET_is_stale(HWDET *InstancePtr) {
+
+	return (HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_LIVE_STATUS_OFFSET) & HWDET_LIVE_STALE_MASK) != 0;
+}
+
+/************** Frequency estimate including the period in progress ********/
+/**
+* Returns the input frequency in Hz, taking the period in progress into
+* account.
+*
+* The period in progress is at least as long as the time since the last
+* complete period, so its age is a lower bound on the current period. While
+* that age is shorter than the last complete period this returns the same
+* value as HWDET_calc_freq(). Once the age is longer, it returns
+* (measurement clock) / age instead, an upper bound on the frequency that keeps
+* falling until the next edge arrives. A control loop can then react to a
+* falling light level right away instead of one period later.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+*
+* @return	estimated frequency of the TSL235R light sensor (Hz).
+* 			Returns 0 until the first complete period has been measured.
+*
+*****************************************************************************/
+
+unsigned int HWDET_get_freq_estimate(HWDET *InstancePtr) {
+
+	unsigned int period 	= 0x00000000;
+	unsigned int age 		= 0x00000000;
+	unsigned int freq 		= 0x00000000;
+	unsigned int age_freq 	= 0x00000000;
+
+	period = HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_SNAP_PERIOD_OFFSET);
+	age = HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_MEAS_AGE_OFFSET);
+
+	if (period == 0) {
+		return 0;
+	}
+
+	// the period is in prescaled counts, the age is always in clock cycles
+
+	freq = HWDET_scale_freq(InstancePtr->ClockFreqHz, period, HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_RANGE_OFFSET) & HWDET_RANGE_SNAP_MASK);
+
+	// divide once: MIN() evaluates its arguments twice
+
+	age_freq = HWDET_DIV(InstancePtr->ClockFreqHz, MAX(age, 1));
+
+	return MIN(freq, age_freq);
+}
+
+/********************** Configure the deglitch filter **********************/
+/**
+* Sets up the deglitch filter in front of the edge detector in hw_detect.v.
+*
+* In minimum pulse width mode a new input level is only accepted once it has
+* been held for 'width' consecutive clock cycles. In majority vote mode the
+* filter follows the majority of the last 'width' samples (at most 32).
+* Either way both edges are delayed by the same amount, so the measured
+* intervals are not changed by the filter itself.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	width is the filter width in clock cycles (0 bypasses the filter)
+* @param	majority selects majority vote (true) or minimum pulse width (false)
+*
+* @return	None
+*
+* @note		The width must stay well below the shortest real interval, e.g.
+* 			below 100 cycles (1us) for the 500kHz maximum of the TSL235R.
+*
+*****************************************************************************/
+
+void HWDET_set_deglitch(HWDET *InstancePtr, unsigned int width, bool majority) {
+
+	u32 reg = width & HWDET_DEGLITCH_WIDTH_MASK;
+
+	if (majority) {
+		reg |= HWDET_DEGLITCH_MAJORITY_MASK;
+	}
+
+	HWDET_WriteReg(InstancePtr->BaseAddress, HWDET_DEGLITCH_OFFSET, reg);
+}
+
+/************************ Read / clear glitch counters *********************/
+/**
+* Reads or clears the deglitch filter counters.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	pulses is a pointer to the number of pulses removed by the filter
+* @param	periods is a pointer to the number of complete periods that
+* 			contained at least one removed pulse
+*
+* @return	None
+*
+*****************************************************************************/
+
+void HWDET_get_glitch_counts(HWDET *InstancePtr, u32 *pulses, u32 *periods) {
+
+	*pulses 	= HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_GLITCH_COUNT_OFFSET);
+	*periods 	= HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_GLITCH_PERIODS_OFFSET);
+}
+
+void HWDET_clear_glitch_counts(HWDET *InstancePtr) {
+
+	HWDET_WriteReg(InstancePtr->BaseAddress, HWDET_GLITCH_COUNT_OFFSET, 0);
+}
+
+/******************** Configure the period filter **************************/
+/**
+* Sets up the median and moving-average filter that hw_detect.v applies to
+* every complete period before publishing HWDET_FILT_PERIOD_OFFSET and
+* HWDET_FILT_FREQ_HZ_OFFSET.
+*
+* The median removes single outliers (e.g. a period split by a missed
+* edge) without smearing a real change in frequency; the moving average then
+* lowers the noise of the reading. Changing the settings empties both windows.
+* The raw counts, the snapshot and HWDET_get_freq_hz() are not filtered.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	median is the median window in periods (0 or 1 = off, 3 or 5)
+* @param	avg_taps is the moving average window in periods (0 or 1 = off,
+* 			2, 4, 8 or 16)
+*
+* @return	XST_SUCCESS, or XST_INVALID_PARAM if either window is not
+* 			supported (the filter is left unchanged)
+*
+* @note		A step in frequency reaches the filtered reading after
+* 			(median / 2) + avg_taps periods.
+*
+*****************************************************************************/
+
+XStatus HWDET_set_filter(HWDET *InstancePtr, unsigned int median, unsigned int avg_taps) {
+
+	u32 ctrl = HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_CTRL_OFFSET);
+	unsigned int median_sel = 0;
+	unsigned int avg_log2 = 0;
+
+	switch (median) {
+		case 0:
+		case 1: median_sel = 0; break;
+		case 3: median_sel = 1; break;
+		case 5: median_sel = 2; break;
+		default: return XST_INVALID_PARAM;
+	}
+
+	if (avg_taps == 0) {
+		avg_taps = 1;
+	}
+
+	// reject long windows first, so the loop below ends and never shifts by 32
+
+	if (avg_taps > (1u << HWDET_CTRL_AVG_MAX_LOG2)) {
+		return XST_INVALID_PARAM;
+	}
+
+	while ((1u << avg_log2) < avg_taps) {
+		avg_log2++;
+	}
+
+	if ((1u << avg_log2) != avg_taps) {
+		return XST_INVALID_PARAM;
+	}
+
+	ctrl &= ~(HWDET_CTRL_MEDIAN_MASK | HWDET_CTRL_AVG_MASK);
+	ctrl |= (median_sel << HWDET_CTRL_MEDIAN_SHIFT) & HWDET_CTRL_MEDIAN_MASK;
+	ctrl |= (avg_log2 << HWDET_CTRL_AVG_SHIFT) & HWDET_CTRL_AVG_MASK;
+
+	HWDET_WriteReg(InstancePtr->BaseAddress, HWDET_CTRL_OFFSET, ctrl);
+
+	return XST_SUCCESS;
+}
+
+/********************** Read the filtered period ***************************/
+/**
+* Returns the period or frequency after the median and moving-average filter
+* set up by HWDET_set_filter(). With both stages off these follow the last
+* complete period, like HWDET_get_freq_hz().
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	ch is the channel to read (_ch variants only)
+*
+* @return	HWDET_get_filtered_period:	filtered period in clock cycles
+* 			HWDET_get_filtered_freq_hz:	frequency of the filtered period in Hz
+*
+*****************************************************************************/
+
+unsigned int HWDET_get_filtered_period(HWDET *InstancePtr) {
+
+	return HWDET_get_filtered_period_ch(InstancePtr, 0);
+}
+
+unsigned int HWDET_get_filtered_period_ch(HWDET *InstancePtr, unsigned int ch) {
+
+	return HWDET_ReadReg(HWDET_mChannelBase(InstancePtr->BaseAddress, ch), HWDET_FILT_PERIOD_OFFSET);
+}
+
+unsigned int HWDET_get_filtered_freq_hz(HWDET *InstancePtr) {
+
+	return HWDET_get_filtered_freq_hz_ch(InstancePtr, 0);
+}
+
+unsigned int HWDET_get_filtered_freq_hz_ch(HWDET *InstancePtr, unsigned int ch) {
+
+	return HWDET_ReadReg(HWDET_mChannelBase(InstancePtr->BaseAddress, ch), HWDET_FILT_FREQ_HZ_OFFSET);
+}
+
+/******************** Configure the statistics window **********************/
+/**
+* Sets the number of periods in each statistics window, or publishes and
+* clears the window in progress right away.
+*
+* The hardware keeps the minimum, maximum, sum and sum of squares of every
+* complete period. When the window is full the results are published, the
+* accumulators are cleared in the same clock and HWDET_IRQ_STATS_MASK is set.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	periods is the number of periods per window (0 publishes a window
+* 			only when HWDET_stats_latch() is called)
+*
+* @return	None
+*
+* @note		The 64-bit sum of squares wraps around once periods * max^2
+* 			reaches 2^64, e.g. 65536 periods of more than 2^24 cycles.
+*
+*****************************************************************************/
+
+void HWDET_set_stats_window(HWDET *InstancePtr, u32 periods) {
+
+	HWDET_WriteReg(InstancePtr->BaseAddress, HWDET_STATS_WINDOW_OFFSET, periods);
+}
+
+void HWDET_stats_latch(HWDET *InstancePtr) {
+
+	HWDET_WriteReg(InstancePtr->BaseAddress, HWDET_STATS_COUNT_OFFSET, 0);
+}
+
+/************************ Read the period statistics ***********************/
+/**
+* Reads the statistics of the last published window and computes the mean
+* and variance of the period (in clock cycles).
+*
+* Reading the count register freezes the others, so every field describes
+* the same window even if the hardware publishes a new one meanwhile.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	stats is a pointer to the statistics structure to fill in
+*
+* @return
+* 			- XST_SUCCESS	statistics are valid
+*			- XST_NO_DATA	no window has been published, or it was empty
+*
+* @note		The variance is computed in double precision because
+* 			sumsq / count and mean^2 are close to each other.
+*
+*****************************************************************************/
+
+XStatus HWDET_get_stats(HWDET *InstancePtr, _HWDET_stats *stats) {
+
+	double mean = 0.0;
+
+	// the count must be read first --> it freezes the other registers
+
+	stats->count 	= HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_STATS_COUNT_OFFSET);
+	stats->min 		= HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_STATS_MIN_OFFSET);
+	stats->max 		= HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_STATS_MAX_OFFSET);
+	stats->sum 		= HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_STATS_SUM_LO_OFFSET);
+	stats->sum 	   |= (u64) HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_STATS_SUM_HI_OFFSET) << 32;
+	stats->sumsq 	= HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_STATS_SUMSQ_LO_OFFSET);
+	stats->sumsq   |= (u64) HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_STATS_SUMSQ_HI_OFFSET) << 32;
+	stats->seq 		= HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_STATS_SEQ_OFFSET);
+
+	if (stats->count == 0) {
+
+		stats->mean = 0.0f;
+		stats->variance = 0.0f;
+		return XST_NO_DATA;
+	}
+
+	mean = (double) stats->sum / stats->count;
+
+	stats->mean = (float) mean;
+	stats->variance = (float) MAX(((double) stats->sumsq / stats->count) - (mean * mean), 0.0);
+
+	return XST_SUCCESS;
+}
+
+/********************* Configure the period histogram **********************/
+/**
+* Sets up the period histogram. Every complete period is counted in block RAM
+* by the hardware, so the distribution can be collected at full sensor rate.
+*
+* Bin 0 starts at 'offset' clock cycles and every bin is 2^shift cycles wide.
+* Periods below the first bin are counted in the first bin, and periods
+* beyond the last bin in the last bin.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	offset is the lower edge of the first bin in clock cycles
+* @param	shift sets the bin width to 2^shift clock cycles (0 - 31)
+* @param	enable starts (true) or stops (false) counting
+*
+* @return	None
+*
+* @note		Call HWDET_clear_histogram() after changing the bins, otherwise
+* 			the old counts stay in place.
+*
+*****************************************************************************/
+
+void HWDET_set_histogram(HWDET *InstancePtr, u32 offset, unsigned int shift, bool enable) {
+
+	u32 config = shift & HWDET_HIST_SHIFT_MASK;
+
+	if (enable) {
+		config |= HWDET_HIST_ENABLE_MASK;
+	}
+
+	HWDET_WriteReg(InstancePtr->BaseAddress, HWDET_HIST_OFFSET_OFFSET, offset);
+	HWDET_WriteReg(InstancePtr->BaseAddress, HWDET_HIST_CONFIG_OFFSET, config);
+}
+
+/********************** Clear the period histogram *************************/
+/**
+* Zeroes every bin of the period histogram and waits until the hardware has
+* finished (one clock cycle per bin).
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+*
+* @return	None
+*
+*****************************************************************************/
+
+void HWDET_clear_histogram(HWDET *InstancePtr) {
+
+	HWDET_WriteReg(InstancePtr->BaseAddress, HWDET_HIST_STATUS_OFFSET, HWDET_HIST_CLEAR_MASK);
+
+	while (HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_HIST_STATUS_OFFSET) & HWDET_HIST_BUSY_MASK) {
+		;
+	}
+}
+
+/********************** Read the period histogram **************************/
+/**
+* Returns the number of bins in the histogram, or copies the counts of up to
+* 'max' bins, starting at bin 'first', into 'bins'.
+*
+* The bin address is written once; the hardware advances it on every read,
+* so each bin costs a single bus read.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	bins is a pointer to an array of at least 'max' counts
+* @param	first is the first bin to read
+* @param	max is the maximum number of bins to read
+*
+* @return	HWDET_get_histogram_bins:	number of bins in the hardware
+* 			HWDET_read_histogram:		number of bins copied into 'bins'
+*
+* @note		Counting continues while the bins are read; disable the
+* 			histogram first for a snapshot of a single moment.
+*
+*****************************************************************************/
+
+unsigned int HWDET_get_histogram_bins(HWDET *InstancePtr) {
+
+	return (HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_HIST_STATUS_OFFSET) & HWDET_HIST_LAST_BIN_MASK) + 1;
+}
+
+unsigned int HWDET_read_histogram(HWDET *InstancePtr, u32 *bins, unsigned int first, unsigned int max) {
+
+	unsigned int nbins 	= 0x00000000;
+	unsigned int n 		= 0x00000000;
+
+	nbins = HWDET_get_histogram_bins(InstancePtr);
+
+	if (first >= nbins) {
+		return 0;
+	}
+
+	max = MIN(max, nbins - first);
+
+	HWDET_WriteReg(InstancePtr->BaseAddress, HWDET_HIST_ADDR_OFFSET, first);
+
+	for (n = 0; n < max; n++) {
+		bins[n] = HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_HIST_DATA_OFFSET);
+	}
+
+	return max;
+}
+
+/********************** Read instrumentation counters **********************/
+/**
+* Reads the HWDET instrumentation counters.
+*
+* 'overruns' counts the periods whose snapshot was replaced before software
+* read it, either directly (HWDET_get_snapshot(), HWDET_calc_freq(), etc.) or
+* through the hardware results (HWDET_get_freq_hz(), HWDET_read_all()), so a
+* growing value means the polling rate is too low. 'new_periods' is the
+* number of periods completed since the last call; 0 means the last
+* reading is being read again.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	counters is a pointer to the counter structure to fill in
+*
+* @return	None
+*
+* @note		Reading 'new_periods' clears it in hardware, so only one piece
+* 			of code should call this function.
+*
+*****************************************************************************/
+
+void HWDET_get_counters(HWDET *InstancePtr, _HWDET_counters *counters) {
+
+	counters->new_periods 	= HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_NEW_PERIODS_OFFSET);
+	counters->edges 		= HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_EDGE_COUNT_OFFSET);
+	counters->periods 		= HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_PERIOD_COUNT_OFFSET);
+	counters->overruns 		= HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_OVERRUN_COUNT_OFFSET);
+}
+
+/********************** Configure the prescaler range **********************/
+/**
+* Sets how fast the interval counter in hw_detect.v runs. In range n the
+* counter advances once every 2^n clock cycles, so the longest interval it
+* can hold is 2^(32 + n) clock cycles.
+*
+* With auto ranging the hardware moves up one range when an interval gets
+* close to saturating the counter and down one range when a whole period
+* fits in 2^28 counts, so the full output range of the TSL235R (0.4Hz dark
+* output up to 500kHz) is measured without a rebuild. HWDET_calc_freq()
+* takes the range of each snapshot into account.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	auto_range selects automatic (true) or fixed (false) ranging
+* @param	range is the fixed range, 0 to HWDET_RANGE_MAX (ignored with
+* 			auto ranging)
+*
+* @return	None
+*
+* @note		The range only changes on a rising edge of the input.
+* @note		Snapshot counts and the sample FIFO are in prescaled counts. Use
+* 			a fixed range of 0 (the default) when those must be in clock
+* 			cycles. The statistics, histogram and period filter are always
+* 			in clock cycles (saturating at 2^32 - 1 above about 43 seconds
+* 			at 100MHz), so their windows can span a range change.
+*
+*****************************************************************************/
+
+void HWDET_set_range(HWDET *InstancePtr, bool auto_range, unsigned int range) {
+
+	u32 ctrl = HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_CTRL_OFFSET);
+
+	ctrl &= ~(HWDET_CTRL_AUTO_RANGE_MASK | HWDET_CTRL_RANGE_MASK);
+	ctrl |= (MIN(range, HWDET_RANGE_MAX) << HWDET_CTRL_RANGE_SHIFT) & HWDET_CTRL_RANGE_MASK;
+
+	if (auto_range) {
+		ctrl |= HWDET_CTRL_AUTO_RANGE_MASK;
+	}
+
+	HWDET_WriteReg(InstancePtr->BaseAddress, HWDET_CTRL_OFFSET, ctrl);
+}
+
+/************************ Read the prescaler range *************************/
+/**
+* Returns the prescaler range status of the peripheral.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+*
+* @return	the RANGE register: HWDET_RANGE_SNAP_MASK holds the range of the
+* 			snapshot frozen by the last SNAP_PERIOD read, HWDET_RANGE_SAT_MASK
+* 			is set if that snapshot saturated the counter and
+* 			HWDET_RANGE_CURRENT_MASK holds the range in use now
+*
+*****************************************************************************/
+
+unsigned int HWDET_get_range(HWDET *InstancePtr) {
+
+	return HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_RANGE_OFFSET);
+}
+
+/******************** Loopback pulse generator control *********************/
+/**
+* Switches the input of hw_detect.v between the external PWM input and the
+* internal pulse generator, and sets the generator's pattern.
+*
+* Useful for calibration and for checking the measurement path without the
+* light sensor: the generator output is 'high' for exactly 'high' clock
+* cycles and 'low' for exactly 'low' clock cycles.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	enable selects the pulse generator (true) or pwm_in (false)
+* @param	high is the 'high' time in clock cycles (0 is treated as 1)
+* @param	low is the 'low' time in clock cycles (0 is treated as 1)
+*
+* @return	None
+*
+*****************************************************************************/
+
+void HWDET_set_loopback(HWDET *InstancePtr, bool enable, u32 high, u32 low) {
+
+	u32 ctrl = HWDET_ReadReg(InstancePtr->BaseAddress, HWDET_CTRL_OFFSET);
+
+	HWDET_WriteReg(InstancePtr->BaseAddress, HWDET_PATGEN_HIGH_OFFSET, high);
+	HWDET_WriteReg(InstancePtr->BaseAddress, HWDET_PATGEN_LOW_OFFSET, low);
+
+	if (enable) {
+		ctrl |= HWDET_CTRL_LOOPBACK_MASK;
+	}
+
+	else {
+		ctrl &= ~HWDET_CTRL_LOOPBACK_MASK;
+	}
+
+	HWDET_WriteReg(InstancePtr->BaseAddress, HWDET_CTRL_OFFSET, ctrl);
+}
+
+/******************* Start / stop the DDR record stream ********************/
+/**
+* Starts sending every complete period of one channel out of the peripheral's
+* AXI4-Stream port, for an AXI DMA to write into a ring buffer in DDR.
+*
+* Each period becomes one _HWDET_record (16 bytes). The stream ends a DMA
+* block (TLAST) after every 'block_records' records. This function resets the
+* AXI DMA, builds one scatter-gather descriptor per block in 'bd_ring', covering
+* 'ring' in order, and runs the DMA's S2MM channel in cyclic mode over them, so
+* the DMA always starts at the first descriptor when the ring starts at slot 0.
+*
+* The peripheral keeps the head of the ring and stops sending (counting the
+* periods it drops) when the ring is full, so unread records are never
+* overwritten. Software reads records with HWDET_stream_peek() and frees them
+* with HWDET_stream_consume().
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	ch is the channel whose periods are captured
+* @param	ring is the ring buffer the DMA writes to (cache line aligned)
+* @param	ring_records is the size of the ring in records; it holds at
+* 			most ring_records - 1 unread records
+* @param	block_records is the number of records per DMA descriptor;
+* 			ring_records must be a multiple of it and hold at least two
+* 			blocks (the peripheral keeps one slot free, so the last record
+* 			of a one-block ring would never be sent and the block never
+* 			completed)
+* @param	dma_base is the base address of the AXI DMA (scatter-gather)
+* 			whose S2MM channel takes the record stream
+* @param	bd_ring is the memory for the descriptors: HWDET_DMA_BD_SIZE
+* 			bytes per block, aligned to HWDET_DMA_BD_SIZE bytes
+*
+* @return	XST_SUCCESS, XST_INVALID_PARAM if the arguments don't describe
+* 			a usable ring, or XST_DEVICE_BUSY if the last record of an
+* 			earlier run never left the peripheral or the DMA did not come
+* 			out of reset (the stream is left stopped)
+*
+* @note		The soft reset resets the whole AXI DMA, so its MM2S channel
+* 			should not be used for anything else. A record is only returned
+* 			by HWDET_stream_peek() once its block is complete, so a small
+* 			'block_records' gives records to software sooner.
+*
+* 			HWDET_IRQ_STREAM_HALF_MASK and HWDET_IRQ_STREAM_FULL_MASK can be
+* 			enabled with HWDET_EnableInterrupt() to service the ring.
+*
+*****************************************************************************/
+
+XStatus HWDET_stream_start(HWDET *InstancePtr, unsigned int ch, _HWDET_record *ring,
+							unsigned int ring_records, unsigned int block_records,
+							u32 dma_base, u32 *bd_ring) {
+
+	u32 base = InstancePtr->BaseAddress + HWDET_STREAM_BANK_OFFSET;
+	unsigned int blocks = 0;
+	unsigned int i = 0;
+	u32 *bd = NULL;
+	int polls = 0;
+
+	if ((ring == NULL) || (bd_ring == NULL) || (ch >= InstancePtr->NumChannels) ||
+		(block_records == 0) || (ring_records < (2 * block_records)) || ((ring_records % block_records) != 0) ||
+		((block_records * sizeof(_HWDET_record)) > HWDET_DMA_BD_LENGTH_MASK) ||
+		(((UINTPTR) bd_ring % HWDET_DMA_BD_SIZE) != 0)) {
+		HWDET_WriteReg(base, HWDET_STREAM_CTRL_OFFSET, 0x00000000);
+		return XST_INVALID_PARAM;
+	}
+
+	// the record in flight has to reach the old DMA run before the DMA is reset,
+	// or its last beats would land at the start of the new ring
+
+	if (HWDET_stream_stop(InstancePtr) != XST_SUCCESS) {
+		return XST_DEVICE_BUSY;
+	}
+
+	HWDET_WriteReg(dma_base, HWDET_DMA_S2MM_DMACR_OFFSET, HWDET_DMA_CR_RESET_MASK);
+
+	for (polls = HWDET_STREAM_POLLS; polls > 0; polls--) {
+		if ((HWDET_ReadReg(dma_base, HWDET_DMA_S2MM_DMACR_OFFSET) & HWDET_DMA_CR_RESET_MASK) == 0) {
+			break;
+		}
+	}
+
+	if (polls == 0) {
+		return XST_DEVICE_BUSY;
+	}
+
+	InstancePtr->Ring = ring;
+	InstancePtr->RingRecords = ring_records;
+	InstancePtr->BlockRecords = block_records;
+	InstancePtr->BdRing = bd_ring;
+	InstancePtr->DmaBaseAddress = dma_base;
+
+	// one descriptor per block, the last one pointing back to the first
+
+	blocks = ring_records / block_records;
+
+	for (i = 0; i < blocks; i++) {
+
+		bd = &bd_ring[i * HWDET_DMA_BD_WORDS];
+
+		bd[HWDET_DMA_BD_NXTDESC] = (u32) (UINTPTR) &bd_ring[((i + 1) % blocks) * HWDET_DMA_BD_WORDS];
+		bd[HWDET_DMA_BD_NXTDESC_MSB] = 0;
+		bd[HWDET_DMA_BD_BUFFER] = (u32) (UINTPTR) &ring[i * block_records];
+		bd[HWDET_DMA_BD_BUFFER_MSB] = 0;
+		bd[HWDET_DMA_BD_CONTROL] = block_records * sizeof(_HWDET_record);
+		bd[HWDET_DMA_BD_STATUS] = 0;
+	}
+
+	Xil_DCacheFlushRange((UINTPTR) bd_ring, blocks * HWDET_DMA_BD_SIZE);
+	Xil_DCacheFlushRange((UINTPTR) ring, ring_records * sizeof(_HWDET_record));
+
+	// the peripheral is idle, so the clear takes effect at once
+
+	HWDET_WriteReg(base, HWDET_STREAM_RING_SIZE_OFFSET, ring_records);
+	HWDET_WriteReg(base, HWDET_STREAM_BLOCK_LEN_OFFSET, block_records);
+	HWDET_WriteReg(base, HWDET_STREAM_CTRL_OFFSET, HWDET_STREAM_CLEAR_MASK);
+
+	// in cyclic mode the DMA is started by a tail descriptor outside the chain
+
+	HWDET_WriteReg(dma_base, HWDET_DMA_S2MM_CURDESC_OFFSET, (u32) (UINTPTR) bd_ring);
+	HWDET_WriteReg(dma_base, HWDET_DMA_S2MM_CURDESC_MSB_OFFSET, 0);
+	HWDET_WriteReg(dma_base, HWDET_DMA_S2MM_DMACR_OFFSET, HWDET_DMA_CR_RUN_MASK | HWDET_DMA_CR_CYCLIC_MASK);
+	HWDET_WriteReg(dma_base, HWDET_DMA_S2MM_TAILDESC_MSB_OFFSET, 0);
+	HWDET_WriteReg(dma_base, HWDET_DMA_S2MM_TAILDESC_OFFSET,
+					(u32) (UINTPTR) &bd_ring[blocks * HWDET_DMA_BD_WORDS]);
+
+	HWDET_WriteReg(base, HWDET_STREAM_CTRL_OFFSET, HWDET_STREAM_ENABLE_MASK |
+					((ch << HWDET_STREAM_SOURCE_SHIFT) & HWDET_STREAM_SOURCE_MASK));
+
+	return XST_SUCCESS;
+}
+
+/**
+* Stops the record stream and waits for the record being sent to reach the
+* DMA. The ring and the DMA are left as they are; HWDET_stream_start() resets
+* both.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+*
+* @return	XST_SUCCESS, or XST_DEVICE_BUSY if the DMA stopped taking the
+* 			stream in the middle of a record
+*
+*****************************************************************************/
+
+XStatus HWDET_stream_stop(HWDET *InstancePtr) {
+
+	u32 base = InstancePtr->BaseAddress + HWDET_STREAM_BANK_OFFSET;
+	int polls = 0;
+
+	HWDET_WriteReg(base, HWDET_STREAM_CTRL_OFFSET, 0x00000000);
+
+	for (polls = HWDET_STREAM_POLLS; polls > 0; polls--) {
+		if ((HWDET_ReadReg(base, HWDET_STREAM_CTRL_OFFSET) & HWDET_STREAM_BUSY_MASK) == 0) {
+			return XST_SUCCESS;
+		}
+	}
+
+	return XST_DEVICE_BUSY;
+}
+
+/******************* Read records from the DDR ring ************************/
+/**
+* HWDET_stream_peek() returns the unread records at the tail of the ring,
+* in place: nothing is copied. Only the records of blocks the DMA has marked
+* complete in their descriptors are returned, since the head moves when the
+* DMA accepts a record, before it is in DDR. Records up to the end of the
+* ring are returned; the ones that wrapped around to the start are returned
+* by the next call. The data cache is invalidated over the returned records.
+*
+* HWDET_stream_consume() hands 'count' records back to the peripheral once
+* they have been processed, so the DMA can fill their slots again. The
+* descriptor of every block it frees is marked not complete first, so the
+* block is only seen as complete again once the DMA has refilled it.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	records is set to the oldest unread record
+* @param	count is the number of records to free (at most the number
+* 			returned by the last HWDET_stream_peek())
+*
+* @return	HWDET_stream_peek: number of records at 'records'
+*
+*****************************************************************************/
+
+unsigned int HWDET_stream_peek(HWDET *InstancePtr, _HWDET_record **records) {
+
+	u32 base = InstancePtr->BaseAddress + HWDET_STREAM_BANK_OFFSET;
+	u32 head = 0x00000000;
+	u32 tail = 0x00000000;
+	u32 *bd = NULL;
+	unsigned int block = 0;
+	unsigned int count = 0;
+	unsigned int done = 0;
+
+	*records = NULL;
+
+	if (InstancePtr->Ring == NULL) {
+		return 0;
+	}
+
+	head = HWDET_ReadReg(base, HWDET_STREAM_HEAD_OFFSET);
+	tail = HWDET_ReadReg(base, HWDET_STREAM_TAIL_OFFSET);
+
+	count = (head >= tail) ? (head - tail) : (InstancePtr->RingRecords - tail);
+
+	// walk the descriptors from the tail's block while they are complete
+
+	block = tail / InstancePtr->BlockRecords;
+
+	while (done < count) {
+
+		bd = &InstancePtr->BdRing[block * HWDET_DMA_BD_WORDS];
+		Xil_DCacheInvalidateRange((UINTPTR) bd, HWDET_DMA_BD_SIZE);
+
+		if ((bd[HWDET_DMA_BD_STATUS] & HWDET_DMA_BD_STS_CMPLT_MASK) == 0) {
+			break;
+		}
+
+		block++;
+		done = (block * InstancePtr->BlockRecords) - tail;
+	}
+
+	count = MIN(count, done);
+
+	if (count > 0) {
+		*records = &InstancePtr->Ring[tail];
+		Xil_DCacheInvalidateRange((UINTPTR) *records, count * sizeof(_HWDET_record));
+	}
+
+	return count;
+}
+
+void HWDET_stream_consume(HWDET *InstancePtr, unsigned int count) {
+
+	u32 base = InstancePtr->BaseAddress + HWDET_STREAM_BANK_OFFSET;
+	u32 tail = HWDET_ReadReg(base, HWDET_STREAM_TAIL_OFFSET);
+	u32 *bd = NULL;
+	unsigned int block = tail / InstancePtr->BlockRecords;
+	unsigned int blocks = InstancePtr->RingRecords / InstancePtr->BlockRecords;
+	unsigned int n = 0;
+
+	// descriptors go back to 'not complete' before the tail lets the DMA refill them
+
+	for (n = count + (tail % InstancePtr->BlockRecords); n >= InstancePtr->BlockRecords;
+		 n -= InstancePtr->BlockRecords) {
+
+		bd = &InstancePtr->BdRing[block * HWDET_DMA_BD_WORDS];
+		bd[HWDET_DMA_BD_STATUS] = 0;
+		Xil_DCacheFlushRange((UINTPTR) bd, HWDET_DMA_BD_SIZE);
+
+		block = (block + 1 >= blocks) ? 0 : block + 1;
+	}
+
+	tail += count;
+
+	if (tail >= InstancePtr->RingRecords) {
+		tail -= InstancePtr->RingRecords;
+	}
+
+	HWDET_WriteReg(base, HWDET_STREAM_TAIL_OFFSET, tail);
+}
+
+/******************** Read the dropped record counter **********************/
+/**
+* Returns the number of periods that were not sent to the ring because it
+* was full (or the previous record was still being sent), and clears it.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+*
+* @return	number of periods dropped since the last call
+*
+*****************************************************************************/
+
+u32 HWDET_stream_get_dropped(HWDET *InstancePtr) {
+
+	u32 base = InstancePtr->BaseAddress + HWDET_STREAM_BANK_OFFSET;
+	u32 dropped = HWDET_ReadReg(base, HWDET_STREAM_DROPPED_OFFSET);
+
+	HWDET_WriteReg(base, HWDET_STREAM_DROPPED_OFFSET, 0);
+
+	return dropped;
+}
+
+/**************** Set up the PWM of the closed-loop controller *************/
+/**
+* Sets the PWM frequency of the closed-loop controller and the range its duty
+* cycle is allowed to move in.
+*
+* The controller has a PWM generator of its own, counting in the measurement
+* clock, so no AXI timer write is needed for the loop to change the LED.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	pwm_freq_hz is the PWM frequency in Hz
+* @param	min_duty is the lowest duty cycle the controller may use (%)
+* @param	max_duty is the highest duty cycle the controller may use (%)
+*
+* @return	XST_SUCCESS, or XST_INVALID_PARAM if the frequency is out of range
+* 			or min_duty > max_duty
+*
+* @note		The PID output and HWDET_ctl_set_pid()'s bias are in clock cycles
+* 			of the PWM period, which is ClockFreqHz / pwm_freq_hz cycles.
+*
+*****************************************************************************/
+
+XStatus HWDET_ctl_set_pwm(HWDET *InstancePtr, u32 pwm_freq_hz, unsigned int min_duty, unsigned int max_duty) {
+
+	u32 base = InstancePtr->BaseAddress + HWDET_CTL_BANK_OFFSET;
+	u32 period = 0x00000000;
+
+	if ((pwm_freq_hz == 0) || (pwm_freq_hz > InstancePtr->ClockFreqHz / 2) || (min_duty > max_duty)) {
+		return XST_INVALID_PARAM;
+	}
+
+	period = InstancePtr->ClockFreqHz / pwm_freq_hz;
+
+	HWDET_WriteReg(base, HWDET_CTL_PWM_PERIOD_OFFSET, period);
+	HWDET_WriteReg(base, HWDET_CTL_OUT_MIN_OFFSET, (u32) (((u64) period * MIN(min_duty, 100)) / 100));
+	HWDET_WriteReg(base, HWDET_CTL_OUT_MAX_OFFSET, (u32) (((u64) period * MIN(max_duty, 100)) / 100));
+
+	return XST_SUCCESS;
+}
+
+/****************** Set the controller setpoint & gains ********************/
+/**
+* HWDET_ctl_set_setpoint() sets the sensor frequency the controller holds.
+* It can be changed while the controller is running.
+*
+* HWDET_ctl_set_pid() sets the PID law:
+*
+*	out = bias + ((kp * e + ki * sum(e) + kd * (e - e_last)) >> gain_shift)
+*
+* with e = setpoint - frequency in Hz, clamped to the duty cycle range of
+* HWDET_ctl_set_pwm(). gain_shift sets the binary point of the gains, e.g.
+* kp = 384 with gain_shift = 8 is a gain of 1.5.
+*
+* HWDET_ctl_set_hysteresis() sets the dead band of the bang-bang law: the LED
+* goes fully on below setpoint - hysteresis and fully off above setpoint +
+* hysteresis.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	setpoint_hz is the target sensor frequency in Hz
+* @param	kp, ki, kd are the signed gains
+* @param	gain_shift is the right shift applied to the sum (0 - 31)
+* @param	integ_limit is the largest magnitude of sum(e) (0 turns the I term off)
+* @param	bias is added to the output, in clock cycles of the PWM period
+* @param	hysteresis_hz is the bang-bang dead band in Hz
+*
+* @return	None
+*
+*****************************************************************************/
+
+void HWDET_ctl_set_setpoint(HWDET *InstancePtr, u32 setpoint_hz) {
+
+	HWDET_WriteReg(InstancePtr->BaseAddress + HWDET_CTL_BANK_OFFSET, HWDET_CTL_SETPOINT_OFFSET, setpoint_hz);
+}
+
+void HWDET_ctl_set_pid(HWDET *InstancePtr, s16 kp, s16 ki, s16 kd, unsigned int gain_shift,
+						u32 integ_limit, u32 bias) {
+
+	u32 base = InstancePtr->BaseAddress + HWDET_CTL_BANK_OFFSET;
+
+	HWDET_WriteReg(base, HWDET_CTL_KP_OFFSET, (u32) (u16) kp);
+	HWDET_WriteReg(base, HWDET_CTL_KI_OFFSET, (u32) (u16) ki);
+	HWDET_WriteReg(base, HWDET_CTL_KD_OFFSET, (u32) (u16) kd);
+	HWDET_WriteReg(base, HWDET_CTL_GAIN_SHIFT_OFFSET, MIN(gain_shift, HWDET_CTL_GAIN_SHIFT_MAX));
+	HWDET_WriteReg(base, HWDET_CTL_INTEG_LIMIT_OFFSET, MIN(integ_limit, 0x7FFFFFFF));
+	HWDET_WriteReg(base, HWDET_CTL_BIAS_OFFSET, bias);
+}
+
+void HWDET_ctl_set_hysteresis(HWDET *InstancePtr, u32 hysteresis_hz) {
+
+	HWDET_WriteReg(InstancePtr->BaseAddress + HWDET_CTL_BANK_OFFSET, HWDET_CTL_HYSTERESIS_OFFSET,
+					MIN(hysteresis_hz, 0x7FFFFFFF));
+}
+
+/****************** Start / stop the closed-loop controller ****************/
+/**
+* Starts the controller on one channel. From then on every new frequency of
+* that channel updates the PWM compare value a few clocks after the sensor
+* period ends, and the top level drives the LED from the controller instead
+* of the AXI timer. HWDET_ctl_stop() hands the LED back to the AXI timer.
+*
+* Set up the PWM, the setpoint and the gains before starting the controller.
+* Starting it clears the integrator and the telemetry.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	ch is the channel whose sensor is controlled
+* @param	pid selects the PID law (true) or the bang-bang law (false)
+* @param	filtered controls the median / moving-average filtered frequency
+* 			(see HWDET_set_filter()) instead of the frequency of every period
+*
+* @return	XST_SUCCESS, or XST_INVALID_PARAM if the channel doesn't exist or
+* 			the PWM hasn't been set up (the controller is left stopped)
+*
+*****************************************************************************/
+
+XStatus HWDET_ctl_start(HWDET *InstancePtr, unsigned int ch, bool pid, bool filtered) {
+
+	u32 base = InstancePtr->BaseAddress + HWDET_CTL_BANK_OFFSET;
+	u32 ctrl = ((ch << HWDET_CTL_SOURCE_SHIFT) & HWDET_CTL_SOURCE_MASK);
+
+	HWDET_WriteReg(base, HWDET_CTL_CTRL_OFFSET, 0x00000000);
+
+	if ((ch >= InstancePtr->NumChannels) || (HWDET_ReadReg(base, HWDET_CTL_PWM_PERIOD_OFFSET) < 2)) {
+		return XST_INVALID_PARAM;
+	}
+
+	if (pid) {
+		ctrl |= HWDET_CTL_PID_MASK;
+	}
+
+	if (filtered) {
+		ctrl |= HWDET_CTL_FILTERED_MASK;
+	}
+
+	HWDET_WriteReg(base, HWDET_CTL_CTRL_OFFSET, ctrl | HWDET_CTL_ENABLE_MASK);
+
+	return XST_SUCCESS;
+}
+
+void HWDET_ctl_stop(HWDET *InstancePtr) {
+
+	HWDET_WriteReg(InstancePtr->BaseAddress + HWDET_CTL_BANK_OFFSET, HWDET_CTL_CTRL_OFFSET, 0x00000000);
+}
+
+/****************** Read the closed-loop controller telemetry **************/
+/**
+* Reads the last update of the closed-loop controller.
+*
+* Reading the update count freezes the frequency, error and output, so all of
+* them always come from the same update. The integrator is read live.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	tlm is a pointer to the structure that receives the telemetry
+*
+* @return
+* 			- XST_SUCCESS	tlm holds the last update
+*			- XST_NO_DATA	the controller hasn't updated since it was started
+*
+*****************************************************************************/
+
+XStatus HWDET_ctl_get_telemetry(HWDET *InstancePtr, _HWDET_ctl_telemetry *tlm) {
+
+	u32 base = InstancePtr->BaseAddress + HWDET_CTL_BANK_OFFSET;
+
+	// the update count must be read first --> it freezes the other registers
+
+	tlm->seq 		= HWDET_ReadReg(base, HWDET_CTL_TLM_SEQ_OFFSET);
+	tlm->freq_hz 	= HWDET_ReadReg(base, HWDET_CTL_TLM_FREQ_OFFSET);
+	tlm->error 		= (s32) HWDET_ReadReg(base, HWDET_CTL_TLM_ERROR_OFFSET);
+	tlm->output 	= HWDET_ReadReg(base, HWDET_CTL_TLM_OUTPUT_OFFSET);
+	tlm->period 	= HWDET_ReadReg(base, HWDET_CTL_PWM_PERIOD_OFFSET);
+	tlm->integ 		= (s32) HWDET_ReadReg(base, HWDET_CTL_INTEG_OFFSET);
+
+	return (tlm->seq != 0) ? XST_SUCCESS : XST_NO_DATA;
+}
+
+/********************** Register interrupt callback ************************/
+/**
+* Sets the function that HWDET_InterruptHandler() calls when the HWDET
+* peripheral raises an interrupt.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	FuncPtr is the callback function (NULL to remove it)
+* @param	CallBackRef is passed back to the callback unchanged
+*
+* @return	None
+*
+* @note		Connect HWDET_InterruptHandler() to the interrupt controller with
+* 			XIntc_Connect(), passing the instance pointer as its CallBackRef,
+* 			and enable it with XIntc_Enable(); the callback runs in
+* 			interrupt context.
+*
+*****************************************************************************/
+
+void HWDET_SetHandler(HWDET *InstancePtr, HWDET_Handler FuncPtr, void *CallBackRef) {
+
+	InstancePtr->Handler = FuncPtr;
+	InstancePtr->CallBackRef = CallBackRef;
+}
+
+/******************** Enable / disable HWDET interrupts ********************/
+/**
+* Enables or disables HWDET interrupt sources. Pending events for sources
+* that are being enabled are acknowledged first, so stale events do not
+* fire as soon as the source is enabled.
+*
+* @param	InstancePtr is a pointer to the HWDET instance
+* @param	ch is the channel (HWDET_EnableInterrupt_ch / _DisableInterrupt_ch only)
+* @param	Mask is a combination of the HWDET_IRQ_xxx_MASK values
+*
+* @return	None
+*
+* @note		The HWDET_IRQ_STREAM_xxx sources belong to the record stream, not
+* 			to a channel, so 'ch' does not matter for them.
+*
+*****************************************************************************/
+
+void HWDET_EnableInterrupt(HWDET *InstancePtr, u32 Mask) {
+
+	HWDET_EnableInterrupt_ch(InstancePtr, 0, Mask);
+}
+
+void HWDET_DisableInterrupt(HWDET *InstancePtr, u32 Mask) {
+
+	HWDET_DisableInterrupt_ch(InstancePtr, 0, Mask);
+}
+
+void HWDET_EnableInterrupt_ch(HWDET *InstancePtr, unsigned int ch, u32 Mask) {
+
+	u32 base = HWDET_mChannelBase(InstancePtr->BaseAddress, ch);
+	u32 stream = (Mask & HWDET_IRQ_STREAM_MASK) >> HWDET_IRQ_STREAM_SHIFT;
+
+	if (stream != 0) {
+		HWDET_WriteReg(InstancePtr->BaseAddress + HWDET_STREAM_BANK_OFFSET, HWDET_STREAM_IRQ_STATUS_OFFSET, stream);
+
+		InstancePtr->StreamIrqEnabled |= stream;
+		HWDET_WriteReg(InstancePtr->BaseAddress + HWDET_STREAM_BANK_OFFSET, HWDET_STREAM_IRQ_ENABLE_OFFSET, InstancePtr->StreamIrqEnabled);
+	}
+
+	Mask &= HWDET_IRQ_ALL_MASK;
+
+	HWDET_WriteReg(base, HWDET_IRQ_STATUS_OFFSET, Mask);
+
+	InstancePtr->IrqEnabled[ch] |= Mask;
+	HWDET_WriteReg(base, HWDET_IRQ_ENABLE_OFFSET, InstancePtr->IrqEnabled[ch]);
+}
+
+void HWDET_DisableInterrupt_ch(HWDET *InstancePtr, unsigned int ch, u32 Mask) {
+
+	InstancePtr->StreamIrqEnabled &= ~((Mask & HWDET_IRQ_STREAM_MASK) >> HWDET_IRQ_STREAM_SHIFT);
+	HWDET_WriteReg(InstancePtr->BaseAddress + HWDET_STREAM_BANK_OFFSET, HWDET_STREAM_IRQ_ENABLE_OFFSET, InstancePtr->StreamIrqEnabled);
+
+	InstancePtr->IrqEnabled[ch] &= ~Mask;
+	HWDET_WriteReg(HWDET_mChannelBase(InstancePtr->BaseAddress, ch), HWDET_IRQ_ENABLE_OFFSET, InstancePtr->IrqEnabled[ch]);
+}
+
+/************************* HWDET interrupt handler *************************/
+/**
+* Interrupt handler for the HWDET peripheral. Reads and acknowledges the
+* pending interrupt sources of every channel and then calls the registered
+* callback once for each channel that has pending sources.
+*
+* @param	InstancePtr is a pointer to the HWDET instance (passed as the
+* 			CallBackRef of XIntc_Connect())
+*
+* @return	None
+*
+* @note		Events are acknowledged before the callback runs, so an event
+* 			that happens during the callback raises a new interrupt.
+* @note		The channel number is passed to the callback in the
+* 			HWDET_IRQ_CHANNEL_MASK bits of IrqStatus (0 for channel 0).
+* 			Record stream events are passed in a call of their own, as
+* 			HWDET_IRQ_STREAM_xxx bits with the channel bits set to 0.
+*
+*****************************************************************************/
+
+void HWDET_InterruptHandler(void *InstancePtr) {
+
+	HWDET *HwdetPtr = (HWDET *) InstancePtr;
+	unsigned int ch = 0;
+	u32 base 		= 0x00000000;
+	u32 status 		= 0x00000000;
+
+	for (ch = 0; ch < HwdetPtr->NumChannels; ch++) {
+
+		if (HwdetPtr->IrqEnabled[ch] == 0) {
+			continue;
+		}
+
+		base = HWDET_mChannelBase(HwdetPtr->BaseAddress, ch);
+		status = HWDET_ReadReg(base, HWDET_IRQ_STATUS_OFFSET) & HwdetPtr->IrqEnabled[ch];
+
+		HWDET_WriteReg(base, HWDET_IRQ_STATUS_OFFSET, status);
+
+		if ((status != 0) && (HwdetPtr->Handler != NULL)) {
+			HwdetPtr->Handler(HwdetPtr->CallBackRef, status | (ch << HWDET_IRQ_CHANNEL_SHIFT));
+		}
+	}
+
+	if (HwdetPtr->StreamIrqEnabled != 0) {
+
+		base = HwdetPtr->BaseAddress + HWDET_STREAM_BANK_OFFSET;
+		status = HWDET_ReadReg(base, HWDET_STREAM_IRQ_STATUS_OFFSET) & HwdetPtr->StreamIrqEnabled;
+
+		HWDET_WriteReg(base, HWDET_STREAM_IRQ_STATUS_OFFSET, status);
+
+		if ((status != 0) && (HwdetPtr->Handler != NULL)) {
+			HwdetPtr->Handler(HwdetPtr->CallBackRef, status << HWDET_IRQ_STREAM_SHIFT);
+		}
+	}
 }
\ No newline at end of file
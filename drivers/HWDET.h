@@ -25,11 +25,17 @@
 /****************************** Include Files *******************************/
 /****************************************************************************/
 
+#include "xparameters.h"
 #include "xil_types.h"
 #include "xstatus.h"
 #include "stdbool.h"
+#include "xil_assert.h"
 #include "HWDET_l.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /****************************************************************************/
 /************************** Constant Definitions ****************************/
 /****************************************************************************/
@@ -48,8 +54,123 @@
 #define		HWDET_UPPER_HALF_MASK 	0xFFFF0000
 #define		HWDET_LOWER_HALF_MASK	0x0000FFFF
 
+// Fixed-point format of the hardware duty cycle register (Q16)
+
+#define		HWDET_DUTY_Q16_ONE		0x00010000
+#define		HWDET_DUTY_Q16_SHIFT	16
+
+// Masks for the sample FIFO status & control registers
+
+#define		HWDET_FIFO_LEVEL_MASK			0x0000FFFF
+#define		HWDET_FIFO_EMPTY_MASK			0x00010000
+#define		HWDET_FIFO_FULL_MASK			0x00020000
+#define		HWDET_FIFO_OVERFLOW_MASK		0x80000000
+
+#define		HWDET_FIFO_FLUSH_MASK			0x00000001
+#define		HWDET_FIFO_CLR_OVERFLOW_MASK	0x00000002
+#define		HWDET_FIFO_THRESHOLD_MASK		0xFFFF0000
+#define		HWDET_FIFO_THRESHOLD_SHIFT		16
+
+// Masks for the period histogram registers
+
+#define		HWDET_HIST_SHIFT_MASK			0x0000001F		// bin width = 2^n clock cycles
+#define		HWDET_HIST_ENABLE_MASK			0x00000100		// count new periods
+#define		HWDET_HIST_LAST_BIN_MASK		0x0000FFFF		// number of bins - 1
+#define		HWDET_HIST_BUSY_MASK			0x80000000		// clear in progress
+#define		HWDET_HIST_CLEAR_MASK			0x00000001		// zero every bin (write-only)
+
+// Masks for the interrupt enable & status registers
+
+#define		HWDET_IRQ_PERIOD_MASK			0x00000001		// a new period was measured
+#define		HWDET_IRQ_CALC_MASK				0x00000002		// hardware freq/duty results updated
+#define		HWDET_IRQ_FIFO_THRESH_MASK		0x00000004		// FIFO level reached the threshold
+#define		HWDET_IRQ_FIFO_OVERFLOW_MASK	0x00000008		// a period was dropped by a full FIFO
+#define		HWDET_IRQ_STATS_MASK			0x00000010		// a statistics window was published
+#define		HWDET_IRQ_SYNC_MASK				0x00000020		// a carrier-synchronous window closed
+#define		HWDET_IRQ_ALL_MASK				0x0000003F
+#define		HWDET_IRQ_STREAM_HALF_MASK		0x00000100		// DDR ring reached half full
+#define		HWDET_IRQ_STREAM_FULL_MASK		0x00000200		// DDR ring is full (new periods are dropped)
+#define		HWDET_IRQ_STREAM_MASK			0x00000300
+#define		HWDET_IRQ_STREAM_SHIFT			8				// position of the STREAM_IRQ_xxx bits in these masks
+#define		HWDET_IRQ_CHANNEL_MASK			0x00FF0000		// channel that raised the interrupt (callback only)
+#define		HWDET_IRQ_CHANNEL_SHIFT			16
+
+// Masks for the control register
+
+#define		HWDET_CTRL_RECIP_EN_MASK		0x00000001		// reciprocal (multi-period) counter
+#define		HWDET_CTRL_LOOPBACK_MASK		0x00000002		// measure the internal pulse generator
+#define		HWDET_CTRL_MEDIAN_MASK			0x0000000C		// period median filter (0 = off, 1 = 3, 2 = 5 periods)
+#define		HWDET_CTRL_MEDIAN_SHIFT			2
+#define		HWDET_CTRL_AVG_MASK				0x00000070		// period moving average of 2^n periods (0 = off)
+#define		HWDET_CTRL_AVG_SHIFT			4
+#define		HWDET_CTRL_AVG_MAX_LOG2			4				// longest moving average is 16 periods
+#define		HWDET_CTRL_AUTO_RANGE_MASK		0x00000080		// choose the prescaler range automatically
+#define		HWDET_CTRL_RANGE_MASK			0x00000F00		// prescaler range when auto ranging is off
+#define		HWDET_CTRL_RANGE_SHIFT			8
+
+// Masks for the prescaler range register
+
+#define		HWDET_RANGE_SNAP_MASK			0x0000000F		// range of the snapshot (counts are 2^n clocks)
+#define		HWDET_RANGE_SAT_MASK			0x00000010		// the snapshot saturated the counter
+#define		HWDET_RANGE_CURRENT_MASK		0x00000F00		// range of the period in progress
+#define		HWDET_RANGE_CURRENT_SHIFT		8
+#define		HWDET_RANGE_MAX					15
+
+// Masks for the live status register
+
+#define		HWDET_LIVE_LEVEL_MASK			0x00000001		// interval in progress is 'high'
+#define		HWDET_LIVE_STALE_MASK			0x00000002		// interval in progress outlasted the last period
+
+// Masks for the deglitch filter register
+
+#define		HWDET_DEGLITCH_WIDTH_MASK		0x0000FFFF		// filter width in clock cycles (0 = bypass)
+#define		HWDET_DEGLITCH_MAJORITY_MASK	0x00010000		// majority vote instead of minimum pulse width
+
+// Masks for the record stream control register
+
+#define		HWDET_STREAM_ENABLE_MASK		0x00000001		// send periods to the DMA
+#define		HWDET_STREAM_CLEAR_MASK			0x00000002		// empty the ring & clear the counters (write-only)
+#define		HWDET_STREAM_SOURCE_MASK		0x00000070		// channel whose periods are sent
+#define		HWDET_STREAM_SOURCE_SHIFT		4
+#define		HWDET_STREAM_BUSY_MASK			0x00000100		// a record or a clear is still in progress (read-only)
+
+// Masks for the AXI DMA (S2MM) registers & descriptors used by the record stream
+
+#define		HWDET_DMA_CR_RUN_MASK			0x00000001		// DMACR: run
+#define		HWDET_DMA_CR_RESET_MASK			0x00000004		// DMACR: soft reset (self-clearing)
+#define		HWDET_DMA_CR_CYCLIC_MASK		0x00000010		// DMACR: cyclic scatter-gather
+#define		HWDET_DMA_BD_STS_CMPLT_MASK		0x80000000		// descriptor status: block written to memory
+#define		HWDET_DMA_BD_LENGTH_MASK		0x03FFFFFF		// descriptor control: buffer length in bytes
+
+// Masks for the closed-loop controller control register
+
+#define		HWDET_CTL_ENABLE_MASK			0x00000001		// controller drives the LED
+#define		HWDET_CTL_PID_MASK				0x00000002		// 1 = PID, 0 = bang-bang
+#define		HWDET_CTL_FILTERED_MASK			0x00000004		// control the filtered frequency
+#define		HWDET_CTL_SOURCE_MASK			0x00000070		// channel that is controlled
+#define		HWDET_CTL_SOURCE_SHIFT			4
+#define		HWDET_CTL_INTEG_CLEAR_MASK		0x00000100		// clear the integrator (write-only)
+#define		HWDET_CTL_GAIN_SHIFT_MAX		31
+
+// Masks for the channel information register
+
+#define		HWDET_INFO_CHANNEL_MASK			0x000000FF		// channel number of this register bank
+#define		HWDET_INFO_NUM_CHANNELS_MASK	0x0000FF00		// number of channels in the peripheral
+#define		HWDET_INFO_NUM_CHANNELS_SHIFT	8
+
 /* @} */
 
+// Number of HWDET devices in the hardware design. Used to size the
+// configuration table in HWDET_g.c
+
+#if defined(XPAR_HWDET_NUM_INSTANCES)
+#define		HWDET_NUM_INSTANCES		XPAR_HWDET_NUM_INSTANCES
+#elif defined(XPAR_HWDET_1_DEVICE_ID)
+#define		HWDET_NUM_INSTANCES		2
+#else
+#define		HWDET_NUM_INSTANCES		1
+#endif
+
 /****************************************************************************/
 /***************** Macros (Inline Functions) Definitions ********************/
 /****************************************************************************/
@@ -65,6 +186,25 @@
 #ifndef MAX(a, b)
 #define MAX(a, b)  ( ((a) >= (b)) ? (a) : (b) )
 #endif
+
+// Division by a measured period. With HWDET_DIV_RECIP set, HWDET_DIV() uses
+// the reciprocal divide in HWDET_div_u32() instead of the '/' operator. It is
+// set by default when the MicroBlaze is built without the hardware divider;
+// define it to 0 or 1 at the top-level application to override.
+
+#ifndef HWDET_DIV_RECIP
+#if defined(XPAR_MICROBLAZE_USE_DIV) && (XPAR_MICROBLAZE_USE_DIV == 0)
+#define HWDET_DIV_RECIP 1
+#else
+#define HWDET_DIV_RECIP 0
+#endif
+#endif
+
+#if HWDET_DIV_RECIP
+#define HWDET_DIV(n, d)  HWDET_div_u32((n), (d))
+#else
+#define HWDET_DIV(n, d)  ((n) / (d))
+#endif
 	
 /****************************************************************************/
 /**************************** Type Definitions ******************************/
@@ -80,20 +220,297 @@
 
 typedef enum {HIGH, LOW} _HWDET_register;
 
+// Coherent snapshot of one complete period (all values in clock cycles)
+
+typedef struct {
+
+	u32		high;			// 'high' interval count
+	u32		low;			// 'low' interval count
+	u32		period;			// full period length (high + low + 2)
+	u32		seq;			// sequence number; increments once per period
+
+} _HWDET_snapshot;
+
+// Absolute times of the edges of one complete period, in clock cycles of
+// the free-running cycle counter (10ns each at 100MHz)
+
+typedef struct {
+
+	u64		rise;			// rising edge that ended the period
+	u64		fall;			// falling edge inside the period (start of the 'low' interval)
+
+} _HWDET_edge_times;
+
+// One complete period drained from the sample FIFO (clock cycles)
+
+typedef struct {
+
+	u32		high;			// 'high' interval count
+	u32		low;			// 'low' interval count
+
+} _HWDET_sample;
+
+// Period statistics over one window (all values in clock cycles)
+
+typedef struct {
+
+	u32		count;			// periods in the window
+	u32		min;			// shortest period
+	u32		max;			// longest period
+	u64		sum;			// sum of the periods
+	u64		sumsq;			// sum of the squared periods
+	u32		seq;			// window sequence number
+	float	mean;			// sum / count
+	float	variance;		// sumsq / count - mean^2
+
+} _HWDET_stats;
+
+// Result of one carrier-synchronous window (clock cycles)
+
+typedef struct {
+
+	u32		edges;			// rising edges of the input in the window
+	u32		clocks;			// length of the window (a whole number of carrier periods)
+	u32		span;			// first to last of those edges (0 if fewer than 2)
+	u32		seq;			// window sequence number
+
+} _HWDET_sync;
+
+// Instrumentation counters. edges, periods and overruns are free-running
+// and wrap around, so compare two readings to get rates
+
+typedef struct {
+
+	u32		edges;			// rising edges on the (filtered) input
+	u32		periods;		// complete periods measured
+	u32		overruns;		// snapshots replaced before they were read
+	u32		new_periods;	// complete periods since the last HWDET_get_counters()
+
+} _HWDET_counters;
+
+// Frequency & duty cycle of one channel, as computed by the hardware
+
+typedef struct {
+
+	u32		freq_hz;		// frequency of the last complete period (Hz)
+	u32		duty_q16;		// duty cycle of the last complete period (Q16)
+
+} _HWDET_reading;
+
+// One period as written to the DDR ring by the record stream. Matches the
+// four 32-bit beats of a stream record (16 bytes, little-endian)
+
+typedef struct {
+
+	u64		timestamp;		// cycle counter at the rising edge that ended the period
+	u32		high;			// 'high' interval count
+	u32		low;			// 'low' interval count
+
+} _HWDET_record;
+
+// One update of the closed-loop controller
+
+typedef struct {
+
+	u32		seq;			// updates since the controller was started
+	u32		freq_hz;		// frequency the update was computed from
+	s32		error;			// setpoint - freq_hz
+	u32		output;			// PWM compare value it produced (clock cycles)
+	u32		period;			// PWM period (clock cycles)
+	s32		integ;			// integrator (sum of the errors)
+
+} _HWDET_ctl_telemetry;
+
+// Interrupt callback. IrqStatus holds the HWDET_IRQ_xxx_MASK bits that
+// caused the interrupt; they have already been acknowledged. The channel
+// that raised them is in the HWDET_IRQ_CHANNEL_MASK bits.
+
+typedef void (*HWDET_Handler)(void *CallBackRef, u32 IrqStatus);
+
+// Configuration of one HWDET device, generated from xparameters.h (HWDET_g.c)
+
+typedef struct {
+
+	u16		DeviceId;		// unique ID of the device
+	u32		BaseAddress;	// base address of the device (channel 0)
+
+} HWDET_Config;
+
+// HWDET driver instance. One per peripheral; the fields are set by
+// HWDET_CfgInitialize() and should not be changed by the application.
+
+typedef struct {
+
+	u16				DeviceId;		// unique ID of the device
+	u32				BaseAddress;	// base address of the device (channel 0)
+	u32				IsReady;		// XIL_COMPONENT_IS_READY once initialized
+	unsigned int	NumChannels;	// channels in the peripheral
+	u32				ClockFreqHz;	// frequency of the clock the channels count in
+
+	HWDET_Handler	Handler;		// interrupt callback registered with HWDET_SetHandler()
+	void *			CallBackRef;	// passed back to the callback unchanged
+	u32				IrqEnabled[HWDET_MAX_CHANNELS];		// copy of each interrupt enable register
+	u32				StreamIrqEnabled;	// copy of the STREAM_IRQ_ENABLE register
+
+	_HWDET_record *	Ring;			// DDR ring buffer filled by the record stream
+	unsigned int	RingRecords;	// size of 'Ring' in records
+	unsigned int	BlockRecords;	// records per DMA descriptor
+	u32 *			BdRing;			// DMA descriptors, one per block of 'Ring'
+	u32				DmaBaseAddress;	// base address of the AXI DMA writing 'Ring'
+
+} HWDET;
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+// Configuration table, one entry per device in xparameters.h (HWDET_g.c)
+
+extern HWDET_Config HWDET_ConfigTable[HWDET_NUM_INSTANCES];
+
 /****************************************************************************/
 /************************** Function Prototypes *****************************/
 /****************************************************************************/
 
-// Initialization function
-int HWDET_initialize(u32 BaseAddr);
+// Initialization functions
+HWDET_Config *HWDET_LookupConfig(u16 DeviceId);
+int HWDET_CfgInitialize(HWDET *InstancePtr, HWDET_Config *Config, u32 EffectiveAddr);
+int HWDET_initialize(HWDET *InstancePtr, u16 DeviceId);
+
+// Number of channels in the peripheral
+unsigned int HWDET_get_num_channels(HWDET *InstancePtr);
 
 // Get count for high / low interval
-unsigned int HWDET_get_count(_HWDET_register reg);
+unsigned int HWDET_get_count(HWDET *InstancePtr, _HWDET_register reg);
+unsigned int HWDET_get_count_ch(HWDET *InstancePtr, unsigned int ch, _HWDET_register reg);
 
 // Calculate frequency from light intensity
-unsigned int HWDET_calc_freq(void);
+unsigned int HWDET_calc_freq(HWDET *InstancePtr);
+unsigned int HWDET_calc_freq_ch(HWDET *InstancePtr, unsigned int ch);
 
 // Calculate duty cycle from light intensity
-unsigned int HWDET_calc_duty(void);
+unsigned int HWDET_calc_duty(HWDET *InstancePtr);
+
+// Read a coherent snapshot of the last complete period
+XStatus HWDET_get_snapshot(HWDET *InstancePtr, _HWDET_snapshot *snap);
+XStatus HWDET_get_snapshot_ch(HWDET *InstancePtr, unsigned int ch, _HWDET_snapshot *snap);
+
+// Read a snapshot together with the times of its edges
+XStatus HWDET_get_edge_times(HWDET *InstancePtr, _HWDET_snapshot *snap, _HWDET_edge_times *times);
+XStatus HWDET_get_edge_times_ch(HWDET *InstancePtr, unsigned int ch, _HWDET_snapshot *snap, _HWDET_edge_times *times);
+
+// Free-running 64-bit cycle counter
+u64 HWDET_get_cycle_count(HWDET *InstancePtr);
+
+// Calculate frequency & duty cycle from a single snapshot
+XStatus HWDET_get_measurement(HWDET *InstancePtr, unsigned int *freq, unsigned int *duty);
+XStatus HWDET_get_measurement_ch(HWDET *InstancePtr, unsigned int ch, unsigned int *freq, unsigned int *duty);
+
+// Get frequency computed by the hardware arithmetic unit (no division)
+unsigned int HWDET_get_freq_hz(HWDET *InstancePtr);
+unsigned int HWDET_get_freq_hz_ch(HWDET *InstancePtr, unsigned int ch);
+
+// Get duty cycle computed by the hardware arithmetic unit (no division)
+unsigned int HWDET_get_duty_q16(HWDET *InstancePtr);
+unsigned int HWDET_get_duty_q16_ch(HWDET *InstancePtr, unsigned int ch);
+unsigned int HWDET_get_duty(HWDET *InstancePtr);
+
+// Read frequency & duty cycle of every channel
+unsigned int HWDET_read_all(HWDET *InstancePtr, _HWDET_reading *buf, unsigned int max);
+
+// Drain the sample FIFO
+unsigned int HWDET_read_burst(HWDET *InstancePtr, _HWDET_sample *buf, unsigned int max);
+
+// Sample FIFO status & control
+u32 HWDET_get_fifo_status(HWDET *InstancePtr);
+void HWDET_fifo_flush(HWDET *InstancePtr);
+void HWDET_fifo_clear_overflow(HWDET *InstancePtr);
+void HWDET_set_fifo_threshold(HWDET *InstancePtr, unsigned int threshold);
+
+// Reciprocal (multi-period) frequency counter
+void HWDET_set_recip_mode(HWDET *InstancePtr, bool enable, unsigned int gate_time_us);
+XStatus HWDET_get_recip_counts(HWDET *InstancePtr, u32 *periods, u32 *clocks);
+float HWDET_get_freq_recip(HWDET *InstancePtr);
+
+// Measurement windows locked to the PWM carrier
+void HWDET_set_sync_window(HWDET *InstancePtr, unsigned int carrier_periods);
+XStatus HWDET_get_sync_counts(HWDET *InstancePtr, _HWDET_sync *sync);
+float HWDET_get_freq_sync(HWDET *InstancePtr);
+
+// Interval in progress & staleness
+unsigned int HWDET_get_live_count(HWDET *InstancePtr);
+unsigned int HWDET_get_meas_age(HWDET *InstancePtr);
+bool HWDET_is_stale(HWDET *InstancePtr);
+unsigned int HWDET_get_freq_estimate(HWDET *InstancePtr);
+
+// Input deglitch filter
+void HWDET_set_deglitch(HWDET *InstancePtr, unsigned int width, bool majority);
+void HWDET_get_glitch_counts(HWDET *InstancePtr, u32 *pulses, u32 *periods);
+void HWDET_clear_glitch_counts(HWDET *InstancePtr);
+
+// Median & moving-average filter of the measured period
+XStatus HWDET_set_filter(HWDET *InstancePtr, unsigned int median, unsigned int avg_taps);
+unsigned int HWDET_get_filtered_period(HWDET *InstancePtr);
+unsigned int HWDET_get_filtered_period_ch(HWDET *InstancePtr, unsigned int ch);
+unsigned int HWDET_get_filtered_freq_hz(HWDET *InstancePtr);
+unsigned int HWDET_get_filtered_freq_hz_ch(HWDET *InstancePtr, unsigned int ch);
+
+// Windowed period statistics
+void HWDET_set_stats_window(HWDET *InstancePtr, u32 periods);
+void HWDET_stats_latch(HWDET *InstancePtr);
+XStatus HWDET_get_stats(HWDET *InstancePtr, _HWDET_stats *stats);
+
+// Period histogram
+void HWDET_set_histogram(HWDET *InstancePtr, u32 offset, unsigned int shift, bool enable);
+void HWDET_clear_histogram(HWDET *InstancePtr);
+unsigned int HWDET_get_histogram_bins(HWDET *InstancePtr);
+unsigned int HWDET_read_histogram(HWDET *InstancePtr, u32 *bins, unsigned int first, unsigned int max);
+
+// Instrumentation counters
+void HWDET_get_counters(HWDET *InstancePtr, _HWDET_counters *counters);
+
+// Prescaler range
+void HWDET_set_range(HWDET *InstancePtr, bool auto_range, unsigned int range);
+unsigned int HWDET_get_range(HWDET *InstancePtr);
+
+// Loopback pulse generator
+void HWDET_set_loopback(HWDET *InstancePtr, bool enable, u32 high, u32 low);
+
+// Record stream into a DDR ring buffer (AXI DMA)
+XStatus HWDET_stream_start(HWDET *InstancePtr, unsigned int ch, _HWDET_record *ring,
+							unsigned int ring_records, unsigned int block_records,
+							u32 dma_base, u32 *bd_ring);
+XStatus HWDET_stream_stop(HWDET *InstancePtr);
+unsigned int HWDET_stream_peek(HWDET *InstancePtr, _HWDET_record **records);
+void HWDET_stream_consume(HWDET *InstancePtr, unsigned int count);
+u32 HWDET_stream_get_dropped(HWDET *InstancePtr);
+
+// Closed-loop controller in the fabric (bang-bang / PID)
+XStatus HWDET_ctl_set_pwm(HWDET *InstancePtr, u32 pwm_freq_hz, unsigned int min_duty, unsigned int max_duty);
+void HWDET_ctl_set_setpoint(HWDET *InstancePtr, u32 setpoint_hz);
+void HWDET_ctl_set_pid(HWDET *InstancePtr, s16 kp, s16 ki, s16 kd, unsigned int gain_shift,
+						u32 integ_limit, u32 bias);
+void HWDET_ctl_set_hysteresis(HWDET *InstancePtr, u32 hysteresis_hz);
+XStatus HWDET_ctl_start(HWDET *InstancePtr, unsigned int ch, bool pid, bool filtered);
+void HWDET_ctl_stop(HWDET *InstancePtr);
+XStatus HWDET_ctl_get_telemetry(HWDET *InstancePtr, _HWDET_ctl_telemetry *tlm);
+
+// Division without a hardware divider (see HWDET_DIV)
+u32 HWDET_div_u32(u32 n, u32 d);
+
+// Duty cycle in % of a high interval & period (no 64-bit divide)
+u32 HWDET_duty_pct(u32 high, u32 period);
+
+// Interrupt support
+void HWDET_SetHandler(HWDET *InstancePtr, HWDET_Handler FuncPtr, void *CallBackRef);
+void HWDET_EnableInterrupt(HWDET *InstancePtr, u32 Mask);
+void HWDET_DisableInterrupt(HWDET *InstancePtr, u32 Mask);
+void HWDET_EnableInterrupt_ch(HWDET *InstancePtr, unsigned int ch, u32 Mask);
+void HWDET_DisableInterrupt_ch(HWDET *InstancePtr, unsigned int ch, u32 Mask);
+void HWDET_InterruptHandler(void *InstancePtr);
+
+#ifdef __cplusplus
+}
+#endif
 
 #endif
\ No newline at end of file
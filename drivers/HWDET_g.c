@@ -0,0 +1,40 @@
+/**
+*
+* @file HWDET_g.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file contains the configuration table for the HWDET devices in the
+* hardware design. Each entry is filled in from xparameters.h, so a new
+* device only needs a new entry here.
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include "xparameters.h"
+#include "HWDET.h"
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+// The configuration table for HWDET devices, looked up with HWDET_LookupConfig()
+
+HWDET_Config HWDET_ConfigTable[HWDET_NUM_INSTANCES] = {
+
+	{
+		XPAR_HWDET_0_DEVICE_ID,				// unique ID of the device
+		XPAR_HWDET_0_S00_AXI_BASEADDR		// base address of the device
+	},
+
+#ifdef XPAR_HWDET_1_DEVICE_ID
+	{
+		XPAR_HWDET_1_DEVICE_ID,
+		XPAR_HWDET_1_S00_AXI_BASEADDR
+	},
+#endif
+
+};
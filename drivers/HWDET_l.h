@@ -29,6 +29,10 @@
 #include "xil_io.h"
 #include "xstatus.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 /****************************************************************************/
 /************************** Constant Definitions ****************************/
 /****************************************************************************/
@@ -36,12 +40,176 @@
 /** @name Registers
  *
  * Register offsets for this device.
+ *
+ * Reading SNAP_PERIOD freezes SNAP_HIGH, SNAP_LOW, SNAP_SEQ and the RISE_TS
+ * and FALL_TS timestamps so that all of them describe the same period.
+ *
+ * FREQ_HZ and DUTY_Q16 are computed in hardware from each new snapshot.
+ *
+ * Reading FIFO_LOW pops the sample FIFO, so FIFO_HIGH must be read first.
+ *
+ * IRQ_STATUS bits are cleared by writing a 1 to them.
+ *
+ * Reading RECIP_PERIODS freezes RECIP_CLOCKS so that both values describe
+ * the same gate of the reciprocal counter.
+ *
+ * Writing any value to GLITCH_COUNT clears GLITCH_COUNT and GLITCH_PERIODS.
+ *
+ * Reading SYNC_EDGES freezes SYNC_CLOCKS, SYNC_SPAN and SYNC_SEQ so that all
+ * of them describe the same carrier-synchronous window.
+ *
+ * Reading STATS_COUNT freezes STATS_MIN through STATS_SEQ so that all of them
+ * describe the same window. Writing any value to STATS_COUNT publishes and
+ * clears the window in progress.
+ *
+ * Reading HIST_DATA returns the bin selected by HIST_ADDR and advances
+ * HIST_ADDR to the next bin.
+ *
+ * Reading NEW_PERIODS clears it.
+ *
+ * Each channel has its own copy of these registers in a bank of
+ * HWDET_CHANNEL_STRIDE bytes; channel n starts at BaseAddress + n * 0x100.
+ * INFO reports the channel number of the bank and the number of channels.
+ *
+ * Reading TIME_LO freezes TIME_HI, so the 64-bit cycle counter can be read
+ * without tearing.
+ *
+ * The interval counts (and everything computed from them in the peripheral
+ * except FREQ_HZ) are in prescaled counts of 2^n clocks. The range n of the
+ * snapshot is in RANGE, which is frozen by the SNAP_PERIOD read like the rest
+ * of the snapshot. The period filter (FILT_xxx), statistics (STATS_xxx) and
+ * histogram (HIST_xxx) are fed with the period in clock cycles instead.
+ *
+ * CLK_FREQ is the frequency of the clock the channel counts in, which is
+ * faster than the AXI clock when the peripheral is built with USE_MEAS_CLK.
+ *
+ * The STREAM_xxx registers are not per channel: there is one bank of them at
+ * BaseAddress + HWDET_STREAM_BANK_OFFSET. Writing any value to STREAM_DROPPED
+ * clears it.
+ *
+ * The DMA_S2MM_xxx offsets are registers of the AXI DMA (not of HWDET) that
+ * HWDET_stream_start() programs, and the DMA_BD_xxx values are word indexes
+ * into one scatter-gather descriptor. Descriptors are HWDET_DMA_BD_SIZE bytes
+ * apart and must be aligned to HWDET_DMA_BD_SIZE bytes.
+ *
+ * The CTL_xxx registers of the closed-loop controller are in one bank at
+ * BaseAddress + HWDET_CTL_BANK_OFFSET. Reading CTL_TLM_SEQ freezes CTL_TLM_FREQ,
+ * CTL_TLM_ERROR and CTL_TLM_OUTPUT so that all of them describe the same update.
  * @{
  */
 #define HWDET_HIGH_COUNT_OFFSET 0
 #define HWDET_LOW_COUNT_OFFSET 4
-#define HWDET_RSVD00_OFFSET 8
-#define HWDET_RSVD01_OFFSET 12
+#define HWDET_SNAP_PERIOD_OFFSET 8
+#define HWDET_SNAP_HIGH_OFFSET 12
+#define HWDET_SNAP_LOW_OFFSET 16
+#define HWDET_SNAP_SEQ_OFFSET 20
+#define HWDET_RSVD00_OFFSET 24
+#define HWDET_RSVD01_OFFSET 28
+#define HWDET_FREQ_HZ_OFFSET 32
+#define HWDET_DUTY_Q16_OFFSET 36
+#define HWDET_FIFO_HIGH_OFFSET 40
+#define HWDET_FIFO_LOW_OFFSET 44
+#define HWDET_FIFO_STATUS_OFFSET 48
+#define HWDET_FIFO_CTRL_OFFSET 52
+#define HWDET_IRQ_ENABLE_OFFSET 56
+#define HWDET_IRQ_STATUS_OFFSET 60
+#define HWDET_CTRL_OFFSET 64
+#define HWDET_GATE_TIME_OFFSET 68
+#define HWDET_RECIP_PERIODS_OFFSET 72
+#define HWDET_RECIP_CLOCKS_OFFSET 76
+#define HWDET_LIVE_COUNT_OFFSET 80
+#define HWDET_MEAS_AGE_OFFSET 84
+#define HWDET_LIVE_STATUS_OFFSET 88
+#define HWDET_DEGLITCH_OFFSET 92
+#define HWDET_GLITCH_COUNT_OFFSET 96
+#define HWDET_GLITCH_PERIODS_OFFSET 100
+#define HWDET_SYNC_PERIODS_OFFSET 104
+#define HWDET_SYNC_EDGES_OFFSET 108
+#define HWDET_SYNC_CLOCKS_OFFSET 112
+#define HWDET_SYNC_SPAN_OFFSET 116
+#define HWDET_SYNC_SEQ_OFFSET 120
+#define HWDET_RSVD07_OFFSET 124
+#define HWDET_STATS_WINDOW_OFFSET 128
+#define HWDET_STATS_COUNT_OFFSET 132
+#define HWDET_STATS_MIN_OFFSET 136
+#define HWDET_STATS_MAX_OFFSET 140
+#define HWDET_STATS_SUM_LO_OFFSET 144
+#define HWDET_STATS_SUM_HI_OFFSET 148
+#define HWDET_STATS_SUMSQ_LO_OFFSET 152
+#define HWDET_STATS_SUMSQ_HI_OFFSET 156
+#define HWDET_STATS_SEQ_OFFSET 160
+#define HWDET_HIST_CONFIG_OFFSET 164
+#define HWDET_HIST_OFFSET_OFFSET 168
+#define HWDET_HIST_ADDR_OFFSET 172
+#define HWDET_HIST_DATA_OFFSET 176
+#define HWDET_HIST_STATUS_OFFSET 180
+#define HWDET_EDGE_COUNT_OFFSET 184
+#define HWDET_PERIOD_COUNT_OFFSET 188
+#define HWDET_OVERRUN_COUNT_OFFSET 192
+#define HWDET_NEW_PERIODS_OFFSET 196
+#define HWDET_PATGEN_HIGH_OFFSET 200
+#define HWDET_PATGEN_LOW_OFFSET 204
+#define HWDET_INFO_OFFSET 208
+#define HWDET_TIME_LO_OFFSET 212
+#define HWDET_TIME_HI_OFFSET 216
+#define HWDET_RISE_TS_LO_OFFSET 220
+#define HWDET_RISE_TS_HI_OFFSET 224
+#define HWDET_FALL_TS_LO_OFFSET 228
+#define HWDET_FALL_TS_HI_OFFSET 232
+#define HWDET_FILT_PERIOD_OFFSET 236
+#define HWDET_FILT_FREQ_HZ_OFFSET 240
+#define HWDET_RANGE_OFFSET 244
+#define HWDET_CLK_FREQ_OFFSET 248
+
+#define HWDET_STREAM_BANK_OFFSET 0x800
+#define HWDET_STREAM_CTRL_OFFSET 0
+#define HWDET_STREAM_RING_SIZE_OFFSET 4
+#define HWDET_STREAM_BLOCK_LEN_OFFSET 8
+#define HWDET_STREAM_HEAD_OFFSET 12
+#define HWDET_STREAM_TAIL_OFFSET 16
+#define HWDET_STREAM_LEVEL_OFFSET 20
+#define HWDET_STREAM_DROPPED_OFFSET 24
+#define HWDET_STREAM_RECORDS_OFFSET 28
+#define HWDET_STREAM_IRQ_ENABLE_OFFSET 32
+#define HWDET_STREAM_IRQ_STATUS_OFFSET 36
+
+#define HWDET_DMA_S2MM_DMACR_OFFSET 0x30
+#define HWDET_DMA_S2MM_DMASR_OFFSET 0x34
+#define HWDET_DMA_S2MM_CURDESC_OFFSET 0x38
+#define HWDET_DMA_S2MM_CURDESC_MSB_OFFSET 0x3C
+#define HWDET_DMA_S2MM_TAILDESC_OFFSET 0x40
+#define HWDET_DMA_S2MM_TAILDESC_MSB_OFFSET 0x44
+
+#define HWDET_DMA_BD_NXTDESC 0
+#define HWDET_DMA_BD_NXTDESC_MSB 1
+#define HWDET_DMA_BD_BUFFER 2
+#define HWDET_DMA_BD_BUFFER_MSB 3
+#define HWDET_DMA_BD_CONTROL 6
+#define HWDET_DMA_BD_STATUS 7
+#define HWDET_DMA_BD_WORDS 16
+#define HWDET_DMA_BD_SIZE 64
+
+#define HWDET_CTL_BANK_OFFSET 0x900
+#define HWDET_CTL_CTRL_OFFSET 0
+#define HWDET_CTL_SETPOINT_OFFSET 4
+#define HWDET_CTL_PWM_PERIOD_OFFSET 8
+#define HWDET_CTL_OUT_MIN_OFFSET 12
+#define HWDET_CTL_OUT_MAX_OFFSET 16
+#define HWDET_CTL_KP_OFFSET 20
+#define HWDET_CTL_KI_OFFSET 24
+#define HWDET_CTL_KD_OFFSET 28
+#define HWDET_CTL_GAIN_SHIFT_OFFSET 32
+#define HWDET_CTL_HYSTERESIS_OFFSET 36
+#define HWDET_CTL_INTEG_LIMIT_OFFSET 40
+#define HWDET_CTL_BIAS_OFFSET 44
+#define HWDET_CTL_TLM_SEQ_OFFSET 48
+#define HWDET_CTL_TLM_FREQ_OFFSET 52
+#define HWDET_CTL_TLM_ERROR_OFFSET 56
+#define HWDET_CTL_TLM_OUTPUT_OFFSET 60
+#define HWDET_CTL_INTEG_OFFSET 64
+
+#define HWDET_CHANNEL_STRIDE 256
+#define HWDET_MAX_CHANNELS 8
 
 /* @} */
 
@@ -90,6 +258,93 @@
 #define HWDET_mReadReg(BaseAddress, RegOffset) \
     Xil_In32((BaseAddress) + (RegOffset))
 
+/**
+ *
+ * Get the base address of the register bank of one HWDET channel.
+ *
+ * @param   BaseAddress is the base address of the HWDET device.
+ * @param   Channel is the channel number (0 - HWDET_MAX_CHANNELS-1).
+ *
+ * @return  Base address of the channel's register bank.
+ *
+ * @note
+ * C-style signature:
+ * 	u32 HWDET_mChannelBase(u32 BaseAddress, unsigned Channel)
+ *
+ */
+
+#define HWDET_mChannelBase(BaseAddress, Channel) \
+    ((BaseAddress) + ((Channel) * HWDET_CHANNEL_STRIDE))
+
+/****************************************************************************/
+/***************** Macros (Inline Functions) Definitions ********************/
+/****************************************************************************/
+/**
+ *
+ * Read or write a HWDET register. Same as HWDET_mReadReg() / HWDET_mWriteReg(),
+ * but type-checked. Both compile down to a single load or store.
+ *
+ * @param   BaseAddress is the base address of the HWDET device (or of one
+ *          channel's register bank, see HWDET_mChannelBase()).
+ * @param   RegOffset is the register offset from the base.
+ * @param   Data is the data written to the register.
+ *
+ * @return  HWDET_ReadReg: the data from the register.
+ *
+ */
+
+static inline u32 HWDET_ReadReg(u32 BaseAddress, u32 RegOffset)
+{
+	return Xil_In32(BaseAddress + RegOffset);
+}
+
+static inline void HWDET_WriteReg(u32 BaseAddress, u32 RegOffset, u32 Data)
+{
+	Xil_Out32(BaseAddress + RegOffset, Data);
+}
+
+/**
+ *
+ * Read one of the measurement registers of a HWDET channel. These are meant
+ * for the control loop: each one is a single bus read with no function call.
+ *
+ * @param   BaseAddress is the base address of the channel's register bank
+ *          (the device base address for channel 0).
+ *
+ * @return  HWDET_ReadHighCount:	'high' interval count (clock cycles)
+ *          HWDET_ReadLowCount:		'low' interval count (clock cycles)
+ *          HWDET_ReadSnapPeriod:	length of the last complete period (clock cycles);
+ *          						also freezes the rest of the snapshot
+ *          HWDET_ReadFreqHz:		hardware frequency of the last complete period (Hz)
+ *          HWDET_ReadDutyQ16:		hardware duty cycle of the last complete period (Q16)
+ *
+ */
+
+static inline u32 HWDET_ReadHighCount(u32 BaseAddress)
+{
+	return Xil_In32(BaseAddress + HWDET_HIGH_COUNT_OFFSET);
+}
+
+static inline u32 HWDET_ReadLowCount(u32 BaseAddress)
+{
+	return Xil_In32(BaseAddress + HWDET_LOW_COUNT_OFFSET);
+}
+
+static inline u32 HWDET_ReadSnapPeriod(u32 BaseAddress)
+{
+	return Xil_In32(BaseAddress + HWDET_SNAP_PERIOD_OFFSET);
+}
+
+static inline u32 HWDET_ReadFreqHz(u32 BaseAddress)
+{
+	return Xil_In32(BaseAddress + HWDET_FREQ_HZ_OFFSET);
+}
+
+static inline u32 HWDET_ReadDutyQ16(u32 BaseAddress)
+{
+	return Xil_In32(BaseAddress + HWDET_DUTY_Q16_OFFSET);
+}
+
 
 /****************************************************************************/
 /************************** Function Prototypes *****************************/
@@ -111,10 +366,33 @@
  *
  * @note    Caching must be turned off for this function to work.
  * @note    Self test may fail if data memory and device are not on the same bus.
- * @note 	This test assumes a Serial port is available for xil_printf.
 
  */
 
 XStatus HWDET_Reg_SelfTest(u32 baseaddr);
 
+/**
+ *
+ * Run an end-to-end test of the measurement path. The input of hw_detect.v
+ * is switched to the internal pulse generator and a few known periods and
+ * duty cycles are measured and checked.
+ *
+ * @param   baseaddr is the base address of the HWDET instance to be worked on.
+ *
+ * @return
+ *
+ *    - XST_SUCCESS   if every pattern was measured correctly
+ *    - XST_FAILURE   if any pattern was measured incorrectly
+ *
+ * @note    Leaves loopback data in the measurement registers, FIFO,
+ * 			statistics and counters.
+ *
+ */
+
+XStatus HWDET_Loopback_SelfTest(u32 baseaddr);
+
+#ifdef __cplusplus
+}
+#endif
+
 #endif
\ No newline at end of file
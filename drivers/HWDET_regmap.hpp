@@ -0,0 +1,238 @@
+/**
+*
+* @file HWDET_regmap.hpp
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This header file contains the C++ templates used to describe register maps
+* at compile time (see HWDET_regs.hpp for the HWDET, axi_timer and axi_gpio
+* maps). It is header-only and needs C++11.
+*
+* A register is a type that carries its offset and whether it can be written.
+* A field is a type that carries its register, position, width and value type.
+* A value read from a register keeps the register in its type, so a field can
+* only be taken from (or put into) the register it belongs to, and writing a
+* read-only register does not compile.
+*
+* Everything is resolved at compile time: bank.read<R>() is one Xil_In32() at
+* base + offset and bank.write(value) is one Xil_Out32(), the same code as
+* HWDET_mReadReg() / HWDET_mWriteReg(). Only set<F>() reads and writes.
+*
+* The backend does the actual accesses. mmio uses Xil_In32() / Xil_Out32().
+* When HWDET_REGS_HOST is defined (Linux builds) the Xilinx headers are not
+* used and mock is the default: the registers are an array in memory and the
+* accesses are counted, so driver hot paths can be run & timed on the host.
+*
+* Example:
+*
+*	hwdet::channel<> ch(XPAR_HWDET_0_S00_AXI_BASEADDR, 0);
+*
+*	u32 period = ch.read<hwdet::snap_period>().bits();
+*	u32 range = ch.get<hwdet::range_snap>();
+*	ch.write(hwdet::ctrl_auto_range::make(true) | hwdet::ctrl_median::make(1));
+*	ch.write<hwdet::snap_period>(0);		// does not compile (read-only)
+*/
+
+/****************************************************************************/
+/**************************** Header Definition  ****************************/
+/****************************************************************************/
+
+#ifndef HWDET_REGMAP_HPP
+#define HWDET_REGMAP_HPP
+
+/****************************************************************************/
+/****************************** Include Files *******************************/
+/****************************************************************************/
+
+#include <stdint.h>
+#include <type_traits>
+
+#ifndef HWDET_REGS_HOST
+#include "xil_io.h"
+#endif
+
+namespace regmap {
+
+/****************************************************************************/
+/**************************** Type Definitions ******************************/
+/****************************************************************************/
+
+// Access of a register. Reading is always allowed (write-1-to-clear and
+// read-to-clear registers are 'rw'); writing is checked at compile time
+
+struct ro { static constexpr bool writable = false; };
+struct rw { static constexpr bool writable = true; };
+
+// Register at byte offset Offset from the start of a Bank. The bank type
+// keeps registers of one bank from being used on another (e.g. a HWDET
+// controller register on a channel)
+
+template <typename Bank, uint32_t Offset, typename Access>
+struct reg {
+	typedef Bank bank;
+	typedef Access access;
+	static constexpr uint32_t offset = Offset;
+
+	static_assert((Offset & 0x3) == 0, "register offsets must be 32-bit aligned");
+};
+
+// Contents of register Reg. Values of different registers are different
+// types, so they cannot be mixed up or OR'ed together
+
+template <typename Reg>
+class value {
+public:
+	constexpr explicit value(uint32_t bits = 0) : bits_(bits) {}
+
+	constexpr uint32_t bits() const { return bits_; }
+
+	constexpr value operator|(value other) const { return value(bits_ | other.bits_); }
+
+	// field F of this value
+
+	template <typename F>
+	constexpr typename F::type get() const {
+		static_assert(std::is_same<typename F::reg, Reg>::value, "field belongs to another register");
+		return F::extract(bits_);
+	}
+
+	// this value with field F replaced
+
+	template <typename F>
+	constexpr value with(typename F::type v) const {
+		static_assert(std::is_same<typename F::reg, Reg>::value, "field belongs to another register");
+		return value((bits_ & ~F::mask) | F::make(v).bits());
+	}
+
+private:
+	uint32_t bits_;
+};
+
+// Field of Width bits starting at bit Lsb of register Reg. T is the type the
+// field is read as (bool for flags, a signed type for signed fields)
+
+template <typename Reg, unsigned Lsb, unsigned Width, typename T = uint32_t>
+struct field {
+	typedef Reg reg;
+	typedef T type;
+	static constexpr unsigned shift = Lsb;
+	static constexpr uint32_t mask = ((Width >= 32) ? 0xFFFFFFFFu : ((1u << (Width % 32)) - 1u)) << Lsb;
+
+	static_assert((Width > 0) && (Lsb + Width <= 32), "field does not fit in 32 bits");
+
+	static constexpr value<Reg> make(T v) {
+		return value<Reg>((static_cast<uint32_t>(v) << Lsb) & mask);
+	}
+
+	static constexpr T extract(uint32_t bits) {
+		return static_cast<T>((bits & mask) >> Lsb);
+	}
+};
+
+/****************************************************************************/
+/******************************** Backends **********************************/
+/****************************************************************************/
+
+#ifndef HWDET_REGS_HOST
+
+// Memory-mapped registers through the Xilinx I/O functions (the same
+// accesses as the C drivers)
+
+struct mmio {
+	static uint32_t read(uintptr_t addr) { return Xil_In32(addr); }
+	static void write(uintptr_t addr, uint32_t data) { Xil_Out32(addr, data); }
+};
+
+typedef mmio default_backend;
+
+#endif
+
+// Registers in ordinary memory for host builds: the bank base address is
+// the address of an array standing in for the register space. The accesses
+// are volatile like the real ones, and counted so a test can check how many
+// bus accesses a driver function would make
+
+template <typename Tag = void>
+struct mock_backend {
+	static unsigned long reads;
+	static unsigned long writes;
+
+	static uint32_t read(uintptr_t addr) {
+		reads++;
+		return *reinterpret_cast<volatile uint32_t *>(addr);
+	}
+
+	static void write(uintptr_t addr, uint32_t data) {
+		writes++;
+		*reinterpret_cast<volatile uint32_t *>(addr) = data;
+	}
+};
+
+template <typename Tag> unsigned long mock_backend<Tag>::reads = 0;
+template <typename Tag> unsigned long mock_backend<Tag>::writes = 0;
+
+typedef mock_backend<> mock;
+
+#ifdef HWDET_REGS_HOST
+typedef mock default_backend;
+#endif
+
+/****************************************************************************/
+/********************************* Banks ************************************/
+/****************************************************************************/
+
+// One bank of registers of type Bank starting at base. All accesses are
+// inline and resolve to base + a constant offset
+
+template <typename Bank, typename Backend = default_backend>
+class bank {
+public:
+	explicit bank(uintptr_t base) : base_(base) {}
+
+	uintptr_t base() const { return base_; }
+
+	// whole register: one load
+
+	template <typename R>
+	value<R> read() const {
+		static_assert(std::is_same<typename R::bank, Bank>::value, "register belongs to another bank");
+		return value<R>(Backend::read(base_ + R::offset));
+	}
+
+	// whole register: one store
+
+	template <typename R>
+	void write(value<R> v) const {
+		static_assert(std::is_same<typename R::bank, Bank>::value, "register belongs to another bank");
+		static_assert(R::access::writable, "register is read-only");
+		Backend::write(base_ + R::offset, v.bits());
+	}
+
+	template <typename R>
+	void write(uint32_t bits) const {
+		write(value<R>(bits));
+	}
+
+	// one field: one load
+
+	template <typename F>
+	typename F::type get() const {
+		return read<typename F::reg>().template get<F>();
+	}
+
+	// one field, keeping the rest of the register: one load & one store.
+	// Not for registers with write-1 strobes or write-1-to-clear bits
+
+	template <typename F>
+	void set(typename F::type v) const {
+		write(read<typename F::reg>().template with<F>(v));
+	}
+
+private:
+	uintptr_t base_;
+};
+
+} // namespace regmap
+
+#endif
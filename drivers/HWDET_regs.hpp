@@ -0,0 +1,553 @@
+/**
+*
+* @file HWDET_regs.hpp
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This header file describes the registers of the HWDET peripheral and of the
+* Xilinx axi_timer and axi_gpio used with it, for C++ code. See
+* HWDET_regmap.hpp for how registers, fields and banks work.
+*
+* The offsets are the same as in HWDET_l.h, xtmrctr_l.h and xgpio_l.h, and
+* the fields the same as the masks in HWDET.h. When the Xilinx headers are
+* available (not HWDET_REGS_HOST) every one of them is checked against those
+* headers at compile time.
+*
+* Register names are the C names in lower case without the prefix and the
+* _OFFSET suffix; fields are named after the C masks.
+*/
+
+/****************************************************************************/
+/**************************** Header Definition  ****************************/
+/****************************************************************************/
+
+#ifndef HWDET_REGS_HPP
+#define HWDET_REGS_HPP
+
+/****************************************************************************/
+/****************************** Include Files *******************************/
+/****************************************************************************/
+
+#include "HWDET_regmap.hpp"
+
+#ifndef HWDET_REGS_HOST
+#include "xparameters.h"
+#include "HWDET_l.h"
+#include "HWDET.h"
+#ifdef XPAR_XTMRCTR_NUM_INSTANCES
+#include "xtmrctr_l.h"
+#endif
+#ifdef XPAR_XGPIO_NUM_INSTANCES
+#include "xgpio_l.h"
+#endif
+#endif
+
+/****************************************************************************/
+/********************************* HWDET ************************************/
+/****************************************************************************/
+
+namespace hwdet {
+
+using regmap::reg;
+using regmap::field;
+using regmap::ro;
+using regmap::rw;
+
+// Banks: one per channel (HWDET_CHANNEL_STRIDE apart), the record stream and
+// the closed-loop controller
+
+struct channel_bank {};
+struct stream_bank {};
+struct ctl_bank {};
+
+static constexpr uint32_t channel_stride = 256;
+static constexpr uint32_t max_channels = 8;
+static constexpr uint32_t stream_bank_offset = 0x800;
+static constexpr uint32_t ctl_bank_offset = 0x900;
+
+template <typename Backend = regmap::default_backend>
+class channel : public regmap::bank<channel_bank, Backend> {
+public:
+	channel(uintptr_t base, unsigned int ch)
+		: regmap::bank<channel_bank, Backend>(base + (ch * channel_stride)) {}
+};
+
+template <typename Backend = regmap::default_backend>
+class stream : public regmap::bank<stream_bank, Backend> {
+public:
+	explicit stream(uintptr_t base)
+		: regmap::bank<stream_bank, Backend>(base + stream_bank_offset) {}
+};
+
+template <typename Backend = regmap::default_backend>
+class ctl : public regmap::bank<ctl_bank, Backend> {
+public:
+	explicit ctl(uintptr_t base)
+		: regmap::bank<ctl_bank, Backend>(base + ctl_bank_offset) {}
+};
+
+// Channel registers. Reading snap_period freezes the rest of the snapshot;
+// see HWDET_l.h for the other registers with side effects
+
+typedef reg<channel_bank, 0, ro>	high_count;
+typedef reg<channel_bank, 4, ro>	low_count;
+typedef reg<channel_bank, 8, ro>	snap_period;
+typedef reg<channel_bank, 12, ro>	snap_high;
+typedef reg<channel_bank, 16, ro>	snap_low;
+typedef reg<channel_bank, 20, ro>	snap_seq;
+typedef reg<channel_bank, 32, ro>	freq_hz;
+typedef reg<channel_bank, 36, ro>	duty_q16;
+typedef reg<channel_bank, 40, ro>	fifo_high;
+typedef reg<channel_bank, 44, ro>	fifo_low;
+typedef reg<channel_bank, 48, ro>	fifo_status;
+typedef reg<channel_bank, 52, rw>	fifo_ctrl;
+typedef reg<channel_bank, 56, rw>	irq_enable;
+typedef reg<channel_bank, 60, rw>	irq_status;		// write 1 to clear
+typedef reg<channel_bank, 64, rw>	ctrl;
+typedef reg<channel_bank, 68, rw>	gate_time;
+typedef reg<channel_bank, 72, ro>	recip_periods;
+typedef reg<channel_bank, 76, ro>	recip_clocks;
+typedef reg<channel_bank, 80, ro>	live_count;
+typedef reg<channel_bank, 84, ro>	meas_age;
+typedef reg<channel_bank, 88, ro>	live_status;
+typedef reg<channel_bank, 92, rw>	deglitch;
+typedef reg<channel_bank, 96, rw>	glitch_count;	// write to clear
+typedef reg<channel_bank, 100, ro>	glitch_periods;
+typedef reg<channel_bank, 104, rw>	sync_periods;
+typedef reg<channel_bank, 108, ro>	sync_edges;
+typedef reg<channel_bank, 112, ro>	sync_clocks;
+typedef reg<channel_bank, 116, ro>	sync_span;
+typedef reg<channel_bank, 120, ro>	sync_seq;
+typedef reg<channel_bank, 128, rw>	stats_window;
+typedef reg<channel_bank, 132, rw>	stats_count;	// write to publish the window
+typedef reg<channel_bank, 136, ro>	stats_min;
+typedef reg<channel_bank, 140, ro>	stats_max;
+typedef reg<channel_bank, 144, ro>	stats_sum_lo;
+typedef reg<channel_bank, 148, ro>	stats_sum_hi;
+typedef reg<channel_bank, 152, ro>	stats_sumsq_lo;
+typedef reg<channel_bank, 156, ro>	stats_sumsq_hi;
+typedef reg<channel_bank, 160, ro>	stats_seq;
+typedef reg<channel_bank, 164, rw>	hist_config;
+typedef reg<channel_bank, 168, rw>	hist_offset;
+typedef reg<channel_bank, 172, rw>	hist_addr;
+typedef reg<channel_bank, 176, ro>	hist_data;
+typedef reg<channel_bank, 180, rw>	hist_status;
+typedef reg<channel_bank, 184, ro>	edge_count;
+typedef reg<channel_bank, 188, ro>	period_count;
+typedef reg<channel_bank, 192, ro>	overrun_count;
+typedef reg<channel_bank, 196, ro>	new_periods;
+typedef reg<channel_bank, 200, rw>	patgen_high;
+typedef reg<channel_bank, 204, rw>	patgen_low;
+typedef reg<channel_bank, 208, ro>	info;
+typedef reg<channel_bank, 212, ro>	time_lo;
+typedef reg<channel_bank, 216, ro>	time_hi;
+typedef reg<channel_bank, 220, ro>	rise_ts_lo;
+typedef reg<channel_bank, 224, ro>	rise_ts_hi;
+typedef reg<channel_bank, 228, ro>	fall_ts_lo;
+typedef reg<channel_bank, 232, ro>	fall_ts_hi;
+typedef reg<channel_bank, 236, ro>	filt_period;
+typedef reg<channel_bank, 240, ro>	filt_freq_hz;
+typedef reg<channel_bank, 244, ro>	range;
+typedef reg<channel_bank, 248, ro>	clk_freq;
+
+// Record stream registers
+
+typedef reg<stream_bank, 0, rw>		stream_ctrl;
+typedef reg<stream_bank, 4, rw>		stream_ring_size;
+typedef reg<stream_bank, 8, rw>		stream_block_len;
+typedef reg<stream_bank, 12, ro>	stream_head;
+typedef reg<stream_bank, 16, rw>	stream_tail;
+typedef reg<stream_bank, 20, ro>	stream_level;
+typedef reg<stream_bank, 24, rw>	stream_dropped;		// write to clear
+typedef reg<stream_bank, 28, ro>	stream_records;
+typedef reg<stream_bank, 32, rw>	stream_irq_enable;
+typedef reg<stream_bank, 36, rw>	stream_irq_status;	// write 1 to clear
+
+// Closed-loop controller registers. Reading ctl_tlm_seq freezes the rest of
+// the telemetry
+
+typedef reg<ctl_bank, 0, rw>		ctl_ctrl;
+typedef reg<ctl_bank, 4, rw>		ctl_setpoint;
+typedef reg<ctl_bank, 8, rw>		ctl_pwm_period;
+typedef reg<ctl_bank, 12, rw>		ctl_out_min;
+typedef reg<ctl_bank, 16, rw>		ctl_out_max;
+typedef reg<ctl_bank, 20, rw>		ctl_kp;
+typedef reg<ctl_bank, 24, rw>		ctl_ki;
+typedef reg<ctl_bank, 28, rw>		ctl_kd;
+typedef reg<ctl_bank, 32, rw>		ctl_gain_shift;
+typedef reg<ctl_bank, 36, rw>		ctl_hysteresis;
+typedef reg<ctl_bank, 40, rw>		ctl_integ_limit;
+typedef reg<ctl_bank, 44, rw>		ctl_bias;
+typedef reg<ctl_bank, 48, ro>		ctl_tlm_seq;
+typedef reg<ctl_bank, 52, ro>		ctl_tlm_freq;
+typedef reg<ctl_bank, 56, ro>		ctl_tlm_error;
+typedef reg<ctl_bank, 60, ro>		ctl_tlm_output;
+typedef reg<ctl_bank, 64, ro>		ctl_integ;
+
+// Fields. The interrupt bits are the same in the enable and status
+// registers, so they take the register as a parameter
+
+typedef field<fifo_status, 0, 16>				fifo_level;
+typedef field<fifo_status, 16, 1, bool>			fifo_empty;
+typedef field<fifo_status, 17, 1, bool>			fifo_full;
+typedef field<fifo_status, 31, 1, bool>			fifo_overflow;
+
+typedef field<fifo_ctrl, 0, 1, bool>			fifo_flush;				// write-only strobe
+typedef field<fifo_ctrl, 1, 1, bool>			fifo_clr_overflow;		// write-only strobe
+typedef field<fifo_ctrl, 16, 16>				fifo_threshold;
+
+template <typename R> using irq_period 			= field<R, 0, 1, bool>;
+template <typename R> using irq_calc 			= field<R, 1, 1, bool>;
+template <typename R> using irq_fifo_thresh 	= field<R, 2, 1, bool>;
+template <typename R> using irq_fifo_overflow 	= field<R, 3, 1, bool>;
+template <typename R> using irq_stats 			= field<R, 4, 1, bool>;
+template <typename R> using irq_sync 			= field<R, 5, 1, bool>;
+
+typedef field<ctrl, 0, 1, bool>					ctrl_recip_en;
+typedef field<ctrl, 1, 1, bool>					ctrl_loopback;
+typedef field<ctrl, 2, 2>						ctrl_median;
+typedef field<ctrl, 4, 3>						ctrl_avg;
+typedef field<ctrl, 7, 1, bool>					ctrl_auto_range;
+typedef field<ctrl, 8, 4>						ctrl_range;
+
+typedef field<range, 0, 4>						range_snap;
+typedef field<range, 4, 1, bool>				range_sat;
+typedef field<range, 8, 4>						range_current;
+
+typedef field<live_status, 0, 1, bool>			live_level;
+typedef field<live_status, 1, 1, bool>			live_stale;
+
+typedef field<deglitch, 0, 16>					deglitch_width;
+typedef field<deglitch, 16, 1, bool>			deglitch_majority;
+
+typedef field<hist_config, 0, 5>				hist_shift;
+typedef field<hist_config, 8, 1, bool>			hist_enable;
+
+typedef field<hist_status, 0, 16>				hist_last_bin;
+typedef field<hist_status, 31, 1, bool>			hist_busy;
+typedef field<hist_status, 0, 1, bool>			hist_clear;				// write-only strobe
+
+typedef field<info, 0, 8>						info_channel;
+typedef field<info, 8, 8>						info_num_channels;
+
+typedef field<stream_ctrl, 0, 1, bool>			stream_enable;
+typedef field<stream_ctrl, 1, 1, bool>			stream_clear;			// write-only strobe
+typedef field<stream_ctrl, 4, 3>				stream_source;
+typedef field<stream_ctrl, 8, 1, bool>			stream_busy;			// read-only
+
+template <typename R> using stream_irq_half 	= field<R, 0, 1, bool>;
+template <typename R> using stream_irq_full 	= field<R, 1, 1, bool>;
+
+typedef field<ctl_ctrl, 0, 1, bool>				ctl_enable;
+typedef field<ctl_ctrl, 1, 1, bool>				ctl_pid;
+typedef field<ctl_ctrl, 2, 1, bool>				ctl_filtered;
+typedef field<ctl_ctrl, 4, 3>					ctl_source;
+typedef field<ctl_ctrl, 8, 1, bool>				ctl_integ_clear;		// write-only strobe
+
+typedef field<ctl_kp, 0, 16, int16_t>			ctl_kp_gain;
+typedef field<ctl_ki, 0, 16, int16_t>			ctl_ki_gain;
+typedef field<ctl_kd, 0, 16, int16_t>			ctl_kd_gain;
+typedef field<ctl_gain_shift, 0, 5>				ctl_gain_shift_bits;
+typedef field<ctl_tlm_error, 0, 32, int32_t>	ctl_tlm_error_hz;
+
+} // namespace hwdet
+
+/****************************************************************************/
+/******************************* axi_timer **********************************/
+/****************************************************************************/
+
+namespace tmrctr {
+
+using regmap::reg;
+using regmap::field;
+using regmap::ro;
+using regmap::rw;
+
+// One bank per timer (0 or 1), 16 bytes apart
+
+struct timer_bank {};
+
+static constexpr uint32_t timer_stride = 16;
+
+template <typename Backend = regmap::default_backend>
+class timer : public regmap::bank<timer_bank, Backend> {
+public:
+	timer(uintptr_t base, unsigned int tmr)
+		: regmap::bank<timer_bank, Backend>(base + (tmr * timer_stride)) {}
+};
+
+typedef reg<timer_bank, 0, rw>			tcsr;		// control / status
+typedef reg<timer_bank, 4, rw>			tlr;		// load
+typedef reg<timer_bank, 8, ro>			tcr;		// counter
+
+typedef field<tcsr, 0, 1, bool>			csr_capture_mode;
+typedef field<tcsr, 1, 1, bool>			csr_down_count;
+typedef field<tcsr, 2, 1, bool>			csr_ext_generate;
+typedef field<tcsr, 3, 1, bool>			csr_ext_capture;
+typedef field<tcsr, 4, 1, bool>			csr_auto_reload;
+typedef field<tcsr, 5, 1, bool>			csr_load;
+typedef field<tcsr, 6, 1, bool>			csr_enable_int;
+typedef field<tcsr, 7, 1, bool>			csr_enable_tmr;
+typedef field<tcsr, 8, 1, bool>			csr_int_occured;		// write 1 to clear
+typedef field<tcsr, 9, 1, bool>			csr_enable_pwm;
+typedef field<tcsr, 10, 1, bool>		csr_enable_all;
+typedef field<tcsr, 11, 1, bool>		csr_casc;
+
+} // namespace tmrctr
+
+/****************************************************************************/
+/******************************** axi_gpio **********************************/
+/****************************************************************************/
+
+namespace gpio {
+
+using regmap::reg;
+using regmap::field;
+using regmap::rw;
+
+// One bank per channel (1 or 2, 8 bytes apart) and one for the interrupt
+// registers
+
+struct channel_bank {};
+struct intr_bank {};
+
+static constexpr uint32_t channel_stride = 8;
+
+template <typename Backend = regmap::default_backend>
+class channel : public regmap::bank<channel_bank, Backend> {
+public:
+	channel(uintptr_t base, unsigned int ch)
+		: regmap::bank<channel_bank, Backend>(base + ((ch - 1) * channel_stride)) {}
+};
+
+template <typename Backend = regmap::default_backend>
+class intr : public regmap::bank<intr_bank, Backend> {
+public:
+	explicit intr(uintptr_t base)
+		: regmap::bank<intr_bank, Backend>(base) {}
+};
+
+typedef reg<channel_bank, 0, rw>		data;
+typedef reg<channel_bank, 4, rw>		tri;		// 1 = input
+
+typedef reg<intr_bank, 0x11C, rw>		gie;
+typedef reg<intr_bank, 0x120, rw>		isr;		// write 1 to toggle
+typedef reg<intr_bank, 0x128, rw>		ier;
+
+typedef field<gie, 31, 1, bool>			gie_enable;
+
+template <typename R> using ir_ch1 		= field<R, 0, 1, bool>;
+template <typename R> using ir_ch2 		= field<R, 1, 1, bool>;
+
+} // namespace gpio
+
+/****************************************************************************/
+/*************************** Checks against C headers ***********************/
+/****************************************************************************/
+
+#ifndef HWDET_REGS_HOST
+
+#define HWDET_REGS_CHECK(cpp, c) \
+	static_assert((cpp) == (c), #cpp " does not match " #c)
+
+namespace hwdet {
+
+HWDET_REGS_CHECK(channel_stride, HWDET_CHANNEL_STRIDE);
+HWDET_REGS_CHECK(max_channels, HWDET_MAX_CHANNELS);
+HWDET_REGS_CHECK(stream_bank_offset, HWDET_STREAM_BANK_OFFSET);
+HWDET_REGS_CHECK(ctl_bank_offset, HWDET_CTL_BANK_OFFSET);
+
+HWDET_REGS_CHECK(high_count::offset, HWDET_HIGH_COUNT_OFFSET);
+HWDET_REGS_CHECK(low_count::offset, HWDET_LOW_COUNT_OFFSET);
+HWDET_REGS_CHECK(snap_period::offset, HWDET_SNAP_PERIOD_OFFSET);
+HWDET_REGS_CHECK(snap_high::offset, HWDET_SNAP_HIGH_OFFSET);
+HWDET_REGS_CHECK(snap_low::offset, HWDET_SNAP_LOW_OFFSET);
+HWDET_REGS_CHECK(snap_seq::offset, HWDET_SNAP_SEQ_OFFSET);
+HWDET_REGS_CHECK(freq_hz::offset, HWDET_FREQ_HZ_OFFSET);
+HWDET_REGS_CHECK(duty_q16::offset, HWDET_DUTY_Q16_OFFSET);
+HWDET_REGS_CHECK(fifo_high::offset, HWDET_FIFO_HIGH_OFFSET);
+HWDET_REGS_CHECK(fifo_low::offset, HWDET_FIFO_LOW_OFFSET);
+HWDET_REGS_CHECK(fifo_status::offset, HWDET_FIFO_STATUS_OFFSET);
+HWDET_REGS_CHECK(fifo_ctrl::offset, HWDET_FIFO_CTRL_OFFSET);
+HWDET_REGS_CHECK(irq_enable::offset, HWDET_IRQ_ENABLE_OFFSET);
+HWDET_REGS_CHECK(irq_status::offset, HWDET_IRQ_STATUS_OFFSET);
+HWDET_REGS_CHECK(ctrl::offset, HWDET_CTRL_OFFSET);
+HWDET_REGS_CHECK(gate_time::offset, HWDET_GATE_TIME_OFFSET);
+HWDET_REGS_CHECK(recip_periods::offset, HWDET_RECIP_PERIODS_OFFSET);
+HWDET_REGS_CHECK(recip_clocks::offset, HWDET_RECIP_CLOCKS_OFFSET);
+HWDET_REGS_CHECK(live_count::offset, HWDET_LIVE_COUNT_OFFSET);
+HWDET_REGS_CHECK(meas_age::offset, HWDET_MEAS_AGE_OFFSET);
+HWDET_REGS_CHECK(live_status::offset, HWDET_LIVE_STATUS_OFFSET);
+HWDET_REGS_CHECK(deglitch::offset, HWDET_DEGLITCH_OFFSET);
+HWDET_REGS_CHECK(glitch_count::offset, HWDET_GLITCH_COUNT_OFFSET);
+HWDET_REGS_CHECK(glitch_periods::offset, HWDET_GLITCH_PERIODS_OFFSET);
+HWDET_REGS_CHECK(sync_periods::offset, HWDET_SYNC_PERIODS_OFFSET);
+HWDET_REGS_CHECK(sync_edges::offset, HWDET_SYNC_EDGES_OFFSET);
+HWDET_REGS_CHECK(sync_clocks::offset, HWDET_SYNC_CLOCKS_OFFSET);
+HWDET_REGS_CHECK(sync_span::offset, HWDET_SYNC_SPAN_OFFSET);
+HWDET_REGS_CHECK(sync_seq::offset, HWDET_SYNC_SEQ_OFFSET);
+HWDET_REGS_CHECK(stats_window::offset, HWDET_STATS_WINDOW_OFFSET);
+HWDET_REGS_CHECK(stats_count::offset, HWDET_STATS_COUNT_OFFSET);
+HWDET_REGS_CHECK(stats_min::offset, HWDET_STATS_MIN_OFFSET);
+HWDET_REGS_CHECK(stats_max::offset, HWDET_STATS_MAX_OFFSET);
+HWDET_REGS_CHECK(stats_sum_lo::offset, HWDET_STATS_SUM_LO_OFFSET);
+HWDET_REGS_CHECK(stats_sum_hi::offset, HWDET_STATS_SUM_HI_OFFSET);
+HWDET_REGS_CHECK(stats_sumsq_lo::offset, HWDET_STATS_SUMSQ_LO_OFFSET);
+HWDET_REGS_CHECK(stats_sumsq_hi::offset, HWDET_STATS_SUMSQ_HI_OFFSET);
+HWDET_REGS_CHECK(stats_seq::offset, HWDET_STATS_SEQ_OFFSET);
+HWDET_REGS_CHECK(hist_config::offset, HWDET_HIST_CONFIG_OFFSET);
+HWDET_REGS_CHECK(hist_offset::offset, HWDET_HIST_OFFSET_OFFSET);
+HWDET_REGS_CHECK(hist_addr::offset, HWDET_HIST_ADDR_OFFSET);
+HWDET_REGS_CHECK(hist_data::offset, HWDET_HIST_DATA_OFFSET);
+HWDET_REGS_CHECK(hist_status::offset, HWDET_HIST_STATUS_OFFSET);
+HWDET_REGS_CHECK(edge_count::offset, HWDET_EDGE_COUNT_OFFSET);
+HWDET_REGS_CHECK(period_count::offset, HWDET_PERIOD_COUNT_OFFSET);
+HWDET_REGS_CHECK(overrun_count::offset, HWDET_OVERRUN_COUNT_OFFSET);
+HWDET_REGS_CHECK(new_periods::offset, HWDET_NEW_PERIODS_OFFSET);
+HWDET_REGS_CHECK(patgen_high::offset, HWDET_PATGEN_HIGH_OFFSET);
+HWDET_REGS_CHECK(patgen_low::offset, HWDET_PATGEN_LOW_OFFSET);
+HWDET_REGS_CHECK(info::offset, HWDET_INFO_OFFSET);
+HWDET_REGS_CHECK(time_lo::offset, HWDET_TIME_LO_OFFSET);
+HWDET_REGS_CHECK(time_hi::offset, HWDET_TIME_HI_OFFSET);
+HWDET_REGS_CHECK(rise_ts_lo::offset, HWDET_RISE_TS_LO_OFFSET);
+HWDET_REGS_CHECK(rise_ts_hi::offset, HWDET_RISE_TS_HI_OFFSET);
+HWDET_REGS_CHECK(fall_ts_lo::offset, HWDET_FALL_TS_LO_OFFSET);
+HWDET_REGS_CHECK(fall_ts_hi::offset, HWDET_FALL_TS_HI_OFFSET);
+HWDET_REGS_CHECK(filt_period::offset, HWDET_FILT_PERIOD_OFFSET);
+HWDET_REGS_CHECK(filt_freq_hz::offset, HWDET_FILT_FREQ_HZ_OFFSET);
+HWDET_REGS_CHECK(range::offset, HWDET_RANGE_OFFSET);
+HWDET_REGS_CHECK(clk_freq::offset, HWDET_CLK_FREQ_OFFSET);
+
+HWDET_REGS_CHECK(stream_ctrl::offset, HWDET_STREAM_CTRL_OFFSET);
+HWDET_REGS_CHECK(stream_ring_size::offset, HWDET_STREAM_RING_SIZE_OFFSET);
+HWDET_REGS_CHECK(stream_block_len::offset, HWDET_STREAM_BLOCK_LEN_OFFSET);
+HWDET_REGS_CHECK(stream_head::offset, HWDET_STREAM_HEAD_OFFSET);
+HWDET_REGS_CHECK(stream_tail::offset, HWDET_STREAM_TAIL_OFFSET);
+HWDET_REGS_CHECK(stream_level::offset, HWDET_STREAM_LEVEL_OFFSET);
+HWDET_REGS_CHECK(stream_dropped::offset, HWDET_STREAM_DROPPED_OFFSET);
+HWDET_REGS_CHECK(stream_records::offset, HWDET_STREAM_RECORDS_OFFSET);
+HWDET_REGS_CHECK(stream_irq_enable::offset, HWDET_STREAM_IRQ_ENABLE_OFFSET);
+HWDET_REGS_CHECK(stream_irq_status::offset, HWDET_STREAM_IRQ_STATUS_OFFSET);
+
+HWDET_REGS_CHECK(ctl_ctrl::offset, HWDET_CTL_CTRL_OFFSET);
+HWDET_REGS_CHECK(ctl_setpoint::offset, HWDET_CTL_SETPOINT_OFFSET);
+HWDET_REGS_CHECK(ctl_pwm_period::offset, HWDET_CTL_PWM_PERIOD_OFFSET);
+HWDET_REGS_CHECK(ctl_out_min::offset, HWDET_CTL_OUT_MIN_OFFSET);
+HWDET_REGS_CHECK(ctl_out_max::offset, HWDET_CTL_OUT_MAX_OFFSET);
+HWDET_REGS_CHECK(ctl_kp::offset, HWDET_CTL_KP_OFFSET);
+HWDET_REGS_CHECK(ctl_ki::offset, HWDET_CTL_KI_OFFSET);
+HWDET_REGS_CHECK(ctl_kd::offset, HWDET_CTL_KD_OFFSET);
+HWDET_REGS_CHECK(ctl_gain_shift::offset, HWDET_CTL_GAIN_SHIFT_OFFSET);
+HWDET_REGS_CHECK(ctl_hysteresis::offset, HWDET_CTL_HYSTERESIS_OFFSET);
+HWDET_REGS_CHECK(ctl_integ_limit::offset, HWDET_CTL_INTEG_LIMIT_OFFSET);
+HWDET_REGS_CHECK(ctl_bias::offset, HWDET_CTL_BIAS_OFFSET);
+HWDET_REGS_CHECK(ctl_tlm_seq::offset, HWDET_CTL_TLM_SEQ_OFFSET);
+HWDET_REGS_CHECK(ctl_tlm_freq::offset, HWDET_CTL_TLM_FREQ_OFFSET);
+HWDET_REGS_CHECK(ctl_tlm_error::offset, HWDET_CTL_TLM_ERROR_OFFSET);
+HWDET_REGS_CHECK(ctl_tlm_output::offset, HWDET_CTL_TLM_OUTPUT_OFFSET);
+HWDET_REGS_CHECK(ctl_integ::offset, HWDET_CTL_INTEG_OFFSET);
+
+HWDET_REGS_CHECK(fifo_level::mask, HWDET_FIFO_LEVEL_MASK);
+HWDET_REGS_CHECK(fifo_empty::mask, HWDET_FIFO_EMPTY_MASK);
+HWDET_REGS_CHECK(fifo_full::mask, HWDET_FIFO_FULL_MASK);
+HWDET_REGS_CHECK(fifo_overflow::mask, HWDET_FIFO_OVERFLOW_MASK);
+HWDET_REGS_CHECK(fifo_flush::mask, HWDET_FIFO_FLUSH_MASK);
+HWDET_REGS_CHECK(fifo_clr_overflow::mask, HWDET_FIFO_CLR_OVERFLOW_MASK);
+HWDET_REGS_CHECK(fifo_threshold::mask, HWDET_FIFO_THRESHOLD_MASK);
+HWDET_REGS_CHECK(fifo_threshold::shift, HWDET_FIFO_THRESHOLD_SHIFT);
+HWDET_REGS_CHECK(irq_period<irq_enable>::mask, HWDET_IRQ_PERIOD_MASK);
+HWDET_REGS_CHECK(irq_calc<irq_enable>::mask, HWDET_IRQ_CALC_MASK);
+HWDET_REGS_CHECK(irq_fifo_thresh<irq_enable>::mask, HWDET_IRQ_FIFO_THRESH_MASK);
+HWDET_REGS_CHECK(irq_fifo_overflow<irq_enable>::mask, HWDET_IRQ_FIFO_OVERFLOW_MASK);
+HWDET_REGS_CHECK(irq_stats<irq_enable>::mask, HWDET_IRQ_STATS_MASK);
+HWDET_REGS_CHECK(irq_sync<irq_enable>::mask, HWDET_IRQ_SYNC_MASK);
+HWDET_REGS_CHECK(ctrl_recip_en::mask, HWDET_CTRL_RECIP_EN_MASK);
+HWDET_REGS_CHECK(ctrl_loopback::mask, HWDET_CTRL_LOOPBACK_MASK);
+HWDET_REGS_CHECK(ctrl_median::mask, HWDET_CTRL_MEDIAN_MASK);
+HWDET_REGS_CHECK(ctrl_median::shift, HWDET_CTRL_MEDIAN_SHIFT);
+HWDET_REGS_CHECK(ctrl_avg::mask, HWDET_CTRL_AVG_MASK);
+HWDET_REGS_CHECK(ctrl_avg::shift, HWDET_CTRL_AVG_SHIFT);
+HWDET_REGS_CHECK(ctrl_auto_range::mask, HWDET_CTRL_AUTO_RANGE_MASK);
+HWDET_REGS_CHECK(ctrl_range::mask, HWDET_CTRL_RANGE_MASK);
+HWDET_REGS_CHECK(ctrl_range::shift, HWDET_CTRL_RANGE_SHIFT);
+HWDET_REGS_CHECK(range_snap::mask, HWDET_RANGE_SNAP_MASK);
+HWDET_REGS_CHECK(range_sat::mask, HWDET_RANGE_SAT_MASK);
+HWDET_REGS_CHECK(range_current::mask, HWDET_RANGE_CURRENT_MASK);
+HWDET_REGS_CHECK(range_current::shift, HWDET_RANGE_CURRENT_SHIFT);
+HWDET_REGS_CHECK(live_level::mask, HWDET_LIVE_LEVEL_MASK);
+HWDET_REGS_CHECK(live_stale::mask, HWDET_LIVE_STALE_MASK);
+HWDET_REGS_CHECK(deglitch_width::mask, HWDET_DEGLITCH_WIDTH_MASK);
+HWDET_REGS_CHECK(deglitch_majority::mask, HWDET_DEGLITCH_MAJORITY_MASK);
+HWDET_REGS_CHECK(hist_shift::mask, HWDET_HIST_SHIFT_MASK);
+HWDET_REGS_CHECK(hist_enable::mask, HWDET_HIST_ENABLE_MASK);
+HWDET_REGS_CHECK(hist_last_bin::mask, HWDET_HIST_LAST_BIN_MASK);
+HWDET_REGS_CHECK(hist_busy::mask, HWDET_HIST_BUSY_MASK);
+HWDET_REGS_CHECK(hist_clear::mask, HWDET_HIST_CLEAR_MASK);
+HWDET_REGS_CHECK(info_channel::mask, HWDET_INFO_CHANNEL_MASK);
+HWDET_REGS_CHECK(info_num_channels::mask, HWDET_INFO_NUM_CHANNELS_MASK);
+HWDET_REGS_CHECK(info_num_channels::shift, HWDET_INFO_NUM_CHANNELS_SHIFT);
+HWDET_REGS_CHECK(stream_enable::mask, HWDET_STREAM_ENABLE_MASK);
+HWDET_REGS_CHECK(stream_clear::mask, HWDET_STREAM_CLEAR_MASK);
+HWDET_REGS_CHECK(stream_source::mask, HWDET_STREAM_SOURCE_MASK);
+HWDET_REGS_CHECK(stream_source::shift, HWDET_STREAM_SOURCE_SHIFT);
+HWDET_REGS_CHECK(stream_busy::mask, HWDET_STREAM_BUSY_MASK);
+HWDET_REGS_CHECK(stream_irq_half<stream_irq_enable>::mask << HWDET_IRQ_STREAM_SHIFT, HWDET_IRQ_STREAM_HALF_MASK);
+HWDET_REGS_CHECK(stream_irq_full<stream_irq_enable>::mask << HWDET_IRQ_STREAM_SHIFT, HWDET_IRQ_STREAM_FULL_MASK);
+HWDET_REGS_CHECK(ctl_enable::mask, HWDET_CTL_ENABLE_MASK);
+HWDET_REGS_CHECK(ctl_pid::mask, HWDET_CTL_PID_MASK);
+HWDET_REGS_CHECK(ctl_filtered::mask, HWDET_CTL_FILTERED_MASK);
+HWDET_REGS_CHECK(ctl_source::mask, HWDET_CTL_SOURCE_MASK);
+HWDET_REGS_CHECK(ctl_source::shift, HWDET_CTL_SOURCE_SHIFT);
+HWDET_REGS_CHECK(ctl_integ_clear::mask, HWDET_CTL_INTEG_CLEAR_MASK);
+HWDET_REGS_CHECK(ctl_gain_shift_bits::mask, HWDET_CTL_GAIN_SHIFT_MAX);
+
+} // namespace hwdet
+
+#ifdef XPAR_XTMRCTR_NUM_INSTANCES
+
+namespace tmrctr {
+
+HWDET_REGS_CHECK(timer_stride, XTC_TIMER_COUNTER_OFFSET);
+HWDET_REGS_CHECK(tcsr::offset, XTC_TCSR_OFFSET);
+HWDET_REGS_CHECK(tlr::offset, XTC_TLR_OFFSET);
+HWDET_REGS_CHECK(tcr::offset, XTC_TCR_OFFSET);
+HWDET_REGS_CHECK(csr_capture_mode::mask, XTC_CSR_CAPTURE_MODE_MASK);
+HWDET_REGS_CHECK(csr_down_count::mask, XTC_CSR_DOWN_COUNT_MASK);
+HWDET_REGS_CHECK(csr_ext_generate::mask, XTC_CSR_EXT_GENERATE_MASK);
+HWDET_REGS_CHECK(csr_ext_capture::mask, XTC_CSR_EXT_CAPTURE_MASK);
+HWDET_REGS_CHECK(csr_auto_reload::mask, XTC_CSR_AUTO_RELOAD_MASK);
+HWDET_REGS_CHECK(csr_load::mask, XTC_CSR_LOAD_MASK);
+HWDET_REGS_CHECK(csr_enable_int::mask, XTC_CSR_ENABLE_INT_MASK);
+HWDET_REGS_CHECK(csr_enable_tmr::mask, XTC_CSR_ENABLE_TMR_MASK);
+HWDET_REGS_CHECK(csr_int_occured::mask, XTC_CSR_INT_OCCURED_MASK);
+HWDET_REGS_CHECK(csr_enable_pwm::mask, XTC_CSR_ENABLE_PWM_MASK);
+HWDET_REGS_CHECK(csr_enable_all::mask, XTC_CSR_ENABLE_ALL_MASK);
+
+} // namespace tmrctr
+
+#endif
+
+#ifdef XPAR_XGPIO_NUM_INSTANCES
+
+namespace gpio {
+
+HWDET_REGS_CHECK(channel_stride, XGPIO_CHAN_OFFSET);
+HWDET_REGS_CHECK(data::offset, XGPIO_DATA_OFFSET);
+HWDET_REGS_CHECK(tri::offset, XGPIO_TRI_OFFSET);
+HWDET_REGS_CHECK(gie::offset, XGPIO_GIE_OFFSET);
+HWDET_REGS_CHECK(isr::offset, XGPIO_ISR_OFFSET);
+HWDET_REGS_CHECK(ier::offset, XGPIO_IER_OFFSET);
+HWDET_REGS_CHECK(gie_enable::mask, XGPIO_GIE_GINTR_ENABLE_MASK);
+HWDET_REGS_CHECK(ir_ch1<isr>::mask, XGPIO_IR_CH1_MASK);
+HWDET_REGS_CHECK(ir_ch2<isr>::mask, XGPIO_IR_CH2_MASK);
+
+} // namespace gpio
+
+#endif
+
+#undef HWDET_REGS_CHECK
+
+#endif
+
+#endif
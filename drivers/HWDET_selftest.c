@@ -5,12 +5,18 @@
 * @author Rehan Iqbal (riqbal@pdx.edu)
 * @copyright Portland State University, 2016
 *
-* This file implements the self-test function for the custom peripheral "HWDET". 
-* It writes to the last two memory addresses of the peripheral and then
+* This file implements the self-test functions for the custom peripheral "HWDET". 
+* The register test writes to the two scratch registers of the peripheral and then
 * reads those values back to make sure everything is correct.
 *
-* If there is any discrepancy between the two, it will return failure status.
-* Otherwise, it will return a successful status.
+* The loopback test switches the input of hw_detect.v over to the internal pulse
+* generator and checks the measured period, intervals and duty cycle against a
+* few known patterns, so the whole measurement path is exercised without the
+* light sensor attached.
+*
+* If there is any discrepancy, the tests return failure status. Otherwise, they
+* return a successful status. Neither test prints anything, so they are quick
+* enough to run on every boot.
 *
 */
 
@@ -19,6 +25,7 @@
 /****************************************************************************/
 
 #include "HWDET_l.h"
+#include "HWDET.h"
 #include "xparameters.h"
 #include "stdio.h"
 #include "xil_io.h"
@@ -29,6 +36,28 @@
 
 #define READ_WRITE_MUL_FACTOR 0x10
 
+// how many register reads to wait for the loopback periods to complete
+// (each pattern takes about 3000 clock cycles, a read takes about 10)
+
+#define LOOPBACK_TIMEOUT 10000
+
+// number of complete periods to wait for after changing the pattern
+
+#define LOOPBACK_SETTLE_PERIODS 4
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+// loopback patterns: clock cycles 'high', clock cycles 'low'
+
+static const u32 HWDET_LoopbackPatterns[][2] = {
+
+	{300, 700},			// 100kHz @ 100MHz, 30% duty cycle
+	{60, 40},			// 1MHz @ 100MHz, 60% duty cycle
+	{999, 1},			// 100kHz @ 100MHz, 99.9% duty cycle
+};
+
 /****************************************************************************/
 /************************** Function Definitions*****************************/
 /****************************************************************************/
@@ -57,35 +86,108 @@ XStatus HWDET_Reg_SelfTest(u32 baseaddr) {
 	int write_loop_index;
 	int read_loop_index;
 
-	xil_printf("******************************\n\r");
-	xil_printf("* HWDET Peripheral Self Test *\n\r");
-	xil_printf("******************************\n\n\r");
-
-	xil_printf("User logic slave module test...\n\r");
-
 	// write values to the last two registers...
-	// AXI: slv_reg2 & slv_reg3
+	// AXI: slv_reg6 & slv_reg7 (slv_reg0 - slv_reg5 are read-only)
 
-	for (write_loop_index = 2 ; write_loop_index < 4; write_loop_index++) {
+	for (write_loop_index = 6 ; write_loop_index < 8; write_loop_index++) {
 		
 		HWDET_mWriteReg (baseaddr, write_loop_index*4, (write_loop_index+1)*READ_WRITE_MUL_FACTOR);
-	    xil_printf ("\nWrote to memory address %x\n", (int)baseaddr + write_loop_index*4);
 	}
 	
 	// now read back the written values and make sure they match
 
-	for (read_loop_index = 2 ; read_loop_index < 4; read_loop_index++) {
+	for (read_loop_index = 6 ; read_loop_index < 8; read_loop_index++) {
 
 		if ( HWDET_mReadReg (baseaddr, read_loop_index*4) != (read_loop_index+1)*READ_WRITE_MUL_FACTOR) {
-	    	xil_printf ("Error reading register value at address %x\n", (int)baseaddr + read_loop_index*4);
 	    	return XST_FAILURE;
 		}
 	}
 
 	// no hazards encountered... return successful status
 
-	xil_printf("   - slave register write/read passed\n\n\r");
-
 	return XST_SUCCESS;
 
+}
+
+/****************************************************************************/
+/**
+ *
+ * Run an end-to-end test of the measurement path using the internal pulse
+ * generator. For each pattern in HWDET_LoopbackPatterns[] the generator is
+ * programmed, a few periods are allowed to complete, and the snapshot and
+ * the hardware duty cycle are checked against the expected values.
+ *
+ * The control and deglitch registers are restored afterwards, but the
+ * measurement results, FIFO, statistics and counters will hold loopback data.
+ *
+ * @param   baseaddr is the base address of the HWDET instance to be worked on.
+ *
+ * @return
+ *
+ *    - XST_SUCCESS   if every pattern was measured correctly
+ *    - XST_FAILURE   if a pattern was measured incorrectly or never completed
+ *
+ * @note    Takes about 150us at 100MHz.
+ *
+ */
+
+XStatus HWDET_Loopback_SelfTest(u32 baseaddr) {
+
+	XStatus status 	= XST_SUCCESS;
+	u32 ctrl 		= 0x00000000;
+	u32 deglitch 	= 0x00000000;
+	u32 high 		= 0x00000000;
+	u32 low 		= 0x00000000;
+	u32 start 		= 0x00000000;
+	int timeout 	= 0;
+	unsigned int n 	= 0;
+
+	// save the settings that the test has to change
+
+	ctrl = HWDET_mReadReg(baseaddr, HWDET_CTRL_OFFSET);
+	deglitch = HWDET_mReadReg(baseaddr, HWDET_DEGLITCH_OFFSET);
+
+	HWDET_mWriteReg(baseaddr, HWDET_DEGLITCH_OFFSET, 0);
+
+	for (n = 0; (n < sizeof(HWDET_LoopbackPatterns) / sizeof(HWDET_LoopbackPatterns[0])) && (status == XST_SUCCESS); n++) {
+
+		high = HWDET_LoopbackPatterns[n][0];
+		low = HWDET_LoopbackPatterns[n][1];
+
+		// program the generator, then turn on loopback (restarts the generator)
+
+		HWDET_mWriteReg(baseaddr, HWDET_PATGEN_HIGH_OFFSET, high);
+		HWDET_mWriteReg(baseaddr, HWDET_PATGEN_LOW_OFFSET, low);
+		HWDET_mWriteReg(baseaddr, HWDET_CTRL_OFFSET, ctrl & ~HWDET_CTRL_LOOPBACK_MASK);
+		HWDET_mWriteReg(baseaddr, HWDET_CTRL_OFFSET, ctrl | HWDET_CTRL_LOOPBACK_MASK);
+
+		// wait until a few complete periods of the new pattern were measured
+
+		start = HWDET_mReadReg(baseaddr, HWDET_PERIOD_COUNT_OFFSET);
+
+		for (timeout = LOOPBACK_TIMEOUT; timeout > 0; timeout--) {
+			if ((HWDET_mReadReg(baseaddr, HWDET_PERIOD_COUNT_OFFSET) - start) >= LOOPBACK_SETTLE_PERIODS) {
+				break;
+			}
+		}
+
+		// period = high + low, intervals are one less than the number of cycles,
+		// duty cycle = (high << 16) / (high + low) in Q16
+
+		if ((timeout == 0) ||
+			(HWDET_mReadReg(baseaddr, HWDET_SNAP_PERIOD_OFFSET) != high + low) ||
+			(HWDET_mReadReg(baseaddr, HWDET_SNAP_HIGH_OFFSET) != high - 1) ||
+			(HWDET_mReadReg(baseaddr, HWDET_SNAP_LOW_OFFSET) != low - 1) ||
+			(HWDET_mReadReg(baseaddr, HWDET_DUTY_Q16_OFFSET) != (high << 16) / (high + low))) {
+
+			status = XST_FAILURE;
+		}
+	}
+
+	// restore the saved settings
+
+	HWDET_mWriteReg(baseaddr, HWDET_CTRL_OFFSET, ctrl);
+	HWDET_mWriteReg(baseaddr, HWDET_DEGLITCH_OFFSET, deglitch);
+
+	return status;
 }
\ No newline at end of file
@@ -9,15 +9,33 @@
 		// Do not modify the parameters beyond this line
 
 		parameter integer 	CLK_FREQUENCY_HZ = 100000000,
+		parameter integer 	FIFO_ADDR_WIDTH = 10,
+		parameter integer 	HIST_ADDR_WIDTH = 10,
+		parameter integer 	NUM_CHANNELS = 1,
+		parameter integer 	USE_MEAS_CLK = 0,
+		parameter integer 	MEAS_CLK_FREQUENCY_HZ = 200000000,
 
 		// Parameters of Axi Slave Bus Interface S00_AXI
 		parameter integer C_S00_AXI_DATA_WIDTH	= 32,
-		parameter integer C_S00_AXI_ADDR_WIDTH	= 4
+		parameter integer C_S00_AXI_ADDR_WIDTH	= 12
 	)
 	(
 		// Users to add ports here
         
-        input wire		pwm_in,		        // PWM input signal from Microblaze
+        input wire [NUM_CHANNELS-1:0]	pwm_in,		// PWM input signals from Microblaze, one per channel
+        input wire		pwm_trig,		    // PWM carrier driving the LED --> connect to the AXI timer's pwm0
+        input wire		meas_clk,		    // faster measurement clock, e.g. from an MMCM (USE_MEAS_CLK = 1 only)
+        output wire		irq,		        // interrupt request --> connect to the AXI interrupt controller
+        output wire		ctl_pwm,		    // PWM from the closed-loop controller --> LED driver
+        output wire		ctl_active,		    // high while the closed-loop controller owns the LED
+
+        // record stream --> connect to the S2MM port of an AXI DMA (clocked by meas_clk
+        // with USE_MEAS_CLK = 1, by s00_axi_aclk otherwise)
+        output wire		m00_axis_tvalid,
+        output wire [31:0]	m00_axis_tdata,
+        output wire [3:0]	m00_axis_tstrb,
+        output wire		m00_axis_tlast,
+        input wire		m00_axis_tready,
 
 		// User ports ends
 		// Do not modify the ports beyond this line
@@ -48,6 +66,12 @@
 	);
 // Instantiation of Axi Bus Interface S00_AXI
 	HWDET_v1_0_S00_AXI # ( 
+		.CLK_FREQUENCY_HZ(CLK_FREQUENCY_HZ),
+		.FIFO_ADDR_WIDTH(FIFO_ADDR_WIDTH),
+		.HIST_ADDR_WIDTH(HIST_ADDR_WIDTH),
+		.NUM_CHANNELS(NUM_CHANNELS),
+		.USE_MEAS_CLK(USE_MEAS_CLK),
+		.MEAS_CLK_FREQUENCY_HZ(MEAS_CLK_FREQUENCY_HZ),
 		.C_S_AXI_DATA_WIDTH(C_S00_AXI_DATA_WIDTH),
 		.C_S_AXI_ADDR_WIDTH(C_S00_AXI_ADDR_WIDTH)
 	) 
@@ -57,6 +81,19 @@
         // hw_detect.v signals
         
         .pwm_in(pwm_in),                               // tie S00's pwm_in port to the top-level port
+        .pwm_trig(pwm_trig),                           // tie S00's pwm_trig port to the top-level port
+        .meas_clk(meas_clk),                           // tie S00's meas_clk port to the top-level port
+        .irq(irq),                                     // tie S00's irq port to the top-level port
+        .ctl_pwm(ctl_pwm),                             // tie S00's ctl_pwm port to the top-level port
+        .ctl_active(ctl_active),                       // tie S00's ctl_active port to the top-level port
+
+        // record stream signals
+
+        .M_AXIS_TVALID(m00_axis_tvalid),
+        .M_AXIS_TDATA(m00_axis_tdata),
+        .M_AXIS_TSTRB(m00_axis_tstrb),
+        .M_AXIS_TLAST(m00_axis_tlast),
+        .M_AXIS_TREADY(m00_axis_tready),
 
         // AXI bus signals
         
@@ -15,14 +15,38 @@
 // This is the AXI4_Lite bus interface to the hardware pulse detection module
 // written in Verilog for Project #2 of ECE 544.
 //
-// This custom peripheral instantiates the hw_detect.v module and
-// connects it to the appropriate slave registers for communication with the Microblaze.
-
-// Slave Registers are mapped as follows:
-//		slv_reg0		(high_count) how long PWM was high --> coming from hw_detect.v
-//		slv_reg1		(low_count) how long PWM was low --> coming from hw_detect.v
-//		slv_reg2		*RESERVED*
-//		slv_reg3		*RESERVED*
+// This custom peripheral instantiates NUM_CHANNELS copies of hwdet_channel.v (one
+// hw_detect.v module each) and connects them to banks of slave registers for
+// communication with the Microblaze.
+
+// Each channel owns a bank of 64 slave registers (256 bytes). Channel n starts at
+// byte offset n * 0x100; bank addresses for channels >= NUM_CHANNELS read as 0 and
+// ignore writes. The registers inside a bank are described in hwdet_channel.v.
+//
+// Bank 8 (byte offset 0x800) holds the record stream registers (hwdet_stream.v). The stream
+// sends every complete period of one channel out of the M_AXIS port, for an AXI DMA to write
+// into a ring buffer in DDR. M_AXIS is synchronous to the measurement clock (see below).
+//
+// Bank 9 (byte offset 0x900) holds the closed-loop controller (hwdet_ctrl.v). It turns every
+// new frequency of one channel into a PWM compare value (bang-bang or PID) and drives
+// 'ctl_pwm' itself; 'ctl_active' tells the top level to use it instead of the AXI timer.
+//
+// The 'irq' output is active-high and is the OR of the interrupt requests of all channels
+// and of the record stream.
+//
+// A free-running 64-bit cycle counter is shared by all channels, so edge timestamps
+// from different channels can be compared directly.
+//
+// 'pwm_trig' is the PWM carrier that drives the LED (the AXI timer's pwm0). It is shared
+// by all channels, which can count their input over whole carrier periods (hwdet_sync.v).
+//
+// With USE_MEAS_CLK = 0 every channel runs on S_AXI_ACLK. With USE_MEAS_CLK = 1 the channels,
+// the cycle counter and the record stream run on 'meas_clk' (MEAS_CLK_FREQUENCY_HZ, e.g. 200MHz
+// from an MMCM) instead, so every count and timestamp has the resolution of the faster clock.
+// The register strobes then cross into that clock through hwdet_bus_cdc.v, which holds off the
+// AXI handshake until a read has returned; 'pwm_in', 'pwm_trig' and 'irq' go through two-flop
+// synchronizers.
+// Each channel reports the frequency of the clock it counts in its CLK_FREQ register.
 //
 // ***************************************************************************
 
@@ -31,6 +55,11 @@
 		// Users to add parameters here
 		
 		parameter integer 	CLK_FREQUENCY_HZ = 100000000,
+		parameter integer 	FIFO_ADDR_WIDTH = 10,		// sample FIFO holds 2^FIFO_ADDR_WIDTH periods (1 - 14)
+		parameter integer 	HIST_ADDR_WIDTH = 10,		// period histogram has 2^HIST_ADDR_WIDTH bins (1 - 16)
+		parameter integer 	NUM_CHANNELS = 1,			// number of PWM inputs measured (1 - 8)
+		parameter integer 	USE_MEAS_CLK = 0,			// 1 = measure on 'meas_clk' instead of S_AXI_ACLK
+		parameter integer 	MEAS_CLK_FREQUENCY_HZ = 200000000,	// frequency of 'meas_clk'
 
 		// User parameters ends
 		// Do not modify the parameters beyond this line
@@ -38,12 +67,24 @@
 		// Width of S_AXI data bus
 		parameter integer C_S_AXI_DATA_WIDTH	= 32,
 		// Width of S_AXI address bus
-		parameter integer C_S_AXI_ADDR_WIDTH	= 4
+		parameter integer C_S_AXI_ADDR_WIDTH	= 12
 	)
 	(
 		// Users to add ports here
         
-        input wire		pwm_in,		        // PWM input signal from embedded system
+        input wire [NUM_CHANNELS-1:0]	pwm_in,		// PWM input signals from embedded system, one per channel
+        input wire		pwm_trig,		    // PWM carrier driving the LED, shared by all channels
+        input wire		meas_clk,		    // measurement clock (only used with USE_MEAS_CLK = 1)
+        output wire		irq,		        // level-sensitive interrupt request (active-high)
+        output wire		ctl_pwm,		    // PWM from the closed-loop controller (measurement clock)
+        output wire		ctl_active,		    // closed-loop controller is enabled
+
+        // AXI4-Stream master for the record stream (clocked by the measurement clock)
+        output wire		M_AXIS_TVALID,
+        output wire [31:0]	M_AXIS_TDATA,
+        output wire [3:0]	M_AXIS_TSTRB,
+        output wire		M_AXIS_TLAST,
+        input wire		M_AXIS_TREADY,
 
 		// User ports ends
 		// Do not modify the ports beyond this line
@@ -128,19 +169,43 @@
 	// ADDR_LSB = 2 for 32 bits (n downto 2)
 	// ADDR_LSB = 3 for 64 bits (n downto 3)
 	localparam integer ADDR_LSB = (C_S_AXI_DATA_WIDTH/32) + 1;
-	localparam integer OPT_MEM_ADDR_BITS = 1;
+	localparam integer OPT_MEM_ADDR_BITS = 5;
 	//----------------------------------------------
 	//-- Signals for user logic register space example
 	//------------------------------------------------
-	//-- Number of Slave Registers 4
-	reg [C_S_AXI_DATA_WIDTH-1:0]	slv_reg0;
-	reg [C_S_AXI_DATA_WIDTH-1:0]	slv_reg1;
-	reg [C_S_AXI_DATA_WIDTH-1:0]	slv_reg2;
-	reg [C_S_AXI_DATA_WIDTH-1:0]	slv_reg3;
+	//-- Number of Slave Registers 64 per channel
+	//-- the slave registers live in hwdet_channel.v; the bits above the register
+	//-- number select the channel bank
+	localparam integer CH_ADDR_LSB = ADDR_LSB + OPT_MEM_ADDR_BITS + 1;
+	localparam integer CH_ADDR_BITS = C_S_AXI_ADDR_WIDTH - CH_ADDR_LSB;
+	wire [CH_ADDR_BITS-1:0]	wr_channel;
+	wire [CH_ADDR_BITS-1:0]	rd_channel;
+	wire [C_S_AXI_DATA_WIDTH-1:0]	ch_rd_data [0:NUM_CHANNELS-1];
+	wire [NUM_CHANNELS-1:0]	ch_irq;
+	//-- bank 8 is the record stream, above the largest possible channel bank
+	localparam integer STREAM_BANK = 8;
+	wire [C_S_AXI_DATA_WIDTH-1:0]	stream_rd_data;
+	wire	 stream_irq;
+	//-- bank 9 is the closed-loop controller
+	localparam integer CTRL_BANK = 9;
+	wire [C_S_AXI_DATA_WIDTH-1:0]	ctrl_rd_data;
 	wire	 slv_reg_rden;
 	wire	 slv_reg_wren;
 	reg [C_S_AXI_DATA_WIDTH-1:0]	 reg_data_out;
-	integer	 byte_index;
+	//-- register strobes as seen by the channels (in the measurement clock)
+	wire	 bus_wr_en;
+	wire [C_S_AXI_ADDR_WIDTH-1:0]	bus_wr_addr;
+	wire [C_S_AXI_DATA_WIDTH-1:0]	bus_wr_data;
+	wire [(C_S_AXI_DATA_WIDTH/8)-1:0]	bus_wr_strb;
+	wire	 bus_rd_en;
+	wire [C_S_AXI_ADDR_WIDTH-1:0]	bus_rd_addr;
+	//-- with USE_MEAS_CLK = 1 no new access is accepted while one is crossing
+	wire	 bus_busy;
+	wire	 cdc_busy;
+	wire	 cdc_rd_done;
+	wire [C_S_AXI_DATA_WIDTH-1:0]	cdc_rd_data;
+	wire	 meas_clock;
+	wire	 meas_reset;
 
 	// I/O Connections assignments
 
@@ -165,7 +230,7 @@
 	    end 
 	  else
 	    begin    
-	      if (~axi_awready && S_AXI_AWVALID && S_AXI_WVALID)
+	      if (~axi_awready && S_AXI_AWVALID && S_AXI_WVALID && ~bus_busy)
 	        begin
 	          // slave is ready to accept write address when 
 	          // there is a valid write address and write data
@@ -192,7 +257,7 @@
 	    end 
 	  else
 	    begin    
-	      if (~axi_awready && S_AXI_AWVALID && S_AXI_WVALID)
+	      if (~axi_awready && S_AXI_AWVALID && S_AXI_WVALID && ~bus_busy)
 	        begin
 	          // Write Address latching 
 	          axi_awaddr <= S_AXI_AWADDR;
@@ -213,7 +278,7 @@
 	    end 
 	  else
 	    begin    
-	      if (~axi_wready && S_AXI_WVALID && S_AXI_AWVALID)
+	      if (~axi_wready && S_AXI_WVALID && S_AXI_AWVALID && ~bus_busy)
 	        begin
 	          // slave is ready to accept write data when 
 	          // there is a valid write address and write data
@@ -237,57 +302,7 @@
 	// and the slave is ready to accept the write address and write data.
 	assign slv_reg_wren = axi_wready && S_AXI_WVALID && axi_awready && S_AXI_AWVALID;
 
-	always @( posedge S_AXI_ACLK )
-	begin
-	  if ( S_AXI_ARESETN == 1'b0 )
-	    begin
-	      slv_reg0 <= 0;
-	      slv_reg1 <= 0;
-	      slv_reg2 <= 0;
-	      slv_reg3 <= 0;
-	    end 
-	  else begin
-	    if (slv_reg_wren)
-	      begin
-	        case ( axi_awaddr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB] )
-	          2'h0:
-	            for ( byte_index = 0; byte_index <= (C_S_AXI_DATA_WIDTH/8)-1; byte_index = byte_index+1 )
-	              if ( S_AXI_WSTRB[byte_index] == 1 ) begin
-	                // Respective byte enables are asserted as per write strobes 
-	                // Slave register 0
-	                slv_reg0[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
-	              end  
-	          2'h1:
-	            for ( byte_index = 0; byte_index <= (C_S_AXI_DATA_WIDTH/8)-1; byte_index = byte_index+1 )
-	              if ( S_AXI_WSTRB[byte_index] == 1 ) begin
-	                // Respective byte enables are asserted as per write strobes 
-	                // Slave register 1
-	                slv_reg1[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
-	              end  
-	          2'h2:
-	            for ( byte_index = 0; byte_index <= (C_S_AXI_DATA_WIDTH/8)-1; byte_index = byte_index+1 )
-	              if ( S_AXI_WSTRB[byte_index] == 1 ) begin
-	                // Respective byte enables are asserted as per write strobes 
-	                // Slave register 2
-	                slv_reg2[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
-	              end  
-	          2'h3:
-	            for ( byte_index = 0; byte_index <= (C_S_AXI_DATA_WIDTH/8)-1; byte_index = byte_index+1 )
-	              if ( S_AXI_WSTRB[byte_index] == 1 ) begin
-	                // Respective byte enables are asserted as per write strobes 
-	                // Slave register 3
-	                slv_reg3[(byte_index*8) +: 8] <= S_AXI_WDATA[(byte_index*8) +: 8];
-	              end  
-	          default : begin
-	                      slv_reg0 <= slv_reg0;
-	                      slv_reg1 <= slv_reg1;
-	                      slv_reg2 <= slv_reg2;
-	                      slv_reg3 <= slv_reg3;
-	                    end
-	        endcase
-	      end
-	  end
-	end    
+	// the write itself is done by the channel selected by axi_awaddr (see the user logic)
 
 	// Implement write response logic generation
 	// The write response and response valid signals are asserted by the slave 
@@ -338,7 +353,7 @@
 	    end 
 	  else
 	    begin    
-	      if (~axi_arready && S_AXI_ARVALID)
+	      if (~axi_arready && S_AXI_ARVALID && ~bus_busy)
 	        begin
 	          // indicates that the slave has acceped the valid read address
 	          axi_arready <= 1'b1;
@@ -369,9 +384,10 @@
 	    end 
 	  else
 	    begin    
-	      if (axi_arready && S_AXI_ARVALID && ~axi_rvalid)
+	      if ((USE_MEAS_CLK == 0) ? (axi_arready && S_AXI_ARVALID && ~axi_rvalid) : cdc_rd_done)
 	        begin
 	          // Valid read data is available at the read data bus
+	          // (with USE_MEAS_CLK = 1, once it is back from the measurement clock)
 	          axi_rvalid <= 1'b1;
 	          axi_rresp  <= 2'b0; // 'OKAY' response
 	        end   
@@ -390,21 +406,15 @@
 	always @(*)
 	begin
 	      // Address decoding for reading registers
-	      case ( axi_araddr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB] )
-	      
-	      // map the hw_detect.v outputs to slave registers 0 - 1
-	      // these should be read-only registers
-	      
-	        2'h0   : reg_data_out <= high_count;
-	        2'h1   : reg_data_out <= low_count;
-	        
-	        // keep the default settings for slave registers 2 - 3
-	        // these will be used in the self-test program
-	        
-	        2'h2   : reg_data_out <= slv_reg2;
-	        2'h3   : reg_data_out <= slv_reg3;
-	        default : reg_data_out <= 0;
-	      endcase
+	      // the channel bank is selected by the upper address bits; each channel decodes its own registers
+	      if ( rd_channel < NUM_CHANNELS )
+	        reg_data_out <= ch_rd_data[rd_channel];
+	      else if ( rd_channel == STREAM_BANK )
+	        reg_data_out <= stream_rd_data;
+	      else if ( rd_channel == CTRL_BANK )
+	        reg_data_out <= ctrl_rd_data;
+	      else
+	        reg_data_out <= 0;
 	end
 
 	// Output register or memory read data
@@ -419,29 +429,274 @@
 	      // When there is a valid read address (S_AXI_ARVALID) with 
 	      // acceptance of read address by the slave (axi_arready), 
 	      // output the read dada 
-	      if (slv_reg_rden)
+	      if (USE_MEAS_CLK == 0 && slv_reg_rden)
 	        begin
 	          axi_rdata <= reg_data_out;     // register read data
 	        end   
+	      else if (USE_MEAS_CLK != 0 && cdc_rd_done)
+	        begin
+	          axi_rdata <= cdc_rd_data;      // register read data from the measurement clock
+	        end   
 	    end
 	end    
 
 	// Add user logic here
     
-    wire    [31:0]      high_count;
-    wire    [31:0]      low_count;
-    
-    // instantiate the hw_detect.v module
-    
-    hw_detect HWDET (
+    assign wr_channel = bus_wr_addr[C_S_AXI_ADDR_WIDTH-1:CH_ADDR_LSB];
+    assign rd_channel = bus_rd_addr[C_S_AXI_ADDR_WIDTH-1:CH_ADDR_LSB];
+
+    wire    [NUM_CHANNELS-1:0]  meas_pwm_in;
+    wire                meas_pwm_trig;
+    wire                meas_irq;
+
+    assign meas_irq = (|ch_irq) | stream_irq;
+
+    // pick the clock the channels count in, and connect the register strobes to it
+
+    generate
+      if (USE_MEAS_CLK != 0)
+        begin : MEAS_CLK
+
+          (* ASYNC_REG = "TRUE" *)
+          reg     [1:0]               reset_sync;
+          (* ASYNC_REG = "TRUE" *)
+          reg     [NUM_CHANNELS-1:0]  pwm_sync1;
+          reg     [NUM_CHANNELS-1:0]  pwm_sync2;
+          (* ASYNC_REG = "TRUE" *)
+          reg     [1:0]               trig_sync;
+          (* ASYNC_REG = "TRUE" *)
+          reg     [1:0]               irq_sync;
+
+          assign meas_clock = meas_clk;
+          assign meas_reset = reset_sync[1];
+          assign meas_pwm_in = pwm_sync2;
+          assign meas_pwm_trig = trig_sync[1];
+          assign irq = irq_sync[1];
+
+          // reset is asserted right away and released two measurement clocks later
+
+          always @( posedge meas_clk or negedge S_AXI_ARESETN )
+          begin
+            if ( S_AXI_ARESETN == 1'b0 )
+              reset_sync <= 2'b11;
+            else
+              reset_sync <= {reset_sync[0], 1'b0};
+          end
+
+          always @( posedge meas_clk )
+          begin
+            pwm_sync1 <= pwm_in;
+            pwm_sync2 <= pwm_sync1;
+            trig_sync <= {trig_sync[0], pwm_trig};
+          end
+
+          always @( posedge S_AXI_ACLK )
+          begin
+            irq_sync <= {irq_sync[0], meas_irq};
+          end
+
+          // the access being accepted this clock counts as busy too, so a read
+          // can't slip in behind a write that hasn't reached the bridge yet
+
+          assign bus_busy = cdc_busy || axi_rvalid || axi_awready || axi_arready;
+
+          hwdet_bus_cdc #(
+              .ADDR_WIDTH         (C_S_AXI_ADDR_WIDTH))
+
+          BUS_CDC (
+
+              .s_clock            (S_AXI_ACLK),       // I [ 0 ] AXI clock
+              .s_reset            (!S_AXI_ARESETN),   // I [ 0 ] active-low reset signal from AXI S00 interface
+              .s_wr_en            (slv_reg_wren),     // I [ 0 ] register write strobe
+              .s_wr_addr          (axi_awaddr),       // I [11:0] register being written
+              .s_wr_data          (S_AXI_WDATA),      // I [31:0] write data
+              .s_wr_strb          (S_AXI_WSTRB),      // I [3:0] byte enables
+              .s_rd_en            (slv_reg_rden),     // I [ 0 ] register read strobe
+              .s_rd_addr          (axi_araddr),       // I [11:0] register being read
+              .s_rd_data          (cdc_rd_data),      // O [31:0] read data
+              .s_rd_done          (cdc_rd_done),      // O [ 0 ] read data is valid
+              .busy               (cdc_busy),         // O [ 0 ] access in flight
+
+              .m_clock            (meas_clk),         // I [ 0 ] measurement clock
+              .m_reset            (meas_reset),       // I [ 0 ] reset in the measurement clock
+              .m_wr_en            (bus_wr_en),        // O [ 0 ] register write strobe
+              .m_wr_addr          (bus_wr_addr),      // O [11:0] register being written
+              .m_wr_data          (bus_wr_data),      // O [31:0] write data
+              .m_wr_strb          (bus_wr_strb),      // O [3:0] byte enables
+              .m_rd_en            (bus_rd_en),        // O [ 0 ] register read strobe
+              .m_rd_addr          (bus_rd_addr),      // O [11:0] register being read
+              .m_rd_data          (reg_data_out));    // I [31:0] register contents
+
+        end
+      else
+        begin : AXI_CLK
+
+          assign meas_clock = S_AXI_ACLK;
+          assign meas_reset = !S_AXI_ARESETN;
+          assign meas_pwm_in = pwm_in;
+          assign meas_pwm_trig = pwm_trig;
+          assign irq = meas_irq;
+
+          assign bus_busy = 1'b0;
+          assign cdc_busy = 1'b0;
+          assign cdc_rd_done = 1'b0;
+          assign cdc_rd_data = 0;
+
+          assign bus_wr_en = slv_reg_wren;
+          assign bus_wr_addr = axi_awaddr;
+          assign bus_wr_data = S_AXI_WDATA;
+          assign bus_wr_strb = S_AXI_WSTRB;
+          assign bus_rd_en = slv_reg_rden;
+          assign bus_rd_addr = axi_araddr;
+
+        end
+    endgenerate
+
+    // free-running cycle counter for the edge timestamps
+    // at 100MHz it wraps around after more than 5000 years
+
+    reg     [63:0]      cycle_count;
+
+    always @( posedge meas_clock )
+    begin
+      if ( meas_reset )
+        begin
+          cycle_count <= 0;
+        end
+      else
+        begin
+          cycle_count <= cycle_count + 1;
+        end
+    end
+
+    wire                ch_rec_valid [0:NUM_CHANNELS-1];
+    wire    [63:0]      ch_rec_ts    [0:NUM_CHANNELS-1];
+    wire    [31:0]      ch_rec_high  [0:NUM_CHANNELS-1];
+    wire    [31:0]      ch_rec_low   [0:NUM_CHANNELS-1];
+    wire                ch_freq_valid [0:NUM_CHANNELS-1];
+    wire    [31:0]      ch_freq_hz    [0:NUM_CHANNELS-1];
+    wire                ch_filt_valid [0:NUM_CHANNELS-1];
+    wire    [31:0]      ch_filt_hz    [0:NUM_CHANNELS-1];
+
+    // instantiate one measurement channel per PWM input
+    // every channel sees the register strobes only for its own bank
+
+    genvar ch;
+
+    generate
+      for (ch = 0; ch < NUM_CHANNELS; ch = ch + 1)
+        begin : CHANNEL
+
+          hwdet_channel #(
+              .CLK_FREQUENCY_HZ   (USE_MEAS_CLK ? MEAS_CLK_FREQUENCY_HZ : CLK_FREQUENCY_HZ),
+              .FIFO_ADDR_WIDTH    (FIFO_ADDR_WIDTH),
+              .HIST_ADDR_WIDTH    (HIST_ADDR_WIDTH),
+              .CHANNEL            (ch),
+              .NUM_CHANNELS       (NUM_CHANNELS))
+
+          HWDET_CH (
+
+              .clock              (meas_clock),       // I [ 0 ] measurement clock
+              .reset              (meas_reset),       // I [ 0 ] active-high reset in the measurement clock
+              .pwm_in             (meas_pwm_in[ch]),  // I [ 0 ] PWM signal for this channel
+              .pwm_trig           (meas_pwm_trig),    // I [ 0 ] PWM carrier driving the LED
+              .timestamp          (cycle_count),      // I [63:0] free-running cycle counter
+
+              .wr_en              (bus_wr_en && (wr_channel == ch)),                    // I [ 0 ] write to this bank
+              .wr_addr            (bus_wr_addr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB]),   // I [5:0] register number
+              .wr_data            (bus_wr_data),      // I [31:0] write data
+              .wr_strb            (bus_wr_strb),      // I [3:0] byte enables
+
+              .rd_en              (bus_rd_en && (rd_channel == ch)),                    // I [ 0 ] read from this bank
+              .rd_addr            (bus_rd_addr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB]),   // I [5:0] register number
+              .rd_data            (ch_rd_data[ch]),   // O [31:0] register contents
+
+              .rec_valid          (ch_rec_valid[ch]), // O [ 0 ] pulse when a complete period is latched
+              .rec_ts             (ch_rec_ts[ch]),    // O [63:0] timestamp of the rising edge ending it
+              .rec_high           (ch_rec_high[ch]),  // O [31:0] 'high' interval of that period
+              .rec_low            (ch_rec_low[ch]),   // O [31:0] 'low' interval of that period
+
+              .ctl_freq_valid     (ch_freq_valid[ch]),    // O [ 0 ] new frequency of the last period
+              .ctl_freq_hz        (ch_freq_hz[ch]),       // O [31:0] that frequency in Hz
+              .ctl_filt_valid     (ch_filt_valid[ch]),    // O [ 0 ] new filtered frequency
+              .ctl_filt_hz        (ch_filt_hz[ch]),       // O [31:0] that frequency in Hz
+
+              .irq                (ch_irq[ch]));      // O [ 0 ] interrupt request from this channel
+
+        end
+    endgenerate
+
+    // record stream: every complete period of the selected channel goes out of
+    // M_AXIS to the DMA; a channel number >= NUM_CHANNELS sends nothing
+
+    wire    [2:0]       stream_source;
+    wire                stream_valid;
+
+    assign stream_valid = (stream_source < NUM_CHANNELS) ? ch_rec_valid[stream_source] : 1'b0;
+
+    hwdet_stream HWDET_STREAM (
+
+        .clock              (meas_clock),       // I [ 0 ] measurement clock
+        .reset              (meas_reset),       // I [ 0 ] active-high reset in the measurement clock
+
+        .wr_en              (bus_wr_en && (wr_channel == STREAM_BANK)),           // I [ 0 ] write to this bank
+        .wr_addr            (bus_wr_addr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB]),   // I [5:0] register number
+        .wr_data            (bus_wr_data),      // I [31:0] write data
+        .wr_strb            (bus_wr_strb),      // I [3:0] byte enables
+
+        .rd_en              (bus_rd_en && (rd_channel == STREAM_BANK)),           // I [ 0 ] read from this bank
+        .rd_addr            (bus_rd_addr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB]),   // I [5:0] register number
+        .rd_data            (stream_rd_data),   // O [31:0] register contents
+
+        .source             (stream_source),    // O [2:0] channel whose periods are sent
+        .rec_valid          (stream_valid),     // I [ 0 ] selected channel latched a period
+        .rec_ts             (ch_rec_ts[stream_source]),     // I [63:0] rising edge timestamp
+        .rec_high           (ch_rec_high[stream_source]),   // I [31:0] 'high' interval
+        .rec_low            (ch_rec_low[stream_source]),    // I [31:0] 'low' interval
+
+        .m_axis_tvalid      (M_AXIS_TVALID),    // O [ 0 ] beat is valid
+        .m_axis_tdata       (M_AXIS_TDATA),     // O [31:0] beat data
+        .m_axis_tstrb       (M_AXIS_TSTRB),     // O [3:0] byte enables
+        .m_axis_tlast       (M_AXIS_TLAST),     // O [ 0 ] last beat of a DMA block
+        .m_axis_tready      (M_AXIS_TREADY),    // I [ 0 ] DMA accepts the beat
+
+        .irq                (stream_irq));      // O [ 0 ] ring half full / full
+
+    // closed-loop controller: every new frequency of the selected channel (raw or
+    // filtered) updates the PWM compare value; a channel number >= NUM_CHANNELS
+    // never updates it
+
+    wire    [2:0]       ctrl_source;
+    wire                ctrl_use_filt;
+    wire                ctrl_valid;
+    wire    [31:0]      ctrl_freq;
+
+    assign ctrl_valid = (ctrl_source >= NUM_CHANNELS) ? 1'b0 :
+                        ctrl_use_filt ? ch_filt_valid[ctrl_source] : ch_freq_valid[ctrl_source];
+    assign ctrl_freq  = ctrl_use_filt ? ch_filt_hz[ctrl_source] : ch_freq_hz[ctrl_source];
+
+    hwdet_ctrl HWDET_CTRL (
+
+        .clock              (meas_clock),       // I [ 0 ] measurement clock
+        .reset              (meas_reset),       // I [ 0 ] active-high reset in the measurement clock
+
+        .wr_en              (bus_wr_en && (wr_channel == CTRL_BANK)),             // I [ 0 ] write to this bank
+        .wr_addr            (bus_wr_addr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB]),   // I [5:0] register number
+        .wr_data            (bus_wr_data),      // I [31:0] write data
+        .wr_strb            (bus_wr_strb),      // I [3:0] byte enables
+
+        .rd_en              (bus_rd_en && (rd_channel == CTRL_BANK)),             // I [ 0 ] read from this bank
+        .rd_addr            (bus_rd_addr[ADDR_LSB+OPT_MEM_ADDR_BITS:ADDR_LSB]),   // I [5:0] register number
+        .rd_data            (ctrl_rd_data),     // O [31:0] register contents
+
+        .source             (ctrl_source),      // O [2:0] channel that is controlled
+        .use_filt           (ctrl_use_filt),    // O [ 0 ] use the filtered frequency
+        .freq_valid         (ctrl_valid),       // I [ 0 ] selected channel published a frequency
+        .freq_hz            (ctrl_freq),        // I [31:0] that frequency in Hz
 
-        .clock              (S_AXI_ACLK),       // I [ 0 ] 100MHz system clock
-        .reset              (!S_AXI_ARESETN),   // I [ 0 ] active-low reset signal from AXI S00 interface
-        .pwm                (pwm_in),           // I [ 0 ] PWM signal from AXI Timer in embedded system
+        .pwm                (ctl_pwm),          // O [ 0 ] PWM output driving the LED
+        .active             (ctl_active));      // O [ 0 ] controller is enabled
 
-        .high_count         (high_count),       // O [31:0] how long PWM was 'high' --> send to Microblaze
-        .low_count          (low_count));       // O [31:0] how long PWM was 'low' --> send to Microblaze
-       
 	// User logic ends
 
 	endmodule
@@ -0,0 +1,99 @@
+
+`timescale 1 ns / 1 ps
+
+	module PWMGEN_v1_0 #
+	(
+		// Users to add parameters here
+        
+		// User parameters ends
+		// Do not modify the parameters beyond this line
+
+		parameter integer 	CLK_FREQUENCY_HZ = 100000000,
+		parameter integer 	NUM_PHASES = 1,
+
+		// Parameters of Axi Slave Bus Interface S00_AXI
+		parameter integer C_S00_AXI_DATA_WIDTH	= 32,
+		parameter integer C_S00_AXI_ADDR_WIDTH	= 7
+	)
+	(
+		// Users to add ports here
+        
+        output wire		pwm_out,		    // PWM output --> LED driver
+        output wire		pwm_active,		    // high while the generator is enabled --> selects it for the LED
+        output wire [NUM_PHASES-1:0]	pwm_h,		// high-side switch of each phase --> half bridge gate drivers
+        output wire [NUM_PHASES-1:0]	pwm_l,		// low-side switch of each phase --> half bridge gate drivers
+
+		// User ports ends
+		// Do not modify the ports beyond this line
+
+
+		// Ports of Axi Slave Bus Interface S00_AXI
+		input wire  s00_axi_aclk,
+		input wire  s00_axi_aresetn,
+		input wire [C_S00_AXI_ADDR_WIDTH-1 : 0] s00_axi_awaddr,
+		input wire [2 : 0] s00_axi_awprot,
+		input wire  s00_axi_awvalid,
+		output wire  s00_axi_awready,
+		input wire [C_S00_AXI_DATA_WIDTH-1 : 0] s00_axi_wdata,
+		input wire [(C_S00_AXI_DATA_WIDTH/8)-1 : 0] s00_axi_wstrb,
+		input wire  s00_axi_wvalid,
+		output wire  s00_axi_wready,
+		output wire [1 : 0] s00_axi_bresp,
+		output wire  s00_axi_bvalid,
+		input wire  s00_axi_bready,
+		input wire [C_S00_AXI_ADDR_WIDTH-1 : 0] s00_axi_araddr,
+		input wire [2 : 0] s00_axi_arprot,
+		input wire  s00_axi_arvalid,
+		output wire  s00_axi_arready,
+		output wire [C_S00_AXI_DATA_WIDTH-1 : 0] s00_axi_rdata,
+		output wire [1 : 0] s00_axi_rresp,
+		output wire  s00_axi_rvalid,
+		input wire  s00_axi_rready
+	);
+// Instantiation of Axi Bus Interface S00_AXI
+	PWMGEN_v1_0_S00_AXI # ( 
+		.CLK_FREQUENCY_HZ(CLK_FREQUENCY_HZ),
+		.NUM_PHASES(NUM_PHASES),
+		.C_S_AXI_DATA_WIDTH(C_S00_AXI_DATA_WIDTH),
+		.C_S_AXI_ADDR_WIDTH(C_S00_AXI_ADDR_WIDTH)
+	) 
+	
+	PWMGEN_v1_0_S00_AXI_inst (
+
+        // pwmgen.v signals
+        
+        .pwm_out(pwm_out),                             // tie S00's pwm_out port to the top-level port
+        .pwm_active(pwm_active),                       // tie S00's pwm_active port to the top-level port
+        .pwm_h(pwm_h),                                 // tie S00's pwm_h port to the top-level port
+        .pwm_l(pwm_l),                                 // tie S00's pwm_l port to the top-level port
+
+        // AXI bus signals
+        
+		.S_AXI_ACLK(s00_axi_aclk),
+		.S_AXI_ARESETN(s00_axi_aresetn),
+		.S_AXI_AWADDR(s00_axi_awaddr),
+		.S_AXI_AWPROT(s00_axi_awprot),
+		.S_AXI_AWVALID(s00_axi_awvalid),
+		.S_AXI_AWREADY(s00_axi_awready),
+		.S_AXI_WDATA(s00_axi_wdata),
+		.S_AXI_WSTRB(s00_axi_wstrb),
+		.S_AXI_WVALID(s00_axi_wvalid),
+		.S_AXI_WREADY(s00_axi_wready),
+		.S_AXI_BRESP(s00_axi_bresp),
+		.S_AXI_BVALID(s00_axi_bvalid),
+		.S_AXI_BREADY(s00_axi_bready),
+		.S_AXI_ARADDR(s00_axi_araddr),
+		.S_AXI_ARPROT(s00_axi_arprot),
+		.S_AXI_ARVALID(s00_axi_arvalid),
+		.S_AXI_ARREADY(s00_axi_arready),
+		.S_AXI_RDATA(s00_axi_rdata),
+		.S_AXI_RRESP(s00_axi_rresp),
+		.S_AXI_RVALID(s00_axi_rvalid),
+		.S_AXI_RREADY(s00_axi_rready)
+	);
+
+	// Add user logic here
+
+	// User logic ends
+
+	endmodule
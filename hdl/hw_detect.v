@@ -12,6 +12,69 @@
 // It implements a simple state machine to determine high-to-low and low-to-high
 // transitions, and then store a counted value to one of two registers.
 //
+// On every low-to-high transition the module also latches a snapshot of the
+// period that just finished: the high interval, the low interval, the full
+// period (high + low + 2) and a sequence number. All four snapshot values
+// change in the same clock cycle, so a high interval from one period is never
+// paired with the low interval of another.
+//
+// Each new snapshot is also fed to a pair of dividers (hw_divide.v) which
+// publish the frequency in Hz and the duty cycle as a Q16 fraction, so the
+// Microblaze gets a finished reading without doing any division itself.
+//
+// When 'recip_en' is set the module also runs as a reciprocal frequency
+// counter: it counts whole input periods and the clocks they took, closing
+// the gate on the first rising edge after 'gate_time' clocks have elapsed.
+// The next gate opens on that same edge, so no time is lost between gates.
+// Frequency = CLK_FREQUENCY_HZ * recip_periods / recip_clocks, and the
+// resolution improves with the gate time instead of being limited to one
+// clock out of a single period.
+//
+// The running count of the interval in progress is exposed on 'live_count',
+// together with 'meas_age' (clocks since the last snapshot was latched). Once
+// 'meas_age' exceeds 'snap_period' the snapshot is 'stale': the period in
+// progress is already longer than the last one, so the input frequency has
+// dropped by at least that much.
+//
+// The input passes through a deglitch filter before the edge detector. With
+// 'deglitch_width' = 0 the filter is bypassed. Otherwise it either requires a
+// new level to be held for 'deglitch_width' consecutive clocks (minimum pulse
+// width), or follows the majority of the last 'deglitch_width' samples (up to
+// 32) when 'deglitch_majority' is set. Both edges are delayed equally, so the
+// measured intervals are unaffected. Every pulse the filter removes is counted
+// in 'glitch_count', and every period that contained one in 'glitch_periods'.
+//
+// Every complete period is also fed to a statistics block (hwdet_stats.v) which
+// publishes the minimum, maximum, sum and sum of squares of the periods over a
+// window of 'stats_window' periods, so software can compute the mean and the
+// variance from one readout per window.
+//
+// 'timestamp' is a free-running cycle counter shared by all channels. It is
+// captured on every falling edge and, together with the last falling edge, on
+// the rising edge that latches a snapshot, so each snapshot also carries the
+// absolute time of both of its edges. The deglitch filter and the input
+// synchronizer delay the captured edges by a fixed number of clocks.
+//
+// The interval counter advances once every 2^'range' clocks (the prescaler).
+// With 'auto_range' clear, 'range' follows 'manual_range'. With 'auto_range' set
+// the module picks the range itself: it moves up one step when an interval
+// reaches 2^30 counts and down one step when a whole period is shorter than
+// 2^28 counts, so the counter never wraps between 0.02Hz and the top of the
+// TSL235R's range. The range only changes on a rising edge, so every snapshot
+// is counted in one range, which is latched with it in 'snap_range'. The
+// counter saturates instead of wrapping; 'snap_sat' marks a snapshot that
+// saturated, so it is not a valid reading. Timestamps, 'meas_age', the deglitch
+// filter and the reciprocal counter are always in clock cycles. The snapshot and
+// the FIFO values are in prescaled counts. The period filter and statistics (and
+// the histogram in hwdet_channel.v) take 'snap_clocks', the snapshot period with
+// the prescaler undone, so a window never mixes periods counted in two ranges.
+//
+// Every complete period is also passed through a median and moving-average
+// filter (hwdet_filter.v), selected by 'filt_median' and 'filt_avg_log2'. The
+// filtered period is published on 'filt_period' and converted to Hz by a third
+// divider, so software can read a smoothed frequency directly. The raw counts,
+// the snapshot and the unfiltered frequency are not affected by the filter.
+//
 ////////////////////////////////////////////////////////////////////////////////////////////////
 
 module hw_detect #(
@@ -33,15 +96,226 @@ module hw_detect #(
 	input 			 		reset,			// active-high reset signal from Nexys4
 	input 					pwm,			// PWM signal from AXI Timer in EMBSYS
 
+	input		[15:0]		deglitch_width,	// deglitch filter width in clock cycles (0 = bypass)
+	input 					deglitch_majority,	// 1 = majority vote, 0 = minimum pulse width
+	input 					clr_glitch,		// clear both glitch counters
+
+	input		[31:0]		stats_window,	// periods per statistics window (0 = only on stats_latch)
+	input 					stats_latch,	// publish & clear the statistics now
+
+	input		[63:0]		timestamp,		// free-running cycle counter
+
+	input 					auto_range,		// 1 = choose the prescaler range automatically
+	input		[3:0]		manual_range,	// prescaler range when auto_range = 0 (count every 2^n clocks)
+
+	input		[1:0]		filt_median,	// 0 = off, 1 = median of 3, 2 = median of 5
+	input		[2:0]		filt_avg_log2,	// moving average of 2^filt_avg_log2 periods (0 = off)
+
+	input 					recip_en,		// enable the reciprocal (multi-period) counter
+	input		[31:0]		gate_time,		// minimum gate length in clock cycles
+
 	output reg	[31:0]		high_count,		// how long PWM was 'high' --> GPIO input on Microblaze
-	output reg	[31:0]		low_count);		// how long PWM was 'low' --> GPIO input on Microblaze
+	output reg	[31:0]		low_count,		// how long PWM was 'low' --> GPIO input on Microblaze
+
+	output reg	[31:0]		snap_high,		// 'high' interval of the last complete period
+	output reg	[31:0]		snap_low,		// 'low' interval of the last complete period
+	output reg	[31:0]		snap_period,	// length of the last complete period (high + low + 2)
+	output reg	[31:0]		snap_seq,		// increments once per complete period
+	output reg				snap_valid,		// one-cycle pulse when a new snapshot is latched
+	output reg	[63:0]		snap_rise_ts,	// 'timestamp' at the rising edge that ended the period
+	output reg	[63:0]		snap_fall_ts,	// 'timestamp' at the falling edge inside the period
+	output reg	[3:0]		snap_range,		// prescaler range the snapshot was counted in
+	output		[31:0]		snap_clocks,	// snap_period in clock cycles (saturates at 2^32 - 1)
+	output reg				snap_sat,		// the snapshot's counter saturated (reading not valid)
+	output reg	[3:0]		range,			// prescaler range of the period in progress
+
+	output reg	[31:0]		freq_hz,		// CLK_FREQUENCY_HZ / snap_period
+	output reg	[31:0]		duty_q16,		// ((snap_high + 1) << 16) / snap_period --> 0x10000 = 100%
+	output reg				calc_valid,		// one-cycle pulse when freq_hz & duty_q16 are updated
+
+	output		[31:0]		filt_period,	// filtered period in clock cycles
+	output reg	[31:0]		filt_freq_hz,	// CLK_FREQUENCY_HZ / filt_period
+	output reg				filt_valid,		// one-cycle pulse when filt_freq_hz is updated
+
+	output reg	[31:0]		recip_periods,	// whole input periods in the last gate
+	output reg	[31:0]		recip_clocks,	// clock cycles taken by those periods
+	output reg				recip_valid,	// one-cycle pulse when a gate closes
+
+	output		[31:0]		live_count,		// running count of the interval in progress
+	output 					live_level,		// level of the interval in progress (1 = high)
+	output reg	[31:0]		meas_age,		// clock cycles since the last snapshot (saturates)
+	output 					stale,			// interval in progress has outlasted snap_period
+
+	output reg	[31:0]		glitch_count,	// pulses removed by the deglitch filter
+	output reg	[31:0]		glitch_periods,	// complete periods that contained a removed pulse
+
+	output		[31:0]		stats_count,	// periods in the last statistics window
+	output		[31:0]		stats_min,		// shortest period in the window
+	output		[31:0]		stats_max,		// longest period in the window
+	output		[63:0]		stats_sum,		// sum of the periods in the window
+	output		[63:0]		stats_sumsq,	// sum of the squared periods in the window
+	output		[31:0]		stats_seq,		// increments once per window
+	output 					stats_valid,	// one-cycle pulse when a window is published
+
+	output reg	[31:0]		edge_count);	// free-running count of rising edges
 
 	/******************************************************************/
 	/* Local parameters and values		                  	  		  */
 	/******************************************************************/
 
+	reg 					pwm_clean;		// PWM after the deglitch filter
+	reg 					filt_next;		// next state of the deglitch filter
+	reg			[15:0]		hold_count;		// clocks the input has differed from the filter output
+	reg			[31:0]		history;		// last 32 input samples, newest in bit 0
+	reg			[5:0]		maj_width;		// majority vote window (deglitch_width, at most 32)
+	reg			[5:0]		maj_ones;		// samples in the window that are 'high'
+	reg 					excursion;		// input differed from the filter output last clock
+	wire					glitch;			// input returned before the filter followed it
+	reg 					glitch_in_period;	// a pulse was removed during the current period
+	integer 				i;
+
 	reg			[31:0]		count;			// 32-bit counter used for high/low count intervals
 	reg 					prev_pwm; 		// previous state of PWM; used to detect transitions
+	reg 					have_high;		// set once a full 'high' interval has been stored
+
+	reg			[14:0]		presc;			// clocks since the last prescaled count
+	wire		[14:0]		presc_mask;		// 2^range - 1
+	wire					tick;			// interval counter advances this clock
+	wire					count_max;		// interval counter is saturated
+	reg 					sat_in_period;	// the counter saturated during the current period
+	wire		[32:0]		range_period;	// high + low of the period ending now (prescaled)
+	wire		[47:0]		period_clocks;	// snap_period in clock cycles
+
+	reg 					calc_pending;	// a snapshot arrived while the dividers were busy
+	wire					calc_start;		// start both dividers on the latest snapshot
+
+	wire		[31:0]		freq_quot;		// result from the frequency divider
+	wire					freq_busy;		// frequency divider in progress
+	wire					freq_done;		// frequency divider finished (unused; duty finishes last)
+	wire		[47:0]		duty_quot;		// result from the duty cycle divider
+	wire					duty_busy;		// duty cycle divider in progress
+	wire					duty_done;		// duty cycle divider finished
+
+	wire					filt_done;		// filter published a new period
+	reg 					filt_pending;	// a filtered period arrived while its divider was busy
+	wire					filt_start;		// start the filtered frequency divider
+	wire		[31:0]		filt_quot;		// result from the filtered frequency divider
+	wire					filt_busy;		// filtered frequency divider in progress
+	wire					filt_div_done;	// filtered frequency divider finished
+
+	wire					rise;			// low-to-high transition on the input
+	wire					fall;			// high-to-low transition on the input
+	reg			[63:0]		fall_ts;		// 'timestamp' at the last falling edge
+	reg 					recip_running;	// a gate is open
+	reg			[31:0]		recip_count;	// whole periods since the gate opened
+	reg			[31:0]		recip_elapsed;	// clock cycles since the gate opened
+
+	assign glitch = excursion && (pwm == pwm_clean) && (filt_next == pwm_clean);
+
+	assign rise = (pwm_clean == 1'b1) && (prev_pwm == 1'b0);
+	assign fall = (pwm_clean == 1'b0) && (prev_pwm == 1'b1);
+
+	assign presc_mask = ~(15'h7FFF << range);
+	assign tick = ((presc & presc_mask) == presc_mask);
+	assign count_max = (count == 32'hFFFFFFFF);
+	assign range_period = high_count + count;
+	assign period_clocks = {16'b0, snap_period} << snap_range;
+	assign snap_clocks = (period_clocks[47:32] != 16'b0) ? 32'hFFFFFFFF : period_clocks[31:0];
+
+	assign live_count = count;
+	assign live_level = prev_pwm;
+	assign stale = ({16'b0, meas_age} > period_clocks);
+
+	/******************************************************************/
+	/* Deglitch filter								                  */
+	/******************************************************************/
+
+	always@(*) begin
+
+		maj_width = (deglitch_width > 16'd32) ? 6'd32 : deglitch_width[5:0];
+		maj_ones = 6'd0;
+
+		for (i = 0; i < 32; i = i + 1) begin
+			if (i < maj_width) begin
+				maj_ones = maj_ones + history[i];
+			end
+		end
+
+		if (deglitch_width == 16'd0) begin
+			filt_next = pwm;									// bypass
+		end
+
+		else if (deglitch_majority) begin
+			filt_next = ({maj_ones, 1'b0} > {1'b0, maj_width});	// more than half of the window is 'high'
+		end
+
+		else if ((pwm != pwm_clean) && ((hold_count + 1'b1) >= deglitch_width)) begin
+			filt_next = pwm;									// new level was held long enough
+		end
+
+		else begin
+			filt_next = pwm_clean;
+		end
+
+	end
+
+	always@(posedge clock) begin
+
+		if (reset) begin
+
+			pwm_clean <= 1'b0;
+			hold_count <= 16'b0;
+			history <= 32'b0;
+			excursion <= 1'b0;
+			glitch_in_period <= 1'b0;
+			glitch_count <= 32'b0;
+			glitch_periods <= 32'b0;
+
+		end
+
+		else begin
+
+			pwm_clean <= filt_next;
+			history <= {history[30:0], pwm};
+
+			if ((pwm == pwm_clean) || (filt_next != pwm_clean)) begin
+				hold_count <= 16'b0;
+			end
+
+			else begin
+				hold_count <= hold_count + 1'b1;
+			end
+
+			excursion <= (pwm != pwm_clean) && (filt_next == pwm_clean);
+
+			if (clr_glitch) begin
+				glitch_count <= 32'b0;
+				glitch_periods <= 32'b0;
+			end
+
+			else begin
+
+				if (glitch) begin
+					glitch_count <= glitch_count + 1'b1;
+				end
+
+				if (snap_valid && glitch_in_period) begin
+					glitch_periods <= glitch_periods + 1'b1;
+				end
+
+			end
+
+			if (glitch) begin
+				glitch_in_period <= 1'b1;
+			end
+
+			else if (snap_valid) begin
+				glitch_in_period <= 1'b0;
+			end
+
+		end
+
+	end
 
 	/******************************************************************/
 	/* Obtain the counts for high & low intervals	                  */
@@ -55,37 +329,383 @@ module hw_detect #(
 			high_count <= 32'b0;			// clear the 'high' register
 			low_count <= 32'b0;				// clear the 'low' register
 			prev_pwm <= 1'b0;				// clear the previous state
+			have_high <= 1'b0;				// no complete 'high' interval yet
+
+			snap_high <= 32'b0;				// clear the snapshot registers
+			snap_low <= 32'b0;
+			snap_period <= 32'b0;
+			snap_seq <= 32'b0;
+			snap_valid <= 1'b0;
 
 		end
 
-		else if (pwm == 1'b1) begin 		// check if PWM is currently high
+		else if (pwm_clean == 1'b1) begin 	// check if PWM is currently high
+
+			snap_valid <= 1'b0;				// snapshot strobe is only one cycle wide
 
-			if (prev_pwm != pwm) begin 		// if so, check whether there was a low-to-high transition
+			if (prev_pwm != pwm_clean) begin 		// if so, check whether there was a low-to-high transition
 				count <= 32'b0; 			// clear the counter
 				low_count <= count;			// store the 'low' count
 				prev_pwm <= 1'b1;			// update the previous state to 'high'
+
+				if (have_high) begin		// a full period just finished --> latch the snapshot
+					snap_high <= high_count;
+					snap_low <= count;
+					snap_period <= high_count + count + 32'd2;
+					snap_seq <= snap_seq + 1'b1;
+					snap_valid <= 1'b1;
+				end
 			end
 
-			else begin
-				count <= count + 1'b1;		// otherwise, just increment count		
+			else if (tick && !count_max) begin
+				count <= count + 1'b1;		// otherwise, just increment count (saturates)
 			end
 
 		end
 
-		else if (pwm == 1'b0) begin 		// check if PWM is currently low
+		else if (pwm_clean == 1'b0) begin 	// check if PWM is currently low
 
-			if (prev_pwm != pwm) begin 		// if so, check whether there was a high-to-low transition
+			snap_valid <= 1'b0;				// snapshot strobe is only one cycle wide
+
+			if (prev_pwm != pwm_clean) begin 		// if so, check whether there was a high-to-low transition
 				count <= 32'b0; 			// clear the counter
 				high_count <= count; 		// store the 'high' count
-				prev_pwm <= pwm; 			// update the previous state to 'low'
+				prev_pwm <= pwm_clean; 		// update the previous state to 'low'
+				have_high <= 1'b1;			// the next low-to-high transition completes a period
 			end
 
-			else begin
-				count <= count + 1'b1; 		// otherwise, just increment count
+			else if (tick && !count_max) begin
+				count <= count + 1'b1; 		// otherwise, just increment count (saturates)
 			end
 		
 		end
 		
 	end
 
+	/******************************************************************/
+	/* Prescaler & automatic range selection		                  */
+	/******************************************************************/
+
+	// the prescaler restarts on every edge so that each interval starts with a
+	// whole count; the range changes on the rising edge that ends a period
+
+	always@(posedge clock) begin
+
+		if (reset) begin
+			presc <= 15'b0;
+			range <= 4'b0;
+			snap_range <= 4'b0;
+			snap_sat <= 1'b0;
+			sat_in_period <= 1'b0;
+		end
+
+		else begin
+
+			if (rise || fall) begin
+				presc <= 15'b0;
+			end
+
+			else begin
+				presc <= presc + 1'b1;
+			end
+
+			if (rise) begin
+
+				if (have_high) begin				// same condition as the snapshot latch
+					snap_range <= range;
+					snap_sat <= sat_in_period || count_max;
+				end
+
+				sat_in_period <= 1'b0;
+
+				if (!auto_range) begin
+					range <= manual_range;
+				end
+
+				else if ((sat_in_period || count_max || high_count[31:30] != 2'b0 || count[31:30] != 2'b0)
+						 && (range != 4'hF)) begin
+					range <= range + 1'b1;			// an interval got close to saturating --> count slower
+				end
+
+				else if ((range_period < 33'h10000000) && (range != 4'h0)) begin
+					range <= range - 1'b1;			// period fits in 2^28 counts --> count faster
+				end
+
+			end
+
+			else if (tick && count_max) begin
+				sat_in_period <= 1'b1;
+			end
+
+		end
+
+	end
+
+	/******************************************************************/
+	/* Reciprocal (multi-period) frequency counter	                  */
+	/******************************************************************/
+
+	always@(posedge clock) begin
+
+		if (reset || !recip_en) begin 		// counter is idle while the mode is off
+
+			recip_running <= 1'b0;
+			recip_count <= 32'b0;
+			recip_elapsed <= 32'b0;
+			recip_valid <= 1'b0;
+
+			if (reset) begin
+				recip_periods <= 32'b0;
+				recip_clocks <= 32'b0;
+			end
+
+		end
+
+		else begin
+
+			recip_valid <= 1'b0;
+
+			if (rise && recip_running && (recip_elapsed >= gate_time)) begin
+				recip_periods <= recip_count + 1'b1;	// gate time is up --> close the gate on this edge
+				recip_clocks <= recip_elapsed;
+				recip_valid <= 1'b1;
+				recip_count <= 32'b0;					// ...and open the next one on the same edge
+				recip_elapsed <= 32'd1;
+			end
+
+			else if (rise && !recip_running) begin
+				recip_running <= 1'b1;					// first edge opens the first gate
+				recip_count <= 32'b0;
+				recip_elapsed <= 32'd1;
+			end
+
+			else if (recip_running) begin
+				recip_elapsed <= recip_elapsed + 1'b1;
+
+				if (rise) begin
+					recip_count <= recip_count + 1'b1;	// another whole period inside the gate
+				end
+			end
+
+		end
+
+	end
+
+	/******************************************************************/
+	/* Rising edge counter 							                  */
+	/******************************************************************/
+
+	always@(posedge clock) begin
+
+		if (reset) begin
+			edge_count <= 32'b0;
+		end
+
+		else if (rise) begin
+			edge_count <= edge_count + 1'b1;		// wraps around; software uses differences
+		end
+
+	end
+
+	/******************************************************************/
+	/* Edge timestamps 								                  */
+	/******************************************************************/
+
+	// same condition as the snapshot latch above, so the timestamps change
+	// in the same clock as the rest of the snapshot
+
+	always@(posedge clock) begin
+
+		if (reset) begin
+			fall_ts <= 64'b0;
+			snap_rise_ts <= 64'b0;
+			snap_fall_ts <= 64'b0;
+		end
+
+		else begin
+
+			if (fall) begin
+				fall_ts <= timestamp;
+			end
+
+			if (rise && have_high) begin
+				snap_rise_ts <= timestamp;
+				snap_fall_ts <= fall_ts;
+			end
+
+		end
+
+	end
+
+	/******************************************************************/
+	/* Measurement age 								                  */
+	/******************************************************************/
+
+	always@(posedge clock) begin
+
+		if (reset) begin
+			meas_age <= 32'b0;
+		end
+
+		else if (snap_valid) begin
+			meas_age <= 32'd1;						// snapshot was latched on the previous clock
+		end
+
+		else if (meas_age != 32'hFFFFFFFF) begin
+			meas_age <= meas_age + 1'b1;			// saturate instead of wrapping around
+		end
+
+	end
+
+	/******************************************************************/
+	/* Frequency & duty cycle arithmetic unit		                  */
+	/******************************************************************/
+
+	// both dividers start together on the latest snapshot; the 48-bit duty
+	// divider takes longer, so both results are published when it finishes.
+	// if new snapshots arrive while busy, only the most recent one is used
+
+	assign calc_start = (snap_valid || calc_pending) && !freq_busy && !duty_busy;
+
+	always@(posedge clock) begin
+
+		if (reset) begin
+			calc_pending <= 1'b0;
+			freq_hz <= 32'b0;
+			duty_q16 <= 32'b0;
+			calc_valid <= 1'b0;
+		end
+
+		else begin
+
+			if (calc_start) begin
+				calc_pending <= 1'b0;				// dividers captured the latest snapshot
+			end
+
+			else if (snap_valid) begin
+				calc_pending <= 1'b1;				// remember to restart once they are idle
+			end
+
+			calc_valid <= duty_done;
+
+			if (duty_done) begin
+				freq_hz <= freq_quot;				// publish both results in the same cycle
+				duty_q16 <= duty_quot[31:0];
+			end
+
+		end
+
+	end
+
+	hw_divide #(
+		.DIVIDEND_WIDTH		(32),
+		.DIVISOR_WIDTH		(48))
+
+	FREQ_DIV (
+		.clock				(clock),				// I [ 0 ] 100MHz system clock
+		.reset				(reset),				// I [ 0 ] active-high reset
+		.start				(calc_start),			// I [ 0 ] begin a new division
+		.dividend			(CLK_FREQUENCY_HZ),		// I [31:0] clock ticks per second
+		.divisor			(period_clocks),		// I [47:0] clock ticks per period (prescaler undone)
+		.quotient			(freq_quot),			// O [31:0] frequency in Hz
+		.busy				(freq_busy),			// O [ 0 ] division in progress
+		.done				(freq_done));			// O [ 0 ] result updated
+
+	hw_divide #(
+		.DIVIDEND_WIDTH		(48),
+		.DIVISOR_WIDTH		(32))
+
+	DUTY_DIV (
+		.clock				(clock),				// I [ 0 ] 100MHz system clock
+		.reset				(reset),				// I [ 0 ] active-high reset
+		.start				(calc_start),			// I [ 0 ] begin a new division
+		.dividend			({snap_high + 32'd1, 16'b0}),	// I [47:0] 'high' ticks in Q16
+		.divisor			(snap_period),			// I [31:0] clock ticks per period
+		.quotient			(duty_quot),			// O [47:0] duty cycle in Q16
+		.busy				(duty_busy),			// O [ 0 ] division in progress
+		.done				(duty_done));			// O [ 0 ] result updated
+
+	/******************************************************************/
+	/* Median & moving-average filter				                  */
+	/******************************************************************/
+
+	// the filter never outputs 0 for a non-zero input, and snap_clocks is at
+	// least 2, so the divider below is never started with a zero divisor
+
+	assign filt_start = (filt_done || filt_pending) && !filt_busy;
+
+	always@(posedge clock) begin
+
+		if (reset) begin
+			filt_pending <= 1'b0;
+			filt_freq_hz <= 32'b0;
+			filt_valid <= 1'b0;
+		end
+
+		else begin
+
+			if (filt_start) begin
+				filt_pending <= 1'b0;				// divider captured the latest filtered period
+			end
+
+			else if (filt_done) begin
+				filt_pending <= 1'b1;				// remember to restart once it is idle
+			end
+
+			filt_valid <= filt_div_done;
+
+			if (filt_div_done) begin
+				filt_freq_hz <= filt_quot;
+			end
+
+		end
+
+	end
+
+	hwdet_filter #(
+		.AVG_LOG2_MAX		(4))
+
+	FILTER (
+		.clock				(clock),				// I [ 0 ] 100MHz system clock
+		.reset				(reset),				// I [ 0 ] active-high reset
+		.sample_valid		(snap_valid),			// I [ 0 ] a new period was latched
+		.sample				(snap_clocks),			// I [31:0] clock ticks per period (prescaler undone)
+		.median_sel			(filt_median),			// I [1:0] median window
+		.avg_log2			(filt_avg_log2),		// I [2:0] moving average window
+		.filt_sample		(filt_period),			// O [31:0] filtered period
+		.filt_valid			(filt_done));			// O [ 0 ] filtered period updated
+
+	hw_divide #(
+		.DIVIDEND_WIDTH		(32),
+		.DIVISOR_WIDTH		(32))
+
+	FILT_DIV (
+		.clock				(clock),				// I [ 0 ] 100MHz system clock
+		.reset				(reset),				// I [ 0 ] active-high reset
+		.start				(filt_start),			// I [ 0 ] begin a new division
+		.dividend			(CLK_FREQUENCY_HZ),		// I [31:0] clock ticks per second
+		.divisor			(filt_period),			// I [31:0] filtered clock ticks per period
+		.quotient			(filt_quot),			// O [31:0] filtered frequency in Hz
+		.busy				(filt_busy),			// O [ 0 ] division in progress
+		.done				(filt_div_done));		// O [ 0 ] result updated
+
+	/******************************************************************/
+	/* Windowed period statistics					                  */
+	/******************************************************************/
+
+	hwdet_stats STATS (
+		.clock				(clock),				// I [ 0 ] 100MHz system clock
+		.reset				(reset),				// I [ 0 ] active-high reset
+		.sample_valid		(snap_valid),			// I [ 0 ] a new period was latched
+		.sample				(snap_clocks),			// I [31:0] clock ticks per period (prescaler undone)
+		.window				(stats_window),			// I [31:0] periods per window
+		.latch				(stats_latch),			// I [ 0 ] publish & clear now
+		.count				(stats_count),			// O [31:0] periods in the window
+		.min				(stats_min),			// O [31:0] shortest period
+		.max				(stats_max),			// O [31:0] longest period
+		.sum				(stats_sum),			// O [63:0] sum of the periods
+		.sumsq				(stats_sumsq),			// O [63:0] sum of the squared periods
+		.seq				(stats_seq),			// O [31:0] window sequence number
+		.done				(stats_valid));			// O [ 0 ] window published
+
 endmodule
\ No newline at end of file
@@ -0,0 +1,117 @@
+// hw_divide.v --> multi-cycle unsigned integer divider
+//
+//
+// Author:	Rehan Iqbal
+// Organization: Portland State University
+//
+// Description:
+//
+// This hardware module divides an unsigned dividend by an unsigned divisor
+// using a radix-2 restoring algorithm. One quotient bit is produced per clock,
+// so a result is available DIVIDEND_WIDTH clocks after 'start' is asserted.
+//
+// The operands are captured when 'start' is asserted while the divider is idle.
+// 'done' is a single-cycle pulse that marks a new value on 'quotient', which is
+// held until the next division completes. The result of a division by zero is
+// not meaningful, so callers should not start one.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+module hw_divide #(
+
+	/******************************************************************/
+	/* Parameter declarations						                  */
+	/******************************************************************/
+
+	parameter integer	DIVIDEND_WIDTH = 32,		// width of the dividend and quotient
+	parameter integer	DIVISOR_WIDTH = 32)			// width of the divisor and remainder
+
+	/******************************************************************/
+	/* Port declarations							                  */
+	/******************************************************************/
+
+	(
+	input 									clock,		// 100MHz system clock
+	input 									reset,		// active-high synchronous reset
+	input 									start,		// begin a new division (ignored while busy)
+
+	input		[DIVIDEND_WIDTH-1:0]		dividend,	// numerator
+	input		[DIVISOR_WIDTH-1:0]			divisor,	// denominator
+
+	output reg	[DIVIDEND_WIDTH-1:0]		quotient,	// result of the last completed division
+	output reg 								busy,		// division in progress
+	output reg 								done);		// one-cycle pulse when 'quotient' is updated
+
+	/******************************************************************/
+	/* Local parameters and values		                  	  		  */
+	/******************************************************************/
+
+	reg			[DIVIDEND_WIDTH-1:0]		quot;		// dividend shifts out, quotient shifts in
+	reg			[DIVISOR_WIDTH-1:0]			rem;		// partial remainder
+	reg			[DIVISOR_WIDTH-1:0]			den;		// captured divisor
+	reg			[7:0]						bits_left;	// quotient bits still to be produced
+
+	wire		[DIVISOR_WIDTH:0]			shifted;	// partial remainder with next dividend bit
+	wire		[DIVISOR_WIDTH:0]			trial;		// partial remainder minus the divisor
+
+	assign shifted = {rem, quot[DIVIDEND_WIDTH-1]};
+	assign trial = shifted - {1'b0, den};
+
+	/******************************************************************/
+	/* Shift / subtract state machine				                  */
+	/******************************************************************/
+
+	always@(posedge clock) begin
+
+		if (reset) begin
+
+			quot <= {DIVIDEND_WIDTH{1'b0}};
+			rem <= {DIVISOR_WIDTH{1'b0}};
+			den <= {DIVISOR_WIDTH{1'b0}};
+			bits_left <= 8'd0;
+			quotient <= {DIVIDEND_WIDTH{1'b0}};
+			busy <= 1'b0;
+			done <= 1'b0;
+
+		end
+
+		else if (!busy) begin 				// idle --> wait for a new division
+
+			done <= 1'b0;
+
+			if (start) begin
+				quot <= dividend;			// capture the operands
+				den <= divisor;
+				rem <= {DIVISOR_WIDTH{1'b0}};
+				bits_left <= DIVIDEND_WIDTH;
+				busy <= 1'b1;
+			end
+
+		end
+
+		else begin 							// produce one quotient bit per clock
+
+			if (trial[DIVISOR_WIDTH] == 1'b0) begin		// shifted >= divisor --> subtract
+				rem <= trial[DIVISOR_WIDTH-1:0];
+				quot <= {quot[DIVIDEND_WIDTH-2:0], 1'b1};
+			end
+
+			else begin
+				rem <= shifted[DIVISOR_WIDTH-1:0];
+				quot <= {quot[DIVIDEND_WIDTH-2:0], 1'b0};
+			end
+
+			bits_left <= bits_left - 1'b1;
+
+			if (bits_left == 8'd1) begin	// last bit --> publish the result
+				quotient <= (trial[DIVISOR_WIDTH] == 1'b0) ? {quot[DIVIDEND_WIDTH-2:0], 1'b1}
+														   : {quot[DIVIDEND_WIDTH-2:0], 1'b0};
+				busy <= 1'b0;
+				done <= 1'b1;
+			end
+
+		end
+
+	end
+
+endmodule
@@ -0,0 +1,186 @@
+// hwdet_bus_cdc.v --> register bus crossing from the AXI clock to the measurement clock
+//
+//
+// Author:	Rehan Iqbal
+// Organization: Portland State University
+//
+// Description:
+//
+// This hardware module carries the register strobes of HWDET_v1_0_S00_AXI.v into
+// the measurement clock domain, and the read data back, when the measurement
+// logic runs on a clock of its own (USE_MEAS_CLK = 1).
+//
+// One access (a write, a read, or one of each) is in flight at a time. The
+// address, data and strobes are held in registers on the AXI side, and only a
+// toggle crosses each way through a two-flop synchronizer. The receiving side
+// sees the toggle at least two of its clocks after the held values last changed,
+// so they are stable when they are used. 'busy' is high from the accepted access
+// until its read data is back, and the AXI interface must not start another
+// access while it is set.
+//
+// The measurement side issues the strobes for exactly one of its clocks and
+// captures 'm_rd_data' in that same clock, just like the registers see them
+// when everything runs on the AXI clock. A round trip takes about three clocks
+// of each domain.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+module hwdet_bus_cdc #(
+
+	/******************************************************************/
+	/* Parameter declarations						                  */
+	/******************************************************************/
+
+	parameter integer	ADDR_WIDTH = 12)			// width of the register byte address
+
+	/******************************************************************/
+	/* Port declarations							                  */
+	/******************************************************************/
+
+	(
+	input 								s_clock,		// AXI clock
+	input 								s_reset,		// active-high synchronous reset (AXI clock)
+
+	input 								s_wr_en,		// register write strobe
+	input		[ADDR_WIDTH-1:0]		s_wr_addr,		// register being written
+	input		[31:0]					s_wr_data,		// write data
+	input		[3:0]					s_wr_strb,		// byte enables for 's_wr_data'
+	input 								s_rd_en,		// register read strobe
+	input		[ADDR_WIDTH-1:0]		s_rd_addr,		// register being read
+	output reg	[31:0]					s_rd_data,		// read data of the last access
+	output reg 							s_rd_done,		// one-cycle pulse when 's_rd_data' is valid
+	output 								busy,			// an access is in flight
+
+	input 								m_clock,		// measurement clock
+	input 								m_reset,		// active-high synchronous reset (measurement clock)
+
+	output 								m_wr_en,		// register write strobe
+	output		[ADDR_WIDTH-1:0]		m_wr_addr,		// register being written
+	output		[31:0]					m_wr_data,		// write data
+	output		[3:0]					m_wr_strb,		// byte enables for 'm_wr_data'
+	output 								m_rd_en,		// register read strobe
+	output		[ADDR_WIDTH-1:0]		m_rd_addr,		// register being read
+	input		[31:0]					m_rd_data);		// contents of register 'm_rd_addr'
+
+	/******************************************************************/
+	/* Local parameters and values		                  	  		  */
+	/******************************************************************/
+
+	reg 								hold_wr;		// access held for the measurement side
+	reg			[ADDR_WIDTH-1:0]		hold_wr_addr;
+	reg			[31:0]					hold_wr_data;
+	reg			[3:0]					hold_wr_strb;
+	reg 								hold_rd;
+	reg			[ADDR_WIDTH-1:0]		hold_rd_addr;
+
+	reg 								req;			// toggles once per access (AXI clock)
+	reg 								pending;		// access not yet acknowledged
+	(* ASYNC_REG = "TRUE" *)
+	reg			[1:0]					ack_sync;		// 'ack' in the AXI clock
+	reg 								ack_seen;
+
+	(* ASYNC_REG = "TRUE" *)
+	reg			[1:0]					req_sync;		// 'req' in the measurement clock
+	reg 								req_seen;
+	reg 								ack;			// follows 'req' once the access is done
+	reg			[31:0]					rd_hold;		// read data captured in the measurement clock
+
+	wire								m_strobe;		// new access arrived (measurement clock)
+	wire								s_ack;			// access acknowledged (AXI clock)
+
+	assign busy = pending;
+
+	assign m_strobe = (req_sync[1] != req_seen);
+	assign s_ack = (ack_sync[1] != ack_seen);
+
+	assign m_wr_en = m_strobe && hold_wr;
+	assign m_wr_addr = hold_wr_addr;
+	assign m_wr_data = hold_wr_data;
+	assign m_wr_strb = hold_wr_strb;
+	assign m_rd_en = m_strobe && hold_rd;
+	assign m_rd_addr = hold_rd_addr;
+
+	/******************************************************************/
+	/* AXI clock side								                  */
+	/******************************************************************/
+
+	always@(posedge s_clock) begin
+
+		if (s_reset) begin
+
+			hold_wr <= 1'b0;
+			hold_wr_addr <= {ADDR_WIDTH{1'b0}};
+			hold_wr_data <= 32'b0;
+			hold_wr_strb <= 4'b0;
+			hold_rd <= 1'b0;
+			hold_rd_addr <= {ADDR_WIDTH{1'b0}};
+
+			req <= 1'b0;
+			pending <= 1'b0;
+			ack_sync <= 2'b0;
+			ack_seen <= 1'b0;
+			s_rd_data <= 32'b0;
+			s_rd_done <= 1'b0;
+
+		end
+
+		else begin
+
+			ack_sync <= {ack_sync[0], ack};
+			s_rd_done <= 1'b0;
+
+			if ((s_wr_en || s_rd_en) && !pending) begin		// hold the access & hand it over
+
+				hold_wr <= s_wr_en;
+				hold_wr_addr <= s_wr_addr;
+				hold_wr_data <= s_wr_data;
+				hold_wr_strb <= s_wr_strb;
+				hold_rd <= s_rd_en;
+				hold_rd_addr <= s_rd_addr;
+
+				req <= !req;
+				pending <= 1'b1;
+
+			end
+
+			else if (s_ack) begin							// measurement side is done
+
+				ack_seen <= ack_sync[1];
+				pending <= 1'b0;
+				s_rd_data <= rd_hold;
+				s_rd_done <= hold_rd;
+
+			end
+
+		end
+
+	end
+
+	/******************************************************************/
+	/* Measurement clock side						                  */
+	/******************************************************************/
+
+	always@(posedge m_clock) begin
+
+		if (m_reset) begin
+			req_sync <= 2'b0;
+			req_seen <= 1'b0;
+			ack <= 1'b0;
+			rd_hold <= 32'b0;
+		end
+
+		else begin
+
+			req_sync <= {req_sync[0], req};
+
+			if (m_strobe) begin
+				req_seen <= req_sync[1];
+				rd_hold <= m_rd_data;						// same clock as the read strobe
+				ack <= req_sync[1];
+			end
+
+		end
+
+	end
+
+endmodule
@@ -0,0 +1,920 @@
+// hwdet_channel.v --> one measurement channel of the HWDET peripheral
+//
+//
+// Author:	Rehan Iqbal
+// Organization: Portland State University
+//
+// Description:
+//
+// This hardware module holds everything that belongs to one PWM input: the
+// hw_detect.v instance, the sample FIFO, the histogram, the loopback generator,
+// the carrier-synchronous window counter (hwdet_sync.v), the interrupt logic
+// and the bank of 64 registers that controls them. HWDET_v1_0_S00_AXI.v
+// instantiates one of these per channel and routes each AXI register access
+// to the bank selected by the upper address bits.
+//
+// 'wr_en' and 'rd_en' are the AXI slave register write & read strobes for this
+// bank; 'rd_data' is combinational and is registered by the AXI interface.
+//
+// Registers in each bank are mapped as follows:
+//		slv_reg0		(high_count) how long PWM was high --> coming from hw_detect.v
+//		slv_reg1		(low_count) how long PWM was low --> coming from hw_detect.v
+//		slv_reg2		(snap_period) full length of the last complete period --> coming from hw_detect.v
+//						reading this register also freezes slv_reg3 - slv_reg5
+//		slv_reg3		(snap_high) 'high' interval of the period returned by the last slv_reg2 read
+//		slv_reg4		(snap_low) 'low' interval of the period returned by the last slv_reg2 read
+//		slv_reg5		(snap_seq) sequence number of the period returned by the last slv_reg2 read
+//		slv_reg6		*RESERVED* (read/write, used by the self-test)
+//		slv_reg7		*RESERVED* (read/write, used by the self-test)
+//		slv_reg8		(freq_hz) frequency of the last complete period in Hz --> coming from hw_detect.v
+//		slv_reg9		(duty_q16) duty cycle of the last complete period, Q16 --> coming from hw_detect.v
+//		slv_reg10		(fifo_high) 'high' interval of the oldest period in the sample FIFO
+//		slv_reg11		(fifo_low) 'low' interval of the oldest period; reading this register pops the FIFO
+//		slv_reg12		(fifo_status) [15:0] level, [16] empty, [17] full, [31] overflow (sticky)
+//		slv_reg13		(fifo_ctrl) [0] flush the FIFO, [1] clear the overflow flag (both write-only strobes)
+//						[31:16] FIFO threshold for the interrupt (read/write, 0 = disabled)
+//		slv_reg14		(irq_enable) interrupt enables (read/write), same bit layout as slv_reg15
+//		slv_reg15		(irq_status) write 1 to clear: [0] new period, [1] freq/duty ready,
+//						[2] FIFO level >= threshold, [3] period dropped by a full FIFO,
+//						[4] statistics window published, [5] carrier-synchronous window closed
+//		slv_reg16		(ctrl) control register (read/write): [0] enable the reciprocal counter,
+//						[1] loopback: measure the internal pulse generator instead of pwm_in,
+//						[3:2] period median filter (0 = off, 1 = 3 periods, 2 = 5 periods),
+//						[6:4] period moving average of 2^n periods (0 = off, at most 4),
+//						[7] automatic prescaler range, [11:8] prescaler range when [7] = 0
+//		slv_reg17		(gate_time) reciprocal counter gate time in clock cycles (read/write)
+//		slv_reg18		(recip_periods) whole periods in the last gate; reading this register
+//						also freezes slv_reg19
+//		slv_reg19		(recip_clocks) clock cycles taken by the periods returned by the last slv_reg18 read
+//		slv_reg20		(live_count) running count of the interval in progress (read-only)
+//		slv_reg21		(meas_age) clock cycles since the last complete period, saturating (read-only)
+//		slv_reg22		(live_status) [0] level of the interval in progress,
+//						[1] stale: meas_age > snap_period (read-only)
+//		slv_reg23		(deglitch) deglitch filter (read/write): [15:0] width in clock cycles
+//						(0 = bypass), [16] 1 = majority vote, 0 = minimum pulse width
+//		slv_reg24		(glitch_count) pulses removed by the deglitch filter (read-only);
+//						writing any value clears slv_reg24 and slv_reg25
+//		slv_reg25		(glitch_periods) complete periods that contained a removed pulse (read-only)
+//		slv_reg26		(sync_periods) [15:0] PWM carrier periods per synchronous window (read/write, 0 = off)
+//		slv_reg27		(sync_edges) rising edges of pwm_in in the last synchronous window; reading this
+//						register also freezes slv_reg28 - slv_reg30
+//		slv_reg28		(sync_clocks) length of that window in clock cycles
+//		slv_reg29		(sync_span) clock cycles from the first to the last rising edge in that window
+//		slv_reg30		(sync_seq) synchronous window sequence number
+//		slv_reg31		*RESERVED* (read as 0)
+//		slv_reg32		(stats_window) periods per statistics window (read/write, 0 = manual)
+//		slv_reg33		(stats_count) periods in the last window; reading this register also
+//						freezes slv_reg34 - slv_reg40, writing any value publishes & clears
+//						the window in progress
+//		slv_reg34		(stats_min) shortest period in the window
+//		slv_reg35		(stats_max) longest period in the window
+//		slv_reg36-37	(stats_sum) sum of the periods in the window [31:0], [63:32]
+//		slv_reg38-39	(stats_sumsq) sum of the squared periods in the window [31:0], [63:32]
+//		slv_reg40		(stats_seq) window sequence number
+//		slv_reg41		(hist_config) period histogram (read/write): [4:0] bin width = 2^n clock
+//						cycles, [8] enable counting
+//		slv_reg42		(hist_offset) lower edge of the first bin in clock cycles (read/write)
+//		slv_reg43		(hist_addr) bin to read through slv_reg44 (read/write)
+//		slv_reg44		(hist_data) count of bin hist_addr; reading this register also
+//						advances hist_addr to the next bin
+//		slv_reg45		(hist_status) [15:0] number of bins - 1, [31] clear in progress;
+//						writing [0] = 1 clears every bin
+//		slv_reg46		(edge_count) free-running count of rising edges (read-only)
+//		slv_reg47		(period_count) free-running count of complete periods (read-only)
+//		slv_reg48		(overrun_count) free-running count of snapshots that were replaced before
+//						slv_reg2, slv_reg8 or slv_reg9 was read (read-only)
+//		slv_reg49		(new_periods) complete periods since the last read of this register;
+//						reading this register also clears it
+//		slv_reg50		(patgen_high) pulse generator 'high' time in clock cycles (read/write)
+//		slv_reg51		(patgen_low) pulse generator 'low' time in clock cycles (read/write)
+//		slv_reg52		(info) [7:0] channel number of this bank, [15:8] number of channels (read-only)
+//		slv_reg53-54	(time) free-running 64-bit cycle counter [31:0], [63:32]; reading
+//						slv_reg53 also freezes slv_reg54
+//		slv_reg55-56	(rise_ts) cycle counter at the rising edge that ended the period
+//						returned by the last slv_reg2 read [31:0], [63:32]
+//		slv_reg57-58	(fall_ts) cycle counter at the falling edge inside that period [31:0], [63:32]
+//		slv_reg59		(filt_period) period after the median & moving-average filter (read-only)
+//		slv_reg60		(filt_freq_hz) frequency of the filtered period in Hz (read-only)
+//		slv_reg61		(range) [3:0] prescaler range of the period returned by the last slv_reg2
+//						read (counts are 2^n clocks), [4] that period saturated the counter,
+//						[11:8] prescaler range of the period in progress (read-only)
+//		slv_reg62		(clk_freq) frequency in Hz of the clock this channel counts in (read-only)
+//		slv_reg63		*RESERVED* (read as 0)
+//
+// The 'irq' output is active-high and stays asserted while (irq_status & irq_enable) != 0.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+module hwdet_channel #(
+
+	/******************************************************************/
+	/* Parameter declarations						                  */
+	/******************************************************************/
+
+	parameter integer	CLK_FREQUENCY_HZ = 100000000,	// frequency of 'clock', reported in slv_reg62
+	parameter integer	FIFO_ADDR_WIDTH = 10,		// sample FIFO holds 2^FIFO_ADDR_WIDTH periods
+	parameter integer	HIST_ADDR_WIDTH = 10,		// period histogram has 2^HIST_ADDR_WIDTH bins
+	parameter integer	CHANNEL = 0,				// channel number reported in slv_reg52
+	parameter integer	NUM_CHANNELS = 1)			// number of channels in the peripheral
+
+	/******************************************************************/
+	/* Port declarations							                  */
+	/******************************************************************/
+
+	(
+	input 								clock,			// measurement clock (100MHz system clock by default)
+	input 								reset,			// active-high synchronous reset
+	input 								pwm_in,			// PWM input signal for this channel
+	input 								pwm_trig,		// PWM carrier driving the LED (synchronous window trigger)
+	input		[63:0]					timestamp,		// free-running cycle counter (shared by all channels)
+
+	input 								wr_en,			// register write strobe for this bank
+	input		[5:0]					wr_addr,		// register being written
+	input		[31:0]					wr_data,		// write data
+	input		[3:0]					wr_strb,		// byte enables for 'wr_data'
+
+	input 								rd_en,			// register read strobe for this bank
+	input		[5:0]					rd_addr,		// register being read
+	output reg	[31:0]					rd_data,		// contents of register 'rd_addr'
+
+	output 								rec_valid,		// pulse when a complete period is latched
+	output		[63:0]					rec_ts,			// timestamp of the rising edge ending that period
+	output		[31:0]					rec_high,		// 'high' interval of that period
+	output		[31:0]					rec_low,		// 'low' interval of that period
+
+	output 								ctl_freq_valid,	// pulse when 'ctl_freq_hz' is updated
+	output		[31:0]					ctl_freq_hz,	// frequency of the last complete period in Hz
+	output 								ctl_filt_valid,	// pulse when 'ctl_filt_hz' is updated
+	output		[31:0]					ctl_filt_hz,	// frequency of the filtered period in Hz
+
+	output reg 							irq);			// level-sensitive interrupt request (active-high)
+
+	/******************************************************************/
+	/* Local parameters and values		                  	  		  */
+	/******************************************************************/
+
+	reg			[31:0]					slv_reg6;
+	reg			[31:0]					slv_reg7;
+	reg			[31:0]					slv_reg13;
+	reg			[31:0]					slv_reg14;
+	reg			[31:0]					slv_reg16;
+	reg			[31:0]					slv_reg17;
+	reg			[31:0]					slv_reg23;
+	reg			[31:0]					slv_reg26;
+	reg			[31:0]					slv_reg32;
+	reg			[31:0]					slv_reg41;
+	reg			[31:0]					slv_reg42;
+	reg			[31:0]					slv_reg50;
+	reg			[31:0]					slv_reg51;
+	integer								byte_index;
+
+	/******************************************************************/
+	/* Register writes								                  */
+	/******************************************************************/
+
+	always @( posedge clock )
+	begin
+	  if ( reset )
+	    begin
+	      slv_reg6 <= 0;
+	      slv_reg7 <= 0;
+	      slv_reg13 <= 0;
+	      slv_reg14 <= 0;
+	      slv_reg16 <= 0;
+	      slv_reg17 <= 0;
+	      slv_reg23 <= 0;
+	      slv_reg26 <= 0;
+	      slv_reg32 <= 0;
+	      slv_reg41 <= 0;
+	      slv_reg42 <= 0;
+	      slv_reg50 <= 0;
+	      slv_reg51 <= 0;
+	    end 
+	  else begin
+	    if (wr_en)
+	      begin
+	        case ( wr_addr )
+	          6'h06:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes 
+	                // Slave register 6
+	                slv_reg6[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end  
+	          6'h07:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes 
+	                // Slave register 7
+	                slv_reg7[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end  
+	          6'h0D:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes 
+	                // Slave register 13
+	                slv_reg13[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end  
+	          6'h0E:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes 
+	                // Slave register 14
+	                slv_reg14[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end  
+	          6'h10:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes 
+	                // Slave register 16
+	                slv_reg16[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end  
+	          6'h11:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes 
+	                // Slave register 17
+	                slv_reg17[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end  
+	          6'h17:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes 
+	                // Slave register 23
+	                slv_reg23[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end  
+	          6'h1A:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes 
+	                // Slave register 26
+	                slv_reg26[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end  
+	          6'h20:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes 
+	                // Slave register 32
+	                slv_reg32[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end  
+	          6'h29:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes 
+	                // Slave register 41
+	                slv_reg41[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end  
+	          6'h2A:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes 
+	                // Slave register 42
+	                slv_reg42[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end  
+	          6'h32:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes 
+	                // Slave register 50
+	                slv_reg50[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end  
+	          6'h33:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes 
+	                // Slave register 51
+	                slv_reg51[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end  
+	          default : begin
+	                      // all other slave registers are read-only; writes are ignored
+	                      slv_reg6 <= slv_reg6;
+	                      slv_reg7 <= slv_reg7;
+	                      slv_reg13 <= slv_reg13;
+	                      slv_reg14 <= slv_reg14;
+	                      slv_reg16 <= slv_reg16;
+	                      slv_reg17 <= slv_reg17;
+	                      slv_reg23 <= slv_reg23;
+	                      slv_reg26 <= slv_reg26;
+	                      slv_reg32 <= slv_reg32;
+	                      slv_reg41 <= slv_reg41;
+	                      slv_reg42 <= slv_reg42;
+	                      slv_reg50 <= slv_reg50;
+	                      slv_reg51 <= slv_reg51;
+	                    end
+	        endcase
+	      end
+	  end
+	end    
+
+	/******************************************************************/
+	/* Register reads								                  */
+	/******************************************************************/
+
+	always @(*)
+	begin
+	      // Address decoding for reading registers
+	      case ( rd_addr )
+	      
+	      // map the hw_detect.v outputs to slave registers 0 - 5
+	      // these should be read-only registers
+	      
+	        6'h00   : rd_data <= high_count;
+	        6'h01   : rd_data <= low_count;
+	        6'h02   : rd_data <= snap_period;
+	        6'h03   : rd_data <= shadow_high;
+	        6'h04   : rd_data <= shadow_low;
+	        6'h05   : rd_data <= shadow_seq;
+	        
+	        // keep the default settings for slave registers 6 - 7
+	        // these will be used in the self-test program
+	        
+	        6'h06   : rd_data <= slv_reg6;
+	        6'h07   : rd_data <= slv_reg7;
+
+	        // hardware arithmetic unit results (read-only)
+
+	        6'h08   : rd_data <= freq_hz;
+	        6'h09   : rd_data <= duty_q16;
+
+	        // sample FIFO (read-only; reading slv_reg11 pops the FIFO)
+
+	        6'h0A   : rd_data <= fifo_rd_data[63:32];
+	        6'h0B   : rd_data <= fifo_rd_data[31:0];
+	        6'h0C   : rd_data <= fifo_status;
+	        6'h0D   : rd_data <= {slv_reg13[31:16], 16'b0};   // command strobes read as 0
+
+	        // interrupt enable & status
+
+	        6'h0E   : rd_data <= {26'b0, slv_reg14[5:0]};
+	        6'h0F   : rd_data <= {26'b0, irq_status};
+
+	        // control & reciprocal frequency counter
+
+	        6'h10   : rd_data <= {20'b0, slv_reg16[11:0]};
+	        6'h11   : rd_data <= slv_reg17;
+	        6'h12   : rd_data <= recip_periods;
+	        6'h13   : rd_data <= shadow_recip_clocks;
+
+	        // interval in progress
+
+	        6'h14   : rd_data <= live_count;
+	        6'h15   : rd_data <= meas_age;
+	        6'h16   : rd_data <= {30'b0, stale, live_level};
+
+	        // deglitch filter
+
+	        6'h17   : rd_data <= {15'b0, slv_reg23[16:0]};
+	        6'h18   : rd_data <= glitch_count;
+	        6'h19   : rd_data <= glitch_periods;
+
+	        // carrier-synchronous window counter
+
+	        6'h1A   : rd_data <= {16'b0, slv_reg26[15:0]};
+	        6'h1B   : rd_data <= sync_edges;
+	        6'h1C   : rd_data <= shadow_sync_clocks;
+	        6'h1D   : rd_data <= shadow_sync_span;
+	        6'h1E   : rd_data <= shadow_sync_seq;
+
+	        // windowed period statistics
+
+	        6'h20   : rd_data <= slv_reg32;
+	        6'h21   : rd_data <= stats_count;
+	        6'h22   : rd_data <= shadow_stats_min;
+	        6'h23   : rd_data <= shadow_stats_max;
+	        6'h24   : rd_data <= shadow_stats_sum[31:0];
+	        6'h25   : rd_data <= shadow_stats_sum[63:32];
+	        6'h26   : rd_data <= shadow_stats_sumsq[31:0];
+	        6'h27   : rd_data <= shadow_stats_sumsq[63:32];
+	        6'h28   : rd_data <= shadow_stats_seq;
+
+	        // period histogram
+
+	        6'h29   : rd_data <= {23'b0, slv_reg41[8], 3'b0, slv_reg41[4:0]};
+	        6'h2A   : rd_data <= slv_reg42;
+	        6'h2B   : rd_data <= hist_addr;
+	        6'h2C   : rd_data <= hist_rd_data;
+	        6'h2D   : rd_data <= hist_status;
+
+	        // instrumentation counters
+
+	        6'h2E   : rd_data <= edge_count;
+	        6'h2F   : rd_data <= snap_seq;
+	        6'h30   : rd_data <= overrun_count;
+	        6'h31   : rd_data <= new_periods;
+
+	        // loopback pulse generator
+
+	        6'h32   : rd_data <= slv_reg50;
+	        6'h33   : rd_data <= slv_reg51;
+
+	        // channel information (read-only)
+
+	        6'h34   : rd_data <= {16'b0, NUM_CHANNELS[7:0], CHANNEL[7:0]};
+
+	        // cycle counter & edge timestamps
+
+	        6'h35   : rd_data <= timestamp[31:0];
+	        6'h36   : rd_data <= shadow_time_hi;
+	        6'h37   : rd_data <= shadow_rise_ts[31:0];
+	        6'h38   : rd_data <= shadow_rise_ts[63:32];
+	        6'h39   : rd_data <= shadow_fall_ts[31:0];
+	        6'h3A   : rd_data <= shadow_fall_ts[63:32];
+
+	        // filtered period & frequency
+
+	        6'h3B   : rd_data <= filt_period;
+	        6'h3C   : rd_data <= filt_freq_hz;
+
+	        // prescaler range
+
+	        6'h3D   : rd_data <= {20'b0, range, 3'b0, shadow_sat, shadow_range};
+	        6'h3E   : rd_data <= CLK_FREQUENCY_HZ;
+	        default : rd_data <= 0;
+	      endcase
+	end
+
+	/******************************************************************/
+	/* Measurement logic							                  */
+	/******************************************************************/
+
+    wire    [31:0]      high_count;
+    wire    [31:0]      low_count;
+
+    wire    [31:0]      snap_high;
+    wire    [31:0]      snap_low;
+    wire    [31:0]      snap_period;
+    wire    [31:0]      snap_clocks;
+    wire    [31:0]      snap_seq;
+    wire                snap_valid;
+    wire    [63:0]      snap_rise_ts;
+    wire    [63:0]      snap_fall_ts;
+
+    wire    [31:0]      freq_hz;
+    wire    [31:0]      duty_q16;
+    wire                calc_valid;
+
+    wire    [63:0]      fifo_rd_data;
+    wire    [FIFO_ADDR_WIDTH:0]     fifo_level;
+    wire    [15:0]      fifo_level_16;
+    wire                fifo_empty;
+    wire                fifo_full;
+    wire                fifo_overflow;
+    wire    [31:0]      fifo_status;
+    wire                fifo_pop;
+    wire                fifo_flush;
+    wire                fifo_clr_overflow;
+
+    reg     [5:0]       irq_status;
+    wire    [5:0]       irq_events;
+    wire    [5:0]       irq_clear;
+    wire    [15:0]      fifo_threshold;
+
+    reg     [31:0]      shadow_high;
+    reg     [31:0]      shadow_low;
+    reg     [31:0]      shadow_seq;
+    reg     [63:0]      shadow_rise_ts;
+    reg     [63:0]      shadow_fall_ts;
+    reg     [31:0]      shadow_time_hi;
+
+    wire    [31:0]      recip_periods;
+    wire    [31:0]      recip_clocks;
+    wire                recip_valid;
+    reg     [31:0]      shadow_recip_clocks;
+
+    wire    [31:0]      sync_edges;
+    wire    [31:0]      sync_clocks;
+    wire    [31:0]      sync_span;
+    wire    [31:0]      sync_seq;
+    wire                sync_valid;
+    reg     [31:0]      shadow_sync_clocks;
+    reg     [31:0]      shadow_sync_span;
+    reg     [31:0]      shadow_sync_seq;
+
+    wire    [3:0]       snap_range;
+    wire                snap_sat;
+    wire    [3:0]       range;
+    reg     [3:0]       shadow_range;
+    reg                 shadow_sat;
+
+    wire    [31:0]      filt_period;
+    wire    [31:0]      filt_freq_hz;
+    wire                filt_valid;
+
+    wire    [31:0]      live_count;
+    wire                live_level;
+    wire    [31:0]      meas_age;
+    wire                stale;
+
+    wire    [31:0]      glitch_count;
+    wire    [31:0]      glitch_periods;
+    wire                clr_glitch;
+
+    // any write to slv_reg24 (glitch_count) clears both glitch counters
+
+    assign clr_glitch = wr_en && (wr_addr == 6'h18);
+
+    wire    [31:0]      stats_count;
+    wire    [31:0]      stats_min;
+    wire    [31:0]      stats_max;
+    wire    [63:0]      stats_sum;
+    wire    [63:0]      stats_sumsq;
+    wire    [31:0]      stats_seq;
+    wire                stats_valid;
+    wire                stats_latch;
+
+    reg     [31:0]      shadow_stats_min;
+    reg     [31:0]      shadow_stats_max;
+    reg     [63:0]      shadow_stats_sum;
+    reg     [63:0]      shadow_stats_sumsq;
+    reg     [31:0]      shadow_stats_seq;
+
+    wire    [31:0]      hist_rd_data;
+    wire    [31:0]      hist_status;
+    wire                hist_busy;
+    wire                hist_clear;
+    reg     [31:0]      hist_addr;
+    wire    [15:0]      hist_last_bin;
+
+    wire    [31:0]      edge_count;
+    reg                 snap_unread;
+    reg                 result_pending;
+    wire                snap_read;
+    reg     [31:0]      overrun_count;
+    reg     [31:0]      new_periods;
+
+    wire                loopback;
+    wire                patgen_pwm;
+    wire                hwdet_in;
+
+    // every complete period is also offered to the record stream (hwdet_stream.v)
+
+    assign rec_valid = snap_valid;
+    assign rec_ts    = snap_rise_ts;
+    assign rec_high  = snap_high;
+    assign rec_low   = snap_low;
+
+    // and both frequencies to the closed-loop controller (hwdet_ctrl.v)
+
+    assign ctl_freq_valid = calc_valid;
+    assign ctl_freq_hz    = freq_hz;
+    assign ctl_filt_valid = filt_valid;
+    assign ctl_filt_hz    = filt_freq_hz;
+
+    // any write to slv_reg33 (stats_count) publishes & clears the window in progress
+
+    assign stats_latch = wr_en && (wr_addr == 6'h21);
+
+    // freeze the rest of the snapshot whenever slv_reg2 (snap_period) is read
+    // hw_detect.v updates all of the snapshot values in the same cycle, so
+    // slv_reg2 - slv_reg5 and the edge timestamps always describe the same period
+
+    always @( posedge clock )
+    begin
+      if ( reset )
+        begin
+          shadow_high    <= 0;
+          shadow_low     <= 0;
+          shadow_seq     <= 0;
+          shadow_rise_ts <= 0;
+          shadow_fall_ts <= 0;
+          shadow_range   <= 0;
+          shadow_sat     <= 0;
+        end
+      else if (rd_en && (rd_addr == 6'h02))
+        begin
+          shadow_high    <= snap_high;
+          shadow_low     <= snap_low;
+          shadow_seq     <= snap_seq;
+          shadow_rise_ts <= snap_rise_ts;
+          shadow_fall_ts <= snap_fall_ts;
+          shadow_range   <= snap_range;
+          shadow_sat     <= snap_sat;
+        end
+    end
+
+    // reading slv_reg53 (time [31:0]) freezes the upper half of the cycle
+    // counter, so a carry between the two reads can't tear the 64-bit value
+
+    always @( posedge clock )
+    begin
+      if ( reset )
+        begin
+          shadow_time_hi <= 0;
+        end
+      else if (rd_en && (rd_addr == 6'h35))
+        begin
+          shadow_time_hi <= timestamp[63:32];
+        end
+    end
+
+    // same for the reciprocal counter: reading slv_reg18 (recip_periods)
+    // freezes slv_reg19 (recip_clocks) from the same gate
+
+    always @( posedge clock )
+    begin
+      if ( reset )
+        begin
+          shadow_recip_clocks <= 0;
+        end
+      else if (rd_en && (rd_addr == 6'h12))
+        begin
+          shadow_recip_clocks <= recip_clocks;
+        end
+    end
+
+    // and for the synchronous windows: reading slv_reg27 (sync_edges)
+    // freezes slv_reg28 - slv_reg30 from the same window
+
+    always @( posedge clock )
+    begin
+      if ( reset )
+        begin
+          shadow_sync_clocks <= 0;
+          shadow_sync_span   <= 0;
+          shadow_sync_seq    <= 0;
+        end
+      else if (rd_en && (rd_addr == 6'h1B))
+        begin
+          shadow_sync_clocks <= sync_clocks;
+          shadow_sync_span   <= sync_span;
+          shadow_sync_seq    <= sync_seq;
+        end
+    end
+
+    // and for the statistics: reading slv_reg33 (stats_count) freezes
+    // slv_reg34 - slv_reg40 from the same window
+
+    always @( posedge clock )
+    begin
+      if ( reset )
+        begin
+          shadow_stats_min   <= 0;
+          shadow_stats_max   <= 0;
+          shadow_stats_sum   <= 0;
+          shadow_stats_sumsq <= 0;
+          shadow_stats_seq   <= 0;
+        end
+      else if (rd_en && (rd_addr == 6'h21))
+        begin
+          shadow_stats_min   <= stats_min;
+          shadow_stats_max   <= stats_max;
+          shadow_stats_sum   <= stats_sum;
+          shadow_stats_sumsq <= stats_sumsq;
+          shadow_stats_seq   <= stats_seq;
+        end
+    end
+    
+    // instantiate the hw_detect.v module
+    
+    hw_detect #(
+        .CLK_FREQUENCY_HZ   (CLK_FREQUENCY_HZ))
+
+    HWDET (
+
+        .clock              (clock),            // I [ 0 ] 100MHz system clock
+        .reset              (reset),            // I [ 0 ] active-high reset
+        .pwm                (hwdet_in),         // I [ 0 ] PWM signal from AXI Timer (or the loopback generator)
+
+        .deglitch_width     (slv_reg23[15:0]),  // I [15:0] deglitch filter width (0 = bypass)
+        .deglitch_majority  (slv_reg23[16]),    // I [ 0 ] majority vote / minimum pulse width
+        .clr_glitch         (clr_glitch),       // I [ 0 ] clear the glitch counters
+
+        .stats_window       (slv_reg32),        // I [31:0] periods per statistics window
+        .stats_latch        (stats_latch),      // I [ 0 ] publish & clear the statistics now
+
+        .timestamp          (timestamp),        // I [63:0] free-running cycle counter
+
+        .auto_range         (slv_reg16[7]),     // I [ 0 ] choose the prescaler range automatically
+        .manual_range       (slv_reg16[11:8]),  // I [3:0] prescaler range when auto_range = 0
+
+        .filt_median        (slv_reg16[3:2]),   // I [1:0] period median filter (0 = off)
+        .filt_avg_log2      (slv_reg16[6:4]),   // I [2:0] period moving average of 2^n periods (0 = off)
+
+        .recip_en           (slv_reg16[0]),     // I [ 0 ] enable the reciprocal frequency counter
+        .gate_time          (slv_reg17),        // I [31:0] reciprocal counter gate time (clock cycles)
+
+        .high_count         (high_count),       // O [31:0] how long PWM was 'high' --> send to Microblaze
+        .low_count          (low_count),        // O [31:0] how long PWM was 'low' --> send to Microblaze
+
+        .snap_high          (snap_high),        // O [31:0] 'high' interval of the last complete period
+        .snap_low           (snap_low),         // O [31:0] 'low' interval of the last complete period
+        .snap_period        (snap_period),      // O [31:0] length of the last complete period
+        .snap_seq           (snap_seq),         // O [31:0] sequence number of the last complete period
+        .snap_valid         (snap_valid),       // O [ 0 ] pulse when a new snapshot is latched
+        .snap_rise_ts       (snap_rise_ts),     // O [63:0] cycle counter at the rising edge ending the period
+        .snap_fall_ts       (snap_fall_ts),     // O [63:0] cycle counter at the falling edge inside the period
+        .snap_range         (snap_range),       // O [3:0] prescaler range of the last complete period
+        .snap_clocks        (snap_clocks),      // O [31:0] last complete period in clock cycles
+        .snap_sat           (snap_sat),         // O [ 0 ] last complete period saturated the counter
+        .range              (range),            // O [3:0] prescaler range of the period in progress
+
+        .freq_hz            (freq_hz),          // O [31:0] frequency of the last complete period in Hz
+        .duty_q16           (duty_q16),         // O [31:0] duty cycle of the last complete period (Q16)
+        .calc_valid         (calc_valid),       // O [ 0 ] pulse when freq_hz & duty_q16 are updated
+
+        .filt_period        (filt_period),      // O [31:0] filtered period
+        .filt_freq_hz       (filt_freq_hz),     // O [31:0] frequency of the filtered period in Hz
+        .filt_valid         (filt_valid),       // O [ 0 ] pulse when filt_freq_hz is updated
+
+        .recip_periods      (recip_periods),    // O [31:0] whole periods in the last gate
+        .recip_clocks       (recip_clocks),     // O [31:0] clock cycles taken by those periods
+        .recip_valid        (recip_valid),      // O [ 0 ] pulse when a gate closes
+
+        .live_count         (live_count),       // O [31:0] running count of the interval in progress
+        .live_level         (live_level),       // O [ 0 ] level of the interval in progress
+        .meas_age           (meas_age),         // O [31:0] clock cycles since the last snapshot
+        .stale              (stale),            // O [ 0 ] interval in progress outlasted the last period
+
+        .glitch_count       (glitch_count),     // O [31:0] pulses removed by the deglitch filter
+        .glitch_periods     (glitch_periods),   // O [31:0] periods that contained a removed pulse
+
+        .stats_count        (stats_count),      // O [31:0] periods in the last window
+        .stats_min          (stats_min),        // O [31:0] shortest period in the window
+        .stats_max          (stats_max),        // O [31:0] longest period in the window
+        .stats_sum          (stats_sum),        // O [63:0] sum of the periods
+        .stats_sumsq        (stats_sumsq),      // O [63:0] sum of the squared periods
+        .stats_seq          (stats_seq),        // O [31:0] window sequence number
+        .stats_valid        (stats_valid),      // O [ 0 ] pulse when a window is published
+
+        .edge_count         (edge_count));      // O [31:0] free-running count of rising edges
+
+    // carrier-synchronous window counter
+    // counts the rising edges of the (deglitched) input over a whole number of
+    // periods of the PWM carrier, so the LED ripple doesn't alias into the reading
+
+    hwdet_sync SYNC (
+        .clock              (clock),            // I [ 0 ] 100MHz system clock
+        .reset              (reset),            // I [ 0 ] active-high reset
+        .trig               (pwm_trig),         // I [ 0 ] PWM carrier driving the LED
+        .carrier_periods    (slv_reg26[15:0]),  // I [15:0] carrier periods per window (0 = off)
+        .edge_count         (edge_count),       // I [31:0] free-running count of rising edges
+        .sync_edges         (sync_edges),       // O [31:0] rising edges in the last window
+        .sync_clocks        (sync_clocks),      // O [31:0] clock cycles in the last window
+        .sync_span          (sync_span),        // O [31:0] clock cycles from its first to its last edge
+        .sync_seq           (sync_seq),         // O [31:0] window sequence number
+        .sync_valid         (sync_valid));      // O [ 0 ] pulse when a window closes
+       
+    // sample FIFO of completed periods {high, low}
+    // slv_reg13 is a write-only command register, so its bits act as strobes
+
+    assign fifo_pop = rd_en && (rd_addr == 6'h0B);
+    assign fifo_flush = wr_en && (wr_addr == 6'h0D) && wr_data[0];
+    assign fifo_clr_overflow = wr_en && (wr_addr == 6'h0D) && wr_data[1];
+
+    // zero-extended by the assignment, so any FIFO_ADDR_WIDTH up to 15 fits the 16-bit field
+
+    assign fifo_level_16 = fifo_level;
+    assign fifo_status = {fifo_overflow, 13'b0, fifo_full, fifo_empty, fifo_level_16};
+
+    hwdet_fifo #(
+        .DATA_WIDTH         (64),
+        .ADDR_WIDTH         (FIFO_ADDR_WIDTH))
+
+    FIFO (
+        .clock              (clock),            // I [ 0 ] 100MHz system clock
+        .reset              (reset),            // I [ 0 ] active-high reset
+        .flush              (fifo_flush),       // I [ 0 ] discard all entries
+
+        .wr_en              (snap_valid),       // I [ 0 ] push every complete period
+        .wr_data            ({snap_high, snap_low}),    // I [63:0] 'high' and 'low' intervals
+
+        .rd_en              (fifo_pop),         // I [ 0 ] pop on read of slv_reg11
+        .rd_data            (fifo_rd_data),     // O [63:0] oldest period in the FIFO
+
+        .level              (fifo_level),       // O [FIFO_ADDR_WIDTH:0] number of queued periods
+        .empty              (fifo_empty),       // O [ 0 ] no periods queued
+        .full               (fifo_full),        // O [ 0 ] no room for another period
+
+        .clr_overflow       (fifo_clr_overflow),    // I [ 0 ] clear the overflow flag
+        .overflow           (fifo_overflow));   // O [ 0 ] a period was dropped because the FIFO was full
+
+    // loopback pulse generator
+    // with slv_reg16[1] set, hw_detect measures the internal generator instead of
+    // pwm_in, so the whole measurement chain can be checked against known values
+
+    assign loopback = slv_reg16[1];
+    assign hwdet_in = loopback ? patgen_pwm : pwm_in;
+
+    hwdet_patgen PATGEN (
+        .clock              (clock),            // I [ 0 ] 100MHz system clock
+        .reset              (reset),            // I [ 0 ] active-high reset
+        .enable             (loopback),         // I [ 0 ] run only while in loopback
+        .high_len           (slv_reg50),        // I [31:0] 'high' time in clock cycles
+        .low_len            (slv_reg51),        // I [31:0] 'low' time in clock cycles
+        .pwm                (patgen_pwm));      // O [ 0 ] generated square wave
+
+    // instrumentation counters
+    // a snapshot is overrun when the next period completes before software read it,
+    // either through slv_reg2 (snap_period) or through the slv_reg8 / slv_reg9 results
+    // (freq_hz, duty_q16) computed from it. The results only count once the divider
+    // has published them; until then they still describe the previous period.
+    // new_periods counts complete periods and is cleared when it is read;
+    // a period that completes in the same clock as the read is counted afterwards
+
+    assign snap_read = rd_en && ((rd_addr == 6'h02) ||
+                                 (((rd_addr == 6'h08) || (rd_addr == 6'h09)) && !result_pending));
+
+    always @( posedge clock )
+    begin
+      if ( reset )
+        begin
+          snap_unread    <= 1'b0;
+          result_pending <= 1'b0;
+          overrun_count  <= 0;
+          new_periods    <= 0;
+        end
+      else
+        begin
+          if (snap_valid)
+            result_pending <= 1'b1;
+          else if (calc_valid)
+            result_pending <= 1'b0;
+
+          if (snap_valid)
+            snap_unread <= 1'b1;
+          else if (snap_read)
+            snap_unread <= 1'b0;
+
+          if (snap_valid && snap_unread)
+            overrun_count <= overrun_count + 1;
+
+          if (rd_en && (rd_addr == 6'h31))
+            new_periods <= snap_valid ? 1 : 0;
+          else if (snap_valid)
+            new_periods <= new_periods + 1;
+        end
+    end
+
+    // period histogram
+    // hist_addr is written by software and advances on every read of slv_reg44
+    // (hist_data), so all of the bins can be read back to back
+
+    always @( posedge clock )
+    begin
+      if ( reset )
+        begin
+          hist_addr <= 0;
+        end
+      else if (wr_en && (wr_addr == 6'h2B))
+        begin
+          hist_addr <= wr_data & ((1 << HIST_ADDR_WIDTH) - 1);
+        end
+      else if (rd_en && (rd_addr == 6'h2C))
+        begin
+          hist_addr <= (hist_addr + 1) & ((1 << HIST_ADDR_WIDTH) - 1);
+        end
+    end
+
+    assign hist_clear = wr_en && (wr_addr == 6'h2D) && wr_data[0];
+    assign hist_last_bin = (1 << HIST_ADDR_WIDTH) - 1;
+    assign hist_status = {hist_busy, 15'b0, hist_last_bin};
+
+    hwdet_hist #(
+        .ADDR_WIDTH         (HIST_ADDR_WIDTH))
+
+    HIST (
+        .clock              (clock),            // I [ 0 ] 100MHz system clock
+        .reset              (reset),            // I [ 0 ] active-high reset
+        .enable             (slv_reg41[8]),     // I [ 0 ] count new periods
+        .sample_valid       (snap_valid),       // I [ 0 ] a new period was latched
+        .sample             (snap_clocks),      // I [31:0] clock ticks per period (prescaler undone)
+        .offset             (slv_reg42),        // I [31:0] lower edge of the first bin
+        .shift              (slv_reg41[4:0]),   // I [4:0] bin width = 2^shift
+        .clear              (hist_clear),       // I [ 0 ] zero every bin
+        .busy               (hist_busy),        // O [ 0 ] clear in progress
+        .rd_addr            (hist_addr[HIST_ADDR_WIDTH-1:0]),   // I [HIST_ADDR_WIDTH-1:0] bin to read
+        .rd_data            (hist_rd_data));    // O [31:0] count of that bin
+
+
+    // interrupt logic
+    // each event sets its bit in irq_status (slv_reg15) until software writes a 1 to
+    // that bit. The FIFO threshold event is level-based, so acknowledging it before
+    // draining the FIFO below the threshold sets it again right away
+
+    assign fifo_threshold = slv_reg13[31:16];
+
+    assign irq_events = {sync_valid,
+                         stats_valid,
+                         snap_valid && fifo_full,                  // a period is being dropped
+                         (fifo_threshold != 16'b0) && (fifo_level >= fifo_threshold),
+                         calc_valid,
+                         snap_valid};
+
+    assign irq_clear = (wr_en && (wr_addr == 6'h0F))
+                       ? wr_data[5:0] : 6'b0;
+
+    always @( posedge clock )
+    begin
+      if ( reset )
+        begin
+          irq_status <= 6'b0;
+          irq        <= 1'b0;
+        end
+      else
+        begin
+          irq_status <= (irq_status & ~irq_clear) | irq_events;    // new events win over a clear
+          irq        <= |(irq_status & slv_reg14[5:0]);
+        end
+    end
+
+endmodule
@@ -0,0 +1,508 @@
+// hwdet_ctrl.v --> closed-loop light controller (bang-bang / PID) with its own PWM output
+//
+//
+// Author:	Rehan Iqbal
+// Organization: Portland State University
+//
+// Description:
+//
+// This hardware module closes the control loop in the fabric. Every time the
+// selected channel publishes a new frequency (hw_detect.v's hardware divider,
+// or the filtered frequency) it computes a new PWM compare value and loads it
+// into a PWM generator of its own at the start of the next PWM period. The loop
+// runs once per sensor period, a few clocks after the period ends, so the
+// Microblaze only has to set it up and watch the telemetry.
+//
+// Two control laws are available:
+//
+//	1) bang-bang: the compare value goes to 'out_max' when the frequency is more
+//	   than 'hysteresis' Hz below the setpoint, to 'out_min' when it is more than
+//	   'hysteresis' Hz above, and holds in between
+//	2) PID:	e = setpoint - frequency
+//			out = bias + ((kp * e + ki * sum(e) + kd * (e - e_last)) >>> gain_shift)
+//	   clamped to 'out_min' - 'out_max'. The gains are signed 16-bit integers and
+//	   'gain_shift' sets the binary point, e.g. kp = 0x0180 with gain_shift = 8 is
+//	   a gain of 1.5. sum(e) is clamped to +/- 'integ_limit' and stops growing
+//	   while the output is pinned at a limit in the direction of the error
+//	   (anti-windup).
+//
+// The compute pipeline is three clocks long so the multipliers map onto the DSP
+// slices. A new compare value is only picked up when the PWM counter wraps, so
+// the output never glitches in the middle of a period.
+//
+// The registers of this bank are:
+//
+//		slv_reg0		(ctl_ctrl) [0] enable, [1] 1 = PID, 0 = bang-bang, [2] use the filtered
+//						frequency, [6:4] channel that is controlled (read/write);
+//						writing 1 to [8] clears the integrator
+//		slv_reg1		(setpoint) target frequency in Hz (read/write)
+//		slv_reg2		(pwm_period) PWM period in clock cycles (read/write, < 2 = output off)
+//		slv_reg3		(out_min) lowest compare value (read/write)
+//		slv_reg4		(out_max) highest compare value (read/write)
+//		slv_reg5		(kp) proportional gain, signed [15:0] (read/write)
+//		slv_reg6		(ki) integral gain, signed [15:0] (read/write)
+//		slv_reg7		(kd) derivative gain, signed [15:0] (read/write)
+//		slv_reg8		(gain_shift) [4:0] right shift of the PID sum (read/write)
+//		slv_reg9		(hysteresis) bang-bang dead band in Hz (read/write)
+//		slv_reg10		(integ_limit) largest magnitude of the integrator (read/write, 0 = no I term)
+//		slv_reg11		(bias) offset added to the PID output, in compare counts (read/write)
+//		slv_reg12		(tlm_seq) loop updates since the last enable; reading this register
+//						also freezes slv_reg13 - slv_reg15
+//		slv_reg13		(tlm_freq) frequency used by that update in Hz
+//		slv_reg14		(tlm_error) error of that update in Hz, signed
+//		slv_reg15		(tlm_output) compare value produced by that update
+//		slv_reg16		(integ) integrator, signed (read-only)
+//		slv_reg17-63	*RESERVED* (read as 0)
+//
+// 'pwm' runs in the clock of this module. 'active' is high while the controller is
+// enabled, so the top level can hand the LED over from the AXI timer.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+module hwdet_ctrl (
+
+	/******************************************************************/
+	/* Port declarations							                  */
+	/******************************************************************/
+
+	input 								clock,			// 100MHz system clock
+	input 								reset,			// active-high synchronous reset
+
+	input 								wr_en,			// register write strobe for this bank
+	input		[5:0]					wr_addr,		// register being written
+	input		[31:0]					wr_data,		// write data
+	input		[3:0]					wr_strb,		// byte enables for 'wr_data'
+
+	input 								rd_en,			// register read strobe for this bank
+	input		[5:0]					rd_addr,		// register being read
+	output reg	[31:0]					rd_data,		// contents of register 'rd_addr'
+
+	output		[2:0]					source,			// channel that is controlled
+	output 								use_filt,		// 1 = filtered frequency, 0 = last period
+	input 								freq_valid,		// selected channel published a new frequency
+	input		[31:0]					freq_hz,		// that frequency in Hz
+
+	output reg 							pwm,			// PWM output driving the LED
+	output 								active);		// controller is enabled
+
+	/******************************************************************/
+	/* Local parameters and values		                  	  		  */
+	/******************************************************************/
+
+	reg			[31:0]					slv_reg0;
+	reg			[31:0]					slv_reg1;
+	reg			[31:0]					slv_reg2;
+	reg			[31:0]					slv_reg3;
+	reg			[31:0]					slv_reg4;
+	reg			[31:0]					slv_reg5;
+	reg			[31:0]					slv_reg6;
+	reg			[31:0]					slv_reg7;
+	reg			[31:0]					slv_reg8;
+	reg			[31:0]					slv_reg9;
+	reg			[31:0]					slv_reg10;
+	reg			[31:0]					slv_reg11;
+	integer	 							byte_index;
+
+	wire								enable;
+	wire								pid_mode;
+	wire								integ_clear;
+	wire signed	[15:0]				kp;
+	wire signed	[15:0]				ki;
+	wire signed	[15:0]				kd;
+	wire signed	[33:0]				integ_max;
+
+	wire signed	[32:0]				err_full;		// setpoint - frequency before saturation
+	wire signed	[31:0]				err;			// error, saturated to 32 bits
+	wire signed	[32:0]				derr_full;		// err - last error before saturation
+	wire signed	[33:0]				integ_sum;		// integrator + err before clamping
+
+	reg 								a_valid;		// stage A: error, derivative & integrator
+	reg			[31:0]					a_freq;
+	reg signed	[31:0]				a_err;
+	reg signed	[31:0]				a_derr;
+	reg signed	[31:0]				integ;
+	reg signed	[31:0]				last_err;
+	reg 								have_last;		// last_err holds a real error
+
+	reg 								b_valid;		// stage B: the three products
+	reg			[31:0]					b_freq;
+	reg signed	[31:0]				b_err;
+	reg signed	[47:0]				p_term;
+	reg signed	[47:0]				i_term;
+	reg signed	[47:0]				d_term;
+
+	wire signed	[49:0]				pid_sum;
+	wire signed	[49:0]				pid_shifted;
+	wire signed	[50:0]				pid_out;		// bias + shifted sum
+
+	reg			[31:0]					duty;			// compare value for the next PWM period
+	reg 								sat_high;		// last update was pinned at out_max
+	reg 								sat_low;		// last update was pinned at out_min
+	reg			[31:0]					duty_next;		// compare value from the update in stage C
+	reg 								sat_high_next;
+	reg 								sat_low_next;
+
+	reg			[31:0]					tlm_seq;
+	reg			[31:0]					tlm_freq;
+	reg signed	[31:0]				tlm_error;
+	reg			[31:0]					tlm_output;
+	reg			[31:0]					shadow_freq;
+	reg			[31:0]					shadow_error;
+	reg			[31:0]					shadow_output;
+
+	reg			[31:0]					pwm_count;		// clocks into the PWM period
+	reg			[31:0]					pwm_compare;	// compare value of the PWM period in progress
+
+	/******************************************************************/
+	/* Register writes								                  */
+	/******************************************************************/
+
+	always @( posedge clock )
+	begin
+	  if ( reset )
+	    begin
+	      slv_reg0 <= 0;
+	      slv_reg1 <= 0;
+	      slv_reg2 <= 0;
+	      slv_reg3 <= 0;
+	      slv_reg4 <= 0;
+	      slv_reg5 <= 0;
+	      slv_reg6 <= 0;
+	      slv_reg7 <= 0;
+	      slv_reg8 <= 0;
+	      slv_reg9 <= 0;
+	      slv_reg10 <= 0;
+	      slv_reg11 <= 0;
+	    end
+	  else begin
+	    if (wr_en)
+	      begin
+	        case ( wr_addr )
+	          6'h00:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes
+	                // Slave register 0
+	                slv_reg0[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end
+	          6'h01:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes
+	                // Slave register 1
+	                slv_reg1[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end
+	          6'h02:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes
+	                // Slave register 2
+	                slv_reg2[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end
+	          6'h03:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes
+	                // Slave register 3
+	                slv_reg3[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end
+	          6'h04:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes
+	                // Slave register 4
+	                slv_reg4[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end
+	          6'h05:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes
+	                // Slave register 5
+	                slv_reg5[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end
+	          6'h06:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes
+	                // Slave register 6
+	                slv_reg6[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end
+	          6'h07:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes
+	                // Slave register 7
+	                slv_reg7[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end
+	          6'h08:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes
+	                // Slave register 8
+	                slv_reg8[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end
+	          6'h09:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes
+	                // Slave register 9
+	                slv_reg9[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end
+	          6'h0A:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes
+	                // Slave register 10
+	                slv_reg10[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end
+	          6'h0B:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes
+	                // Slave register 11
+	                slv_reg11[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end
+	          default : begin
+	                      // all other slave registers are read-only; writes are ignored
+	                      slv_reg0 <= slv_reg0;
+	                      slv_reg1 <= slv_reg1;
+	                      slv_reg2 <= slv_reg2;
+	                      slv_reg3 <= slv_reg3;
+	                      slv_reg4 <= slv_reg4;
+	                      slv_reg5 <= slv_reg5;
+	                      slv_reg6 <= slv_reg6;
+	                      slv_reg7 <= slv_reg7;
+	                      slv_reg8 <= slv_reg8;
+	                      slv_reg9 <= slv_reg9;
+	                      slv_reg10 <= slv_reg10;
+	                      slv_reg11 <= slv_reg11;
+	                    end
+	        endcase
+	      end
+	  end
+	end
+
+	/******************************************************************/
+	/* Register reads								                  */
+	/******************************************************************/
+
+	always @(*)
+	begin
+	      // Address decoding for reading registers
+	      case ( rd_addr )
+	        6'h00   : rd_data <= {25'b0, slv_reg0[6:4], 1'b0, slv_reg0[2:0]};
+	        6'h01   : rd_data <= slv_reg1;
+	        6'h02   : rd_data <= slv_reg2;
+	        6'h03   : rd_data <= slv_reg3;
+	        6'h04   : rd_data <= slv_reg4;
+	        6'h05   : rd_data <= {{16{kp[15]}}, kp};
+	        6'h06   : rd_data <= {{16{ki[15]}}, ki};
+	        6'h07   : rd_data <= {{16{kd[15]}}, kd};
+	        6'h08   : rd_data <= {27'b0, slv_reg8[4:0]};
+	        6'h09   : rd_data <= slv_reg9;
+	        6'h0A   : rd_data <= slv_reg10;
+	        6'h0B   : rd_data <= slv_reg11;
+	        6'h0C   : rd_data <= tlm_seq;
+	        6'h0D   : rd_data <= shadow_freq;
+	        6'h0E   : rd_data <= shadow_error;
+	        6'h0F   : rd_data <= shadow_output;
+	        6'h10   : rd_data <= integ;
+	        default : rd_data <= 0;
+	      endcase
+	end
+
+	/******************************************************************/
+	/* Control law									                  */
+	/******************************************************************/
+
+    assign enable      = slv_reg0[0];
+    assign pid_mode    = slv_reg0[1];
+    assign use_filt    = slv_reg0[2];
+    assign source      = slv_reg0[6:4];
+    assign active      = enable;
+
+    assign kp          = slv_reg5[15:0];
+    assign ki          = slv_reg6[15:0];
+    assign kd          = slv_reg7[15:0];
+    assign integ_max   = {3'b0, slv_reg10[30:0]};
+
+    // writing 1 to slv_reg0[8] clears the integrator; the bit itself is not stored
+
+    assign integ_clear = wr_en && (wr_addr == 6'h00) && wr_strb[1] && wr_data[8];
+
+    // stage A inputs: the error and its change are saturated to 32 bits, and the
+    // integrator only moves if that doesn't push a pinned output further out
+
+    assign err_full    = $signed({1'b0, slv_reg1}) - $signed({1'b0, freq_hz});
+    assign err         = (err_full > 33'sh07FFFFFFF) ? 32'sh7FFFFFFF :
+                         (err_full < -33'sh080000000) ? 32'sh80000000 : err_full[31:0];
+
+    assign derr_full   = have_last ? ($signed({err[31], err}) - $signed({last_err[31], last_err})) : 33'sb0;
+
+    assign integ_sum   = $signed({{2{integ[31]}}, integ}) + $signed({{2{err[31]}}, err});
+
+    // stage C: PID sum, binary point & bias
+
+    assign pid_sum     = $signed({{2{p_term[47]}}, p_term}) + $signed({{2{i_term[47]}}, i_term})
+                         + $signed({{2{d_term[47]}}, d_term});
+    assign pid_shifted = pid_sum >>> slv_reg8[4:0];
+    assign pid_out     = $signed({pid_shifted[49], pid_shifted}) + $signed({19'b0, slv_reg11});
+
+    always @(*)
+    begin
+      duty_next     = duty;
+      sat_high_next = sat_high;
+      sat_low_next  = sat_low;
+
+      if (pid_mode)
+        begin
+          sat_high_next = (pid_out >= $signed({19'b0, slv_reg4}));
+          sat_low_next  = !sat_high_next && (pid_out <= $signed({19'b0, slv_reg3}));
+
+          if (sat_high_next)
+            duty_next = slv_reg4;
+          else if (sat_low_next)
+            duty_next = slv_reg3;
+          else
+            duty_next = pid_out[31:0];
+        end
+      else
+        begin
+          if (b_err > $signed({1'b0, slv_reg9[30:0]}))
+            duty_next = slv_reg4;                 // too dark --> full on
+          else if (b_err < -$signed({1'b0, slv_reg9[30:0]}))
+            duty_next = slv_reg3;                 // too bright --> full off
+        end
+    end
+
+    always @( posedge clock )
+    begin
+      if ( reset || !enable )
+        begin
+          a_valid    <= 1'b0;
+          a_freq     <= 0;
+          a_err      <= 0;
+          a_derr     <= 0;
+          integ      <= 0;
+          last_err   <= 0;
+          have_last  <= 1'b0;
+          b_valid    <= 1'b0;
+          b_freq     <= 0;
+          b_err      <= 0;
+          p_term     <= 0;
+          i_term     <= 0;
+          d_term     <= 0;
+          duty       <= slv_reg3;                 // start from out_min
+          sat_high   <= 1'b0;
+          sat_low    <= 1'b1;
+          tlm_seq    <= 0;
+          tlm_freq   <= 0;
+          tlm_error  <= 0;
+          tlm_output <= 0;
+        end
+      else
+        begin
+
+          // stage A: error, change of error & integrator
+
+          a_valid <= freq_valid;
+
+          if (freq_valid)
+            begin
+              a_freq    <= freq_hz;
+              a_err     <= err;
+              a_derr    <= (derr_full > 33'sh07FFFFFFF) ? 32'sh7FFFFFFF :
+                           (derr_full < -33'sh080000000) ? 32'sh80000000 : derr_full[31:0];
+              last_err  <= err;
+              have_last <= 1'b1;
+
+              if (integ_clear || !pid_mode)
+                integ <= 0;
+              else if ((sat_high && !err[31]) || (sat_low && err[31]))
+                integ <= integ;                   // output pinned --> don't wind up
+              else if (integ_sum > integ_max)
+                integ <= integ_max[31:0];
+              else if (integ_sum < -integ_max)
+                integ <= -integ_max[31:0];
+              else
+                integ <= integ_sum[31:0];
+            end
+          else if (integ_clear)
+            integ <= 0;
+
+          // stage B: the three products (DSP slices)
+
+          b_valid <= a_valid;
+          b_freq  <= a_freq;
+          b_err   <= a_err;
+          p_term  <= kp * a_err;
+          i_term  <= ki * integ;
+          d_term  <= kd * a_derr;
+
+          // stage C: new compare value & telemetry
+
+          if (b_valid)
+            begin
+              duty       <= duty_next;
+              sat_high   <= sat_high_next;
+              sat_low    <= sat_low_next;
+
+              tlm_seq    <= tlm_seq + 1;
+              tlm_freq   <= b_freq;
+              tlm_error  <= b_err;
+              tlm_output <= duty_next;
+            end
+
+        end
+    end
+
+    // reading slv_reg12 (tlm_seq) freezes slv_reg13 - slv_reg15 from the same update
+
+    always @( posedge clock )
+    begin
+      if ( reset )
+        begin
+          shadow_freq   <= 0;
+          shadow_error  <= 0;
+          shadow_output <= 0;
+        end
+      else if (rd_en && (rd_addr == 6'h0C))
+        begin
+          shadow_freq   <= tlm_freq;
+          shadow_error  <= tlm_error;
+          shadow_output <= tlm_output;
+        end
+    end
+
+	/******************************************************************/
+	/* PWM generator								                  */
+	/******************************************************************/
+
+    // a new compare value is taken when the counter wraps, so every PWM period
+    // is either the old duty cycle or the new one, never a mix
+
+    always @( posedge clock )
+    begin
+      if ( reset || !enable || (slv_reg2 < 2) )
+        begin
+          pwm_count   <= 0;
+          pwm_compare <= 0;
+          pwm         <= 1'b0;
+        end
+      else
+        begin
+          if (pwm_count >= slv_reg2 - 1)
+            begin
+              pwm_count   <= 0;
+              pwm_compare <= duty;
+            end
+          else
+            begin
+              pwm_count   <= pwm_count + 1;
+            end
+
+          pwm <= (pwm_count < pwm_compare);
+        end
+    end
+
+endmodule
@@ -0,0 +1,128 @@
+// hwdet_fifo.v --> synchronous FIFO for completed period measurements
+//
+//
+// Author:	Rehan Iqbal
+// Organization: Portland State University
+//
+// Description:
+//
+// This hardware module buffers completed period measurements from hw_detect.v
+// so that the Microblaze can drain them in bursts instead of polling at the
+// sensor rate. The storage array is written so that Vivado infers block RAM.
+//
+// The head of the FIFO is always presented on 'rd_data'; asserting 'rd_en'
+// discards it and advances to the next entry. A write into a full FIFO is
+// dropped and sets the sticky 'overflow' flag until 'clr_overflow' is pulsed.
+//
+// Block RAM reads are registered, so 'rd_data' follows a write or a pop by one
+// extra clock. The AXI4-Lite interface needs several clocks per transaction, so
+// software always sees a settled head entry after reading 'level'.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+module hwdet_fifo #(
+
+	/******************************************************************/
+	/* Parameter declarations						                  */
+	/******************************************************************/
+
+	parameter integer	DATA_WIDTH = 64,			// width of one entry
+	parameter integer	ADDR_WIDTH = 10)			// FIFO holds 2^ADDR_WIDTH entries
+
+	/******************************************************************/
+	/* Port declarations							                  */
+	/******************************************************************/
+
+	(
+	input 								clock,			// 100MHz system clock
+	input 								reset,			// active-high synchronous reset
+	input 								flush,			// discard all entries
+
+	input 								wr_en,			// push 'wr_data'
+	input		[DATA_WIDTH-1:0]		wr_data,		// entry to push
+
+	input 								rd_en,			// pop the head entry
+	output reg	[DATA_WIDTH-1:0]		rd_data,		// head entry
+
+	output		[ADDR_WIDTH:0]			level,			// number of entries in the FIFO
+	output 								empty,			// FIFO holds no entries
+	output 								full,			// FIFO cannot accept another entry
+
+	input 								clr_overflow,	// clear the sticky overflow flag
+	output reg 							overflow);		// an entry was dropped because the FIFO was full
+
+	/******************************************************************/
+	/* Local parameters and values		                  	  		  */
+	/******************************************************************/
+
+	localparam integer	DEPTH = (1 << ADDR_WIDTH);
+
+	reg			[DATA_WIDTH-1:0]		mem [0:DEPTH-1];	// block RAM storage
+	reg			[ADDR_WIDTH:0]			wr_ptr;				// write pointer (extra bit for full/empty)
+	reg			[ADDR_WIDTH:0]			rd_ptr;				// read pointer (extra bit for full/empty)
+	wire		[ADDR_WIDTH:0]			rd_ptr_next;		// read pointer after this cycle's pop
+
+	wire								do_write;			// accepted push
+	wire								do_read;			// accepted pop
+
+	assign level = wr_ptr - rd_ptr;
+	assign empty = (wr_ptr == rd_ptr);
+	assign full = (level == DEPTH);
+
+	assign do_write = wr_en && !full;
+	assign do_read = rd_en && !empty;
+	assign rd_ptr_next = do_read ? (rd_ptr + 1'b1) : rd_ptr;
+
+	/******************************************************************/
+	/* Block RAM write & registered read			                  */
+	/******************************************************************/
+
+	always@(posedge clock) begin
+
+		if (do_write) begin
+			mem[wr_ptr[ADDR_WIDTH-1:0]] <= wr_data;
+		end
+
+		rd_data <= mem[rd_ptr_next[ADDR_WIDTH-1:0]];	// look ahead so the new head is ready after a pop
+
+	end
+
+	/******************************************************************/
+	/* Pointers & status							                  */
+	/******************************************************************/
+
+	always@(posedge clock) begin
+
+		if (reset) begin
+			wr_ptr <= {(ADDR_WIDTH+1){1'b0}};
+			rd_ptr <= {(ADDR_WIDTH+1){1'b0}};
+			overflow <= 1'b0;
+		end
+
+		else begin
+
+			if (flush) begin
+				rd_ptr <= wr_ptr;					// drop everything that is queued
+			end
+
+			else begin
+				rd_ptr <= rd_ptr_next;
+			end
+
+			if (do_write) begin
+				wr_ptr <= wr_ptr + 1'b1;
+			end
+
+			if (clr_overflow) begin
+				overflow <= 1'b0;
+			end
+
+			else if (wr_en && full) begin
+				overflow <= 1'b1;					// newest entry was dropped
+			end
+
+		end
+
+	end
+
+endmodule
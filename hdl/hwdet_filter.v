@@ -0,0 +1,226 @@
+// hwdet_filter.v --> median & moving-average filter for completed period measurements
+//
+//
+// Author:	Rehan Iqbal
+// Organization: Portland State University
+//
+// Description:
+//
+// This hardware module filters the stream of completed periods from hw_detect.v
+// so that the Microblaze can read a clean value without buffering samples itself.
+// It has two stages in series:
+//
+//	1) a median of the last 3 or 5 samples ('median_sel' = 1 / 2, 0 = bypass),
+//	   which throws away single outliers without smearing real steps
+//	2) a moving average of the last 2^'avg_log2' medians ('avg_log2' = 0 bypasses
+//	   the stage), which lowers the noise of the reading
+//
+// Both stages always take one clock each, so 'filt_valid' follows 'sample_valid'
+// by two clocks no matter which stages are enabled. Until a stage has seen enough
+// samples to fill its window it passes its input through unchanged. Changing
+// either setting empties both windows.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+module hwdet_filter #(
+
+	/******************************************************************/
+	/* Parameter declarations						                  */
+	/******************************************************************/
+
+	parameter integer	AVG_LOG2_MAX = 4)			// longest moving average is 2^AVG_LOG2_MAX samples
+
+	/******************************************************************/
+	/* Port declarations							                  */
+	/******************************************************************/
+
+	(
+	input 						clock,			// 100MHz system clock
+	input 						reset,			// active-high synchronous reset
+
+	input 						sample_valid,	// 'sample' holds a new value
+	input		[31:0]			sample,			// value to filter
+	input		[1:0]			median_sel,		// 0 = bypass, 1 = median of 3, 2 = median of 5
+	input		[2:0]			avg_log2,		// moving average of 2^avg_log2 samples (0 = bypass)
+
+	output reg	[31:0]			filt_sample,	// filtered value
+	output reg 					filt_valid);	// one-cycle pulse when 'filt_sample' is updated
+
+	/******************************************************************/
+	/* Local parameters and values		                  	  		  */
+	/******************************************************************/
+
+	localparam integer	AVG_TAPS = (1 << AVG_LOG2_MAX);
+
+	reg			[31:0]			hist [0:4];		// last 5 samples, newest in hist[0]
+	reg			[2:0]			hist_fill;		// samples in 'hist' (saturates at 5)
+	reg			[2:0]			med_taps;		// 3 or 5
+	reg			[2:0]			rank;			// samples ordered before the candidate
+	reg			[31:0]			med_next;		// median including the new sample
+	reg 						med_valid;		// stage 1 output is valid
+	reg			[31:0]			med_sample;		// stage 1 output
+
+	reg			[31:0]			taps [0:AVG_TAPS-1];	// last medians, newest in taps[0]
+	reg			[AVG_LOG2_MAX:0]	taps_fill;	// medians in 'taps' (saturates at AVG_TAPS)
+	reg			[AVG_LOG2_MAX+31:0]	avg_sum;	// sum of the medians in the window
+	reg			[2:0]			avg_shift;		// avg_log2, at most AVG_LOG2_MAX
+	reg			[AVG_LOG2_MAX:0]	avg_taps;	// 2^avg_shift
+	reg			[AVG_LOG2_MAX+31:0]	sum_next;	// window sum after the new median
+
+	reg			[4:0]			last_config;	// settings the windows were filled with
+	wire						restart;		// settings changed --> empty both windows
+
+	integer 					i;
+	integer 					j;
+
+	assign restart = ({median_sel, avg_log2} != last_config);
+
+	/******************************************************************/
+	/* Median selection								                  */
+	/******************************************************************/
+
+	// the candidate with exactly (taps - 1) / 2 samples ordered before it is the
+	// median; ties are ordered by age so that every candidate has a unique rank
+
+	always@(*) begin
+
+		med_taps = (median_sel == 2'd2) ? 3'd5 : 3'd3;
+		med_next = sample;
+
+		for (i = 0; i < 5; i = i + 1) begin
+
+			rank = 3'd0;
+
+			for (j = 0; j < 5; j = j + 1) begin
+				if ((j != i) && (j < med_taps) &&
+					((cand(j) < cand(i)) || ((cand(j) == cand(i)) && (j < i)))) begin
+					rank = rank + 1'b1;
+				end
+			end
+
+			if ((i < med_taps) && (rank == (med_taps >> 1))) begin
+				med_next = cand(i);
+			end
+
+		end
+
+	end
+
+	// candidate i: the new sample is candidate 0, older samples follow
+
+	function [31:0] cand;
+		input integer k;
+		begin
+			cand = (k == 0) ? sample : hist[k-1];
+		end
+	endfunction
+
+	/******************************************************************/
+	/* Moving average sum							                  */
+	/******************************************************************/
+
+	always@(*) begin
+
+		avg_shift = (avg_log2 > AVG_LOG2_MAX) ? AVG_LOG2_MAX : avg_log2;
+		avg_taps = (1 << avg_shift);
+
+		if (taps_fill == avg_taps) begin
+			sum_next = avg_sum + med_sample - taps[avg_taps-1];		// oldest median leaves the window
+		end
+
+		else begin
+			sum_next = avg_sum + med_sample;
+		end
+
+	end
+
+	/******************************************************************/
+	/* Filter pipeline								                  */
+	/******************************************************************/
+
+	always@(posedge clock) begin
+
+		if (reset || restart) begin
+
+			for (i = 0; i < 5; i = i + 1) begin
+				hist[i] <= 32'b0;
+			end
+
+			for (i = 0; i < AVG_TAPS; i = i + 1) begin
+				taps[i] <= 32'b0;
+			end
+
+			hist_fill <= 3'b0;
+			taps_fill <= {(AVG_LOG2_MAX+1){1'b0}};
+			avg_sum <= {(AVG_LOG2_MAX+32){1'b0}};
+			med_valid <= 1'b0;
+			med_sample <= 32'b0;
+			filt_valid <= 1'b0;
+			last_config <= {median_sel, avg_log2};
+
+			if (reset) begin
+				filt_sample <= 32'b0;
+			end
+
+		end
+
+		else begin
+
+			// stage 1: median of the last 3 / 5 samples
+
+			med_valid <= sample_valid;
+
+			if (sample_valid) begin
+
+				for (i = 4; i > 0; i = i - 1) begin
+					hist[i] <= hist[i-1];
+				end
+
+				hist[0] <= sample;
+
+				if (hist_fill != 3'd5) begin
+					hist_fill <= hist_fill + 1'b1;
+				end
+
+				if ((median_sel == 2'd0) || ((hist_fill + 1'b1) < med_taps)) begin
+					med_sample <= sample;					// bypassed, or window not full yet
+				end
+
+				else begin
+					med_sample <= med_next;
+				end
+
+			end
+
+			// stage 2: moving average of the last 2^avg_log2 medians
+
+			filt_valid <= med_valid;
+
+			if (med_valid) begin
+
+				for (i = AVG_TAPS-1; i > 0; i = i - 1) begin
+					taps[i] <= taps[i-1];
+				end
+
+				taps[0] <= med_sample;
+				avg_sum <= sum_next;
+
+				if (taps_fill != avg_taps) begin
+					taps_fill <= taps_fill + 1'b1;
+				end
+
+				if ((avg_shift == 3'd0) || ((taps_fill + 1'b1) < avg_taps)) begin
+					filt_sample <= med_sample;				// bypassed, or window not full yet
+				end
+
+				else begin
+					filt_sample <= sum_next >> avg_shift;
+				end
+
+			end
+
+		end
+
+	end
+
+endmodule
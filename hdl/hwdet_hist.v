@@ -0,0 +1,182 @@
+// hwdet_hist.v --> block RAM histogram of completed period measurements
+//
+//
+// Author:	Rehan Iqbal
+// Organization: Portland State University
+//
+// Description:
+//
+// This hardware module counts how many samples fall into each of 2^ADDR_WIDTH
+// bins. Bin 0 starts at 'offset' and every bin is 2^'shift' clock cycles wide.
+// Samples below 'offset' are counted in the first bin and samples beyond the
+// last bin are counted in the last bin, so no sample is ever lost.
+//
+// The bins are kept in a simple dual-port block RAM. Each new sample goes through
+// a 3 clock read-modify-write pipeline, with forwarding so back-to-back samples
+// into the same bin are both counted. Software reads share the read port and are
+// served in every clock the pipeline does not need it; 'rd_data' follows
+// 'rd_addr' two clocks later when no samples are arriving.
+//
+// Pulsing 'clear' zeroes every bin, one bin per clock, while 'busy' is high.
+// Samples that arrive during a clear are ignored.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+module hwdet_hist #(
+
+	/******************************************************************/
+	/* Parameter declarations						                  */
+	/******************************************************************/
+
+	parameter integer	ADDR_WIDTH = 10)			// histogram has 2^ADDR_WIDTH bins
+
+	/******************************************************************/
+	/* Port declarations							                  */
+	/******************************************************************/
+
+	(
+	input 								clock,			// 100MHz system clock
+	input 								reset,			// active-high synchronous reset
+
+	input 								enable,			// count new samples
+	input 								sample_valid,	// 'sample' holds a new value
+	input		[31:0]					sample,			// value to count
+	input		[31:0]					offset,			// lower edge of bin 0
+	input		[4:0]					shift,			// bin width = 2^shift
+
+	input 								clear,			// zero every bin
+	output reg 							busy,			// clear in progress
+
+	input		[ADDR_WIDTH-1:0]		rd_addr,		// bin to read
+	output reg	[31:0]					rd_data);		// count of bin 'rd_addr'
+
+	/******************************************************************/
+	/* Local parameters and values		                  	  		  */
+	/******************************************************************/
+
+	localparam integer	BINS = (1 << ADDR_WIDTH);
+
+	reg			[31:0]					mem [0:BINS-1];	// block RAM storage
+
+	wire		[31:0]					above;			// sample - offset
+	wire		[31:0]					index;			// bin before clamping
+
+	reg 								v1;				// stage 1: bin computed
+	reg			[ADDR_WIDTH-1:0]		bin1;
+	reg 								v2;				// stage 2: bin count read
+	reg			[ADDR_WIDTH-1:0]		bin2;
+	reg 								v3;				// stage 3: bin count written
+	reg			[ADDR_WIDTH-1:0]		bin3;
+	reg			[31:0]					count3;
+	wire		[31:0]					count_next;		// new count for bin2
+
+	wire		[ADDR_WIDTH-1:0]		ram_addr;		// read port address
+	reg			[31:0]					ram_q;			// read port data
+
+	reg			[ADDR_WIDTH-1:0]		clr_addr;		// next bin to zero
+
+	assign above = sample - offset;
+	assign index = above >> shift;
+
+	// a new count is written in the same clock as the next sample's bin is read,
+	// so use the value kept in stage 3 when both samples are for the same bin
+
+	assign count_next = ((v3 && (bin3 == bin2)) ? count3 : ram_q) + 1'b1;
+
+	// the sample pipeline has priority on the read port
+
+	assign ram_addr = v1 ? bin1 : rd_addr;
+
+	/******************************************************************/
+	/* Block RAM ports								                  */
+	/******************************************************************/
+
+	always@(posedge clock) begin
+
+		if (busy) begin
+			mem[clr_addr] <= 32'b0;
+		end
+
+		else if (v2) begin
+			mem[bin2] <= count_next;
+		end
+
+		ram_q <= mem[ram_addr];
+
+	end
+
+	/******************************************************************/
+	/* Sample pipeline & clear sequencer			                  */
+	/******************************************************************/
+
+	always@(posedge clock) begin
+
+		if (reset) begin
+
+			v1 <= 1'b0;
+			bin1 <= {ADDR_WIDTH{1'b0}};
+			v2 <= 1'b0;
+			bin2 <= {ADDR_WIDTH{1'b0}};
+			v3 <= 1'b0;
+			bin3 <= {ADDR_WIDTH{1'b0}};
+			count3 <= 32'b0;
+			rd_data <= 32'b0;
+			clr_addr <= {ADDR_WIDTH{1'b0}};
+			busy <= 1'b1;							// start out with a clear histogram
+
+		end
+
+		else begin
+
+			// stage 1: work out the bin, clamped to the first & last bin
+
+			v1 <= sample_valid && enable && !busy && !clear;
+
+			if (sample < offset) begin
+				bin1 <= {ADDR_WIDTH{1'b0}};
+			end
+
+			else if (index >= BINS) begin
+				bin1 <= {ADDR_WIDTH{1'b1}};
+			end
+
+			else begin
+				bin1 <= index[ADDR_WIDTH-1:0];
+			end
+
+			// stage 2: bin count arrives & the new count is written;
+			// stage 3: the new count is kept for forwarding
+
+			v2 <= v1 && !clear;
+			bin2 <= bin1;
+
+			v3 <= v2 && !busy;
+			bin3 <= bin2;
+			count3 <= count_next;
+
+			if (!v2) begin
+				rd_data <= ram_q;					// read port was free for software last clock
+			end
+
+			// clear sequencer
+
+			if (clear && !busy) begin
+				busy <= 1'b1;
+				clr_addr <= {ADDR_WIDTH{1'b0}};
+			end
+
+			else if (busy) begin
+
+				clr_addr <= clr_addr + 1'b1;
+
+				if (clr_addr == {ADDR_WIDTH{1'b1}}) begin
+					busy <= 1'b0;					// last bin was zeroed this clock
+				end
+
+			end
+
+		end
+
+	end
+
+endmodule
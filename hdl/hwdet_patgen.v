@@ -0,0 +1,62 @@
+// hwdet_patgen.v --> programmable pulse generator for HWDET loopback testing
+//
+//
+// Author:	Rehan Iqbal
+// Organization: Portland State University
+//
+// Description:
+//
+// This hardware module generates a square wave that is 'high_len' clock cycles
+// high and 'low_len' clock cycles low. It is fed into hw_detect.v in place of
+// the external input so the whole measurement chain can be tested against a
+// known period and duty cycle without the light sensor attached.
+//
+// New lengths take effect at the next transition. Lengths of 0 are treated
+// as 1. While 'enable' is low the output is held low.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+module hwdet_patgen (
+
+	/******************************************************************/
+	/* Port declarations							                  */
+	/******************************************************************/
+
+	input 					clock,			// 100MHz system clock
+	input 					reset,			// active-high synchronous reset
+	input 					enable,			// run the generator
+
+	input		[31:0]		high_len,		// clock cycles the output is high
+	input		[31:0]		low_len,		// clock cycles the output is low
+
+	output reg				pwm);			// generated square wave
+
+	/******************************************************************/
+	/* Local parameters and values		                  	  		  */
+	/******************************************************************/
+
+	reg			[31:0]		count;			// clock cycles left in the current level
+
+	/******************************************************************/
+	/* Square wave generator						                  */
+	/******************************************************************/
+
+	always@(posedge clock) begin
+
+		if (reset || !enable) begin
+			pwm <= 1'b0;
+			count <= 32'b0;
+		end
+
+		else if (count <= 32'd1) begin		// current level is done --> toggle the output
+			pwm <= !pwm;
+			count <= pwm ? low_len : high_len;
+		end
+
+		else begin
+			count <= count - 1'b1;
+		end
+
+	end
+
+endmodule
@@ -0,0 +1,163 @@
+// hwdet_stats.v --> windowed period statistics (min / max / sum / sum of squares)
+//
+//
+// Author:	Rehan Iqbal
+// Organization: Portland State University
+//
+// Description:
+//
+// This hardware module accumulates the minimum, maximum, sum and sum of squares
+// of every sample it is given. After 'window' samples (or when 'latch' is pulsed)
+// the accumulators are copied to the output registers and cleared in the same
+// clock, so no sample is ever lost or counted twice between two windows.
+// With 'window' = 0 the results are only published when 'latch' is pulsed.
+//
+// The square is computed in a pipeline stage of its own so that the multiplier
+// maps onto the DSP slices, which delays every sample by two clocks. The 64-bit
+// sum of squares wraps around once count * max^2 reaches 2^64.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+module hwdet_stats (
+
+	/******************************************************************/
+	/* Port declarations							                  */
+	/******************************************************************/
+
+	input 						clock,			// 100MHz system clock
+	input 						reset,			// active-high synchronous reset
+
+	input 						sample_valid,	// 'sample' holds a new value
+	input		[31:0]			sample,			// value to accumulate
+	input		[31:0]			window,			// samples per window (0 = only on 'latch')
+	input 						latch,			// publish & clear the accumulators now
+
+	output reg	[31:0]			count,			// samples in the last window
+	output reg	[31:0]			min,			// smallest sample (0xFFFFFFFF if count = 0)
+	output reg	[31:0]			max,			// largest sample
+	output reg	[63:0]			sum,			// sum of the samples
+	output reg	[63:0]			sumsq,			// sum of the squared samples
+	output reg	[31:0]			seq,			// increments once per published window
+	output reg 					done);			// one-cycle pulse when the outputs are updated
+
+	/******************************************************************/
+	/* Local parameters and values		                  	  		  */
+	/******************************************************************/
+
+	reg 						a_valid;		// pipeline stage A: registered input
+	reg			[31:0]			a_sample;
+	reg 						b_valid;		// pipeline stage B: sample & its square
+	reg			[31:0]			b_sample;
+	reg			[63:0]			b_square;
+
+	reg			[31:0]			acc_count;		// accumulators for the window in progress
+	reg			[31:0]			acc_min;
+	reg			[31:0]			acc_max;
+	reg			[63:0]			acc_sum;
+	reg			[63:0]			acc_sumsq;
+
+	reg			[31:0]			n_count;		// accumulators including the sample in stage B
+	reg			[31:0]			n_min;
+	reg			[31:0]			n_max;
+	reg			[63:0]			n_sum;
+	reg			[63:0]			n_sumsq;
+
+	wire						close;			// publish & clear this clock
+
+	assign close = latch || (b_valid && (window != 32'b0) && (n_count >= window));
+
+	/******************************************************************/
+	/* Next accumulator values						                  */
+	/******************************************************************/
+
+	always@(*) begin
+
+		n_count = acc_count;
+		n_min = acc_min;
+		n_max = acc_max;
+		n_sum = acc_sum;
+		n_sumsq = acc_sumsq;
+
+		if (b_valid) begin
+			n_count = acc_count + 1'b1;
+			n_min = (b_sample < acc_min) ? b_sample : acc_min;
+			n_max = (b_sample > acc_max) ? b_sample : acc_max;
+			n_sum = acc_sum + b_sample;
+			n_sumsq = acc_sumsq + b_square;
+		end
+
+	end
+
+	/******************************************************************/
+	/* Pipeline, accumulate & publish				                  */
+	/******************************************************************/
+
+	always@(posedge clock) begin
+
+		if (reset) begin
+
+			a_valid <= 1'b0;
+			a_sample <= 32'b0;
+			b_valid <= 1'b0;
+			b_sample <= 32'b0;
+			b_square <= 64'b0;
+
+			acc_count <= 32'b0;
+			acc_min <= 32'hFFFFFFFF;
+			acc_max <= 32'b0;
+			acc_sum <= 64'b0;
+			acc_sumsq <= 64'b0;
+
+			count <= 32'b0;
+			min <= 32'hFFFFFFFF;
+			max <= 32'b0;
+			sum <= 64'b0;
+			sumsq <= 64'b0;
+			seq <= 32'b0;
+			done <= 1'b0;
+
+		end
+
+		else begin
+
+			a_valid <= sample_valid;
+			a_sample <= sample;
+
+			b_valid <= a_valid;
+			b_sample <= a_sample;
+			b_square <= a_sample * a_sample;
+
+			done <= close;
+
+			if (close) begin					// window is complete --> publish it...
+
+				count <= n_count;
+				min <= n_min;
+				max <= n_max;
+				sum <= n_sum;
+				sumsq <= n_sumsq;
+				seq <= seq + 1'b1;
+
+				acc_count <= 32'b0;				// ...and start the next one in the same clock
+				acc_min <= 32'hFFFFFFFF;
+				acc_max <= 32'b0;
+				acc_sum <= 64'b0;
+				acc_sumsq <= 64'b0;
+
+			end
+
+			else begin
+
+				acc_count <= n_count;
+				acc_min <= n_min;
+				acc_max <= n_max;
+				acc_sum <= n_sum;
+				acc_sumsq <= n_sumsq;
+
+			end
+
+		end
+
+	end
+
+endmodule
@@ -0,0 +1,352 @@
+// hwdet_stream.v --> AXI4-Stream record output for DMA capture into a DDR ring buffer
+//
+//
+// Author:	Rehan Iqbal
+// Organization: Portland State University
+//
+// Description:
+//
+// This hardware module sends every complete period of one channel out of an
+// AXI4-Stream master port as a 16-byte record, so an AXI DMA (S2MM) can write
+// the periods straight into a ring buffer in DDR with no CPU copying. Each
+// record is four 32-bit beats:
+//
+//		beat 0		rising edge timestamp [31:0]	(cycle counter at the end of the period)
+//		beat 1		rising edge timestamp [63:32]
+//		beat 2		'high' interval in clock cycles
+//		beat 3		'low' interval in clock cycles
+//
+// TLAST is set on the last beat of every 'block_len' records, so the DMA can be
+// run in cyclic scatter-gather mode with one descriptor per block. The ring size
+// must be a whole number of blocks, and at least two: with the one free slot below,
+// the last record of a one-block ring is never sent, so its block never completes.
+//
+// The module keeps the ring's head (next record the DMA will write) while software
+// writes the tail (next record it will read). One slot is always left free, so
+// head == tail means the ring is empty and the ring holds at most ring_size - 1
+// records. A period that arrives while the ring is full, or while the previous
+// record is still being sent, is dropped and counted instead.
+//
+// The head moves when the DMA accepts the last beat of a record, which can be
+// before the record has reached DDR. Software only reads the records of blocks
+// the DMA has marked complete in their descriptors.
+//
+// Emptying the ring rewinds the head to slot 0, so it must only be done with the
+// DMA reset and about to be restarted at its first descriptor. A record that is
+// being sent is always finished first: the clear waits for it, and 'busy' reads
+// as 1 until both are done, so software can tell when it is safe to reset the DMA.
+//
+// The registers of this bank are:
+//
+//		slv_reg0		(stream_ctrl) [0] enable, [6:4] channel whose periods are sent (read/write);
+//						writing 1 to [1] empties the ring and clears the counters;
+//						[8] busy: a record is being sent or a clear is waiting (read-only)
+//		slv_reg1		(ring_size) ring buffer size in records (read/write)
+//		slv_reg2		(block_len) records per DMA block, TLAST after each block (read/write, 0 = 1)
+//		slv_reg3		(head) ring index of the next record to be sent (read-only)
+//		slv_reg4		(tail) ring index of the next record software will read (read/write)
+//		slv_reg5		(level) records in the ring that software has not read (read-only)
+//		slv_reg6		(dropped) periods dropped because the ring was full (read-only, any write clears)
+//		slv_reg7		(records) records sent since the last clear (read-only)
+//		slv_reg8		(irq_enable) [0] ring half full, [1] ring full (read/write)
+//		slv_reg9		(irq_status) same bits as irq_enable, write 1 to clear
+//		slv_reg10-63	*RESERVED* (read as 0)
+//
+// The 'irq' output is active-high and stays asserted while (irq_status & irq_enable) != 0.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+module hwdet_stream (
+
+	/******************************************************************/
+	/* Port declarations							                  */
+	/******************************************************************/
+
+	input 								clock,			// 100MHz system clock
+	input 								reset,			// active-high synchronous reset
+
+	input 								wr_en,			// register write strobe for this bank
+	input		[5:0]					wr_addr,		// register being written
+	input		[31:0]					wr_data,		// write data
+	input		[3:0]					wr_strb,		// byte enables for 'wr_data'
+
+	input 								rd_en,			// register read strobe for this bank
+	input		[5:0]					rd_addr,		// register being read
+	output reg	[31:0]					rd_data,		// contents of register 'rd_addr'
+
+	output		[2:0]					source,			// channel whose periods are sent
+	input 								rec_valid,		// selected channel latched a new period
+	input		[63:0]					rec_ts,			// timestamp of the rising edge ending the period
+	input		[31:0]					rec_high,		// 'high' interval of the period
+	input		[31:0]					rec_low,		// 'low' interval of the period
+
+	output 								m_axis_tvalid,	// AXI4-Stream master: beat is valid
+	output		[31:0]					m_axis_tdata,	// AXI4-Stream master: beat data
+	output		[3:0]					m_axis_tstrb,	// AXI4-Stream master: byte enables (always all)
+	output 								m_axis_tlast,	// AXI4-Stream master: last beat of a block
+	input 								m_axis_tready,	// AXI4-Stream master: DMA accepts the beat
+
+	output reg 							irq);			// level-sensitive interrupt request (active-high)
+
+	/******************************************************************/
+	/* Local parameters and values		                  	  		  */
+	/******************************************************************/
+
+	reg			[31:0]					slv_reg0;
+	reg			[31:0]					slv_reg1;
+	reg			[31:0]					slv_reg2;
+	reg			[31:0]					slv_reg4;
+	reg			[31:0]					slv_reg8;
+	integer	 							byte_index;
+
+	wire								enable;
+	wire								ring_clear;
+	wire								do_clear;
+	reg									clear_pending;
+	wire			[31:0]					ring_size;
+	wire			[31:0]					block_len;
+	wire			[31:0]					tail;
+	wire			[31:0]					level;
+	wire								ring_full;
+
+	reg			[31:0]					head;
+	reg			[31:0]					dropped;
+	reg			[31:0]					records;
+	reg			[31:0]					block_count;
+
+	reg									busy;
+	reg			[1:0]					beat;
+	reg			[127:0]					record;
+	wire								beat_done;
+	wire								record_done;
+	wire								accept;
+	wire			[31:0]					head_next;
+	wire			[31:0]					level_next;
+
+	reg			[1:0]					irq_status;
+	wire			[1:0]					irq_events;
+	wire			[1:0]					irq_clear;
+
+	/******************************************************************/
+	/* Register writes								                  */
+	/******************************************************************/
+
+	always @( posedge clock )
+	begin
+	  if ( reset )
+	    begin
+	      slv_reg0 <= 0;
+	      slv_reg1 <= 0;
+	      slv_reg2 <= 0;
+	      slv_reg4 <= 0;
+	      slv_reg8 <= 0;
+	    end
+	  else begin
+	    if (wr_en)
+	      begin
+	        case ( wr_addr )
+	          6'h00:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes
+	                // Slave register 0
+	                slv_reg0[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end
+	          6'h01:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes
+	                // Slave register 1
+	                slv_reg1[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end
+	          6'h02:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes
+	                // Slave register 2
+	                slv_reg2[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end
+	          6'h04:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes
+	                // Slave register 4
+	                slv_reg4[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end
+	          6'h08:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes
+	                // Slave register 8
+	                slv_reg8[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end
+	          default : begin
+	                      // all other slave registers are read-only; writes are ignored
+	                      slv_reg0 <= slv_reg0;
+	                      slv_reg1 <= slv_reg1;
+	                      slv_reg2 <= slv_reg2;
+	                      slv_reg4 <= slv_reg4;
+	                      slv_reg8 <= slv_reg8;
+	                    end
+	        endcase
+	      end
+
+	    // emptying the ring moves the tail back to slot 0 along with the head
+
+	    if (do_clear)
+	      slv_reg4 <= 0;
+
+	  end
+	end
+
+	/******************************************************************/
+	/* Register reads								                  */
+	/******************************************************************/
+
+	always @(*)
+	begin
+	      // Address decoding for reading registers
+	      case ( rd_addr )
+	        6'h00   : rd_data <= {23'b0, busy | clear_pending, 1'b0, slv_reg0[6:4], 3'b0, slv_reg0[0]};
+	        6'h01   : rd_data <= slv_reg1;
+	        6'h02   : rd_data <= slv_reg2;
+	        6'h03   : rd_data <= head;
+	        6'h04   : rd_data <= slv_reg4;
+	        6'h05   : rd_data <= level;
+	        6'h06   : rd_data <= dropped;
+	        6'h07   : rd_data <= records;
+	        6'h08   : rd_data <= {30'b0, slv_reg8[1:0]};
+	        6'h09   : rd_data <= {30'b0, irq_status};
+	        default : rd_data <= 0;
+	      endcase
+	end
+
+	/******************************************************************/
+	/* Record stream								                  */
+	/******************************************************************/
+
+    assign enable     = slv_reg0[0];
+    assign source     = slv_reg0[6:4];
+    assign ring_size  = slv_reg1;
+    assign block_len  = (slv_reg2 == 0) ? 1 : slv_reg2;
+    assign tail       = slv_reg4;
+
+    // writing 1 to slv_reg0[1] empties the ring; the bit itself is not stored.
+    // The clear is held off until the record in flight is out, so that record
+    // cannot move the head after the clear
+
+    assign ring_clear = wr_en && (wr_addr == 6'h00) && wr_strb[0] && wr_data[1];
+    assign do_clear   = (ring_clear || clear_pending) && !busy;
+
+    // one slot is always left free so that head == tail means empty
+
+    assign level      = (head >= tail) ? (head - tail) : (head + ring_size - tail);
+    assign ring_full  = (ring_size < 2) || (level >= ring_size - 1);
+
+    // a new period is taken only if the last record is out and there is room for it
+
+    assign accept     = rec_valid && enable && !busy && !ring_full;
+
+    assign beat_done   = m_axis_tvalid && m_axis_tready;
+    assign record_done = beat_done && (beat == 2'd3);
+    assign head_next   = (head + 1 >= ring_size) ? 0 : head + 1;
+    assign level_next  = (head_next >= tail) ? (head_next - tail) : (head_next + ring_size - tail);
+
+    assign m_axis_tvalid = busy;
+    assign m_axis_tdata  = record[(beat*32) +: 32];
+    assign m_axis_tstrb  = 4'hF;
+    assign m_axis_tlast  = (beat == 2'd3) && (block_count + 1 >= block_len);
+
+    always @( posedge clock )
+    begin
+      if ( reset )
+        begin
+          busy        <= 1'b0;
+          clear_pending <= 1'b0;
+          beat        <= 2'd0;
+          record      <= 128'b0;
+          head        <= 0;
+          records     <= 0;
+          block_count <= 0;
+        end
+      else
+        begin
+
+          // the beat in flight is always finished, so the stream never breaks
+          // the AXI4-Stream rules even if the ring is emptied or disabled
+
+          if (accept)
+            begin
+              busy   <= 1'b1;
+              beat   <= 2'd0;
+              record <= {rec_low, rec_high, rec_ts};
+            end
+          else if (beat_done)
+            begin
+              beat <= beat + 1'b1;
+
+              if (record_done)
+                busy <= 1'b0;
+            end
+
+          clear_pending <= (ring_clear || clear_pending) && busy;
+
+          if (do_clear)
+            begin
+              head        <= 0;
+              records     <= 0;
+              block_count <= 0;
+            end
+          else if (record_done)
+            begin
+              head        <= head_next;
+              records     <= records + 1;
+              block_count <= m_axis_tlast ? 0 : block_count + 1;
+            end
+
+        end
+    end
+
+    // periods lost because the ring was full or the last record was still
+    // being sent; any write to slv_reg6 clears the count
+
+    always @( posedge clock )
+    begin
+      if ( reset || do_clear || (wr_en && (wr_addr == 6'h06)) )
+        begin
+          dropped <= 0;
+        end
+      else if (rec_valid && enable && !accept)
+        begin
+          dropped <= dropped + 1;
+        end
+    end
+
+	/******************************************************************/
+	/* Interrupt logic								                  */
+	/******************************************************************/
+
+    // events are flagged when a record lands in the ring and brings the level
+    // to exactly half the ring, or fills the ring
+
+    assign irq_events = {record_done && (level_next == ring_size - 1),
+                         record_done && (level_next == (ring_size >> 1))};
+
+    assign irq_clear = (wr_en && (wr_addr == 6'h09))
+                       ? wr_data[1:0] : 2'b0;
+
+    always @( posedge clock )
+    begin
+      if ( reset )
+        begin
+          irq_status <= 2'b0;
+          irq        <= 1'b0;
+        end
+      else
+        begin
+          irq_status <= (irq_status & ~irq_clear) | irq_events;    // new events win over a clear
+          irq        <= |(irq_status & slv_reg8[1:0]);
+        end
+    end
+
+endmodule
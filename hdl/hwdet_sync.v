@@ -0,0 +1,165 @@
+// hwdet_sync.v --> sensor edge counter gated by whole periods of the PWM carrier
+//
+//
+// Author:	Rehan Iqbal
+// Organization: Portland State University
+//
+// Description:
+//
+// This hardware module measures the input over windows that are locked to the
+// PWM carrier driving the LED. 'trig' is the carrier itself (the AXI timer's
+// pwm0 output); a window opens on one of its rising edges and closes exactly
+// 'carrier_periods' rising edges later, and the next window opens on that same
+// edge. Every window therefore spans a whole number of carrier periods, so the
+// light ripple at the carrier frequency averages out of the result instead of
+// aliasing into it.
+//
+// For each window the module publishes:
+//
+//		sync_edges		rising edges of the input seen inside the window
+//		sync_clocks		length of the window in clock cycles
+//		sync_span		clock cycles from the first to the last of those edges
+//
+// Frequency = CLK_FREQUENCY_HZ * sync_edges / sync_clocks counts every edge but
+// is limited to +/- 1 edge per window. With two or more edges,
+// CLK_FREQUENCY_HZ * (sync_edges - 1) / sync_span measures whole input periods
+// to one clock, like the reciprocal counter, and leaves less than one input
+// period of the window unused.
+//
+// The rising edges are taken from the free-running 'edge_count' of hw_detect.v,
+// so they have already been through the synchronizer and the deglitch filter.
+// An edge in the same clock as the closing carrier edge belongs to the next
+// window. With 'carrier_periods' = 0 the module is idle and its last results
+// are kept.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+module hwdet_sync (
+
+	/******************************************************************/
+	/* Port declarations							                  */
+	/******************************************************************/
+
+	input 						clock,			// 100MHz system clock
+	input 						reset,			// active-high synchronous reset
+
+	input 						trig,			// PWM carrier (synchronous to 'clock')
+	input		[15:0]			carrier_periods,	// carrier periods per window (0 = off)
+	input		[31:0]			edge_count,		// free-running count of input rising edges
+
+	output reg	[31:0]			sync_edges,		// input rising edges in the last window
+	output reg	[31:0]			sync_clocks,	// clock cycles in the last window
+	output reg	[31:0]			sync_span,		// clock cycles from its first to its last edge
+	output reg	[31:0]			sync_seq,		// increments once per window
+	output reg 					sync_valid);	// one-cycle pulse when a window closes
+
+	/******************************************************************/
+	/* Local parameters and values		                  	  		  */
+	/******************************************************************/
+
+	reg 						prev_trig;		// previous state of 'trig'; used to detect rising edges
+	reg			[31:0]			prev_edges;		// 'edge_count' last clock
+	wire						trig_rise;		// carrier rising edge this clock
+	wire						input_rise;		// input rising edge this clock
+
+	reg 						running;		// a window is open
+	reg			[15:0]			carriers;		// carrier periods since the window opened
+	reg			[31:0]			elapsed;		// clock cycles since the window opened
+	reg			[31:0]			edges;			// input rising edges since the window opened
+	reg			[31:0]			first_at;		// 'elapsed' at the first of those edges
+	reg			[31:0]			last_at;		// 'elapsed' at the last of those edges
+	wire						close;			// the window closes this clock
+
+	assign trig_rise = trig && !prev_trig;
+	assign input_rise = (edge_count != prev_edges);
+
+	assign close = trig_rise && running && ({16'b0, carriers} + 1'b1 >= {16'b0, carrier_periods});
+
+	/******************************************************************/
+	/* Edge detection								                  */
+	/******************************************************************/
+
+	always@(posedge clock) begin
+
+		if (reset) begin
+			prev_trig <= 1'b0;
+			prev_edges <= 32'b0;
+		end
+
+		else begin
+			prev_trig <= trig;
+			prev_edges <= edge_count;
+		end
+
+	end
+
+	/******************************************************************/
+	/* Carrier-locked windows						                  */
+	/******************************************************************/
+
+	always@(posedge clock) begin
+
+		if (reset || (carrier_periods == 16'b0)) begin 		// counter is idle while the mode is off
+
+			running <= 1'b0;
+			carriers <= 16'b0;
+			elapsed <= 32'b0;
+			edges <= 32'b0;
+			first_at <= 32'b0;
+			last_at <= 32'b0;
+			sync_valid <= 1'b0;
+
+			if (reset) begin
+				sync_edges <= 32'b0;
+				sync_clocks <= 32'b0;
+				sync_span <= 32'b0;
+				sync_seq <= 32'b0;
+			end
+
+		end
+
+		else begin
+
+			sync_valid <= 1'b0;
+
+			if (close) begin
+				sync_edges <= edges;						// last carrier period is over --> publish the window
+				sync_clocks <= elapsed;
+				sync_span <= (edges > 32'd1) ? (last_at - first_at) : 32'b0;
+				sync_seq <= sync_seq + 1'b1;
+				sync_valid <= 1'b1;
+			end
+
+			if (trig_rise && (close || !running)) begin		// open the next window on this carrier edge
+				running <= 1'b1;
+				carriers <= 16'b0;
+				elapsed <= 32'd1;
+				edges <= input_rise ? 32'd1 : 32'b0;
+				first_at <= 32'b0;
+				last_at <= 32'b0;
+			end
+
+			else if (running) begin
+
+				elapsed <= elapsed + 1'b1;
+
+				if (trig_rise) begin
+					carriers <= carriers + 1'b1;
+				end
+
+				if (input_rise) begin
+					edges <= edges + 1'b1;
+					last_at <= elapsed;
+
+					if (edges == 32'b0) begin
+						first_at <= elapsed;
+					end
+				end
+
+			end
+
+		end
+
+	end
+
+endmodule
@@ -15,6 +15,8 @@
 //
 // The module assumes that a PmodCLP is plugged into the JA and JB ports,
 // and that a PmodENC is plugged into the JD (bottom row).  
+// JC[3:10] carry the complementary outputs of three interleaved PWM phases
+// for driving the half bridges of a DC-DC converter.
 //
 //////////////////////////////////////////////////////////////////////
 
@@ -66,6 +68,8 @@ module n4fpga (
 
     input               pwm_in,                 // input signal from light sensor
     output              pwm_out,                // output signal going to transistor base
+    output  [2:0]       phase_h,                // PWMGEN high-side switch of each converter phase
+    output  [2:0]       phase_l,                // PWMGEN low-side switch of each converter phase
 
 	input	[7:0]		JD);                    // PmodENC signals
 
@@ -98,6 +102,15 @@ module n4fpga (
     wire	[7:0]	    gpio_in;				// GPIO input port for EMBSYS
     wire	[7:0]	    gpio_out;				// GPIO output port for EMBSYS
 
+    // PWM sources for the LED: the AXI timer or the PWMGEN peripheral (software
+    // control loop) or the closed-loop controller inside HWDET (hardware control loop)
+
+    wire                timer_pwm;              // AXI timer's PWM output
+    wire                gen_pwm;                // PWMGEN's PWM output
+    wire                gen_active;             // PWMGEN is enabled and owns the LED
+    wire                ctl_pwm;                // HWDET controller's PWM output
+    wire                ctl_active;             // HWDET controller is enabled and owns the LED
+
     // signals for 3-stage synchronizer
 
     reg                sync_reg1;
@@ -142,6 +155,16 @@ module n4fpga (
 
     assign gpio_in = {7'b0000000, pwm_out};
 
+    // the HWDET controller takes over the LED while it is enabled, then PWMGEN
+    // (glitch-free duty updates), and the AXI timer drives it otherwise
+
+    assign pwm_out = ctl_active ? ctl_pwm : (gen_active ? gen_pwm : timer_pwm);
+
+    // pwm_out also goes back into HWDET as 'pwm_trig', so the sensor can be measured over
+    // a whole number of PWM periods. Both of its sources run on sysclk (HWDET synchronizes
+    // it itself when it is built with a separate measurement clock), so unlike the sensor
+    // input it needs no synchronizer here
+
     /******************************************************************/
     /* 3-stage synchronizer                                           */
     /******************************************************************/    
@@ -223,7 +246,14 @@ module n4fpga (
         
         // Connections with AXI Timer
 
-        .pwm0                       (pwm_out),         	// O [ 0 ] AXI Timer's PWM output signal
+        .pwm0                       (timer_pwm),       	// O [ 0 ] AXI Timer's PWM output signal
+        .pwmgen_out                 (gen_pwm),          // O [ 0 ] PWMGEN's PWM output signal
+        .pwmgen_active              (gen_active),       // O [ 0 ] PWMGEN is enabled
+        .pwmgen_h                   (phase_h),          // O [2:0] PWMGEN high-side switches (NUM_PHASES = 3)
+        .pwmgen_l                   (phase_l),          // O [2:0] PWMGEN low-side switches (NUM_PHASES = 3)
+        .ctl_pwm                    (ctl_pwm),          // O [ 0 ] HWDET closed-loop controller's PWM output
+        .ctl_active                 (ctl_active),       // O [ 0 ] HWDET closed-loop controller is enabled
+		.pwm_trig 					(pwm_out),			// I [ 0 ] HWDET module's carrier trigger (same PWM, already on sysclk)
 		.pwm_in 					(HWDET_in));	    // I [ 0 ] HWDET module's PWM input
 
 endmodule
\ No newline at end of file
@@ -0,0 +1,413 @@
+// pwmgen.v --> PWM generator with double-buffered period & compare registers
+//
+//
+// Author:	Rehan Iqbal
+// Organization: Portland State University
+//
+// Description:
+//
+// This hardware module generates the PWM that drives the LED. Unlike the AXI
+// timer in PWM mode, its period and compare (high time) registers are double-
+// buffered: software writes the shadow copies, and the counter copies them into
+// the active registers only when it wraps at the end of a period. Changing the
+// duty cycle is therefore a single register write that never restarts or cuts
+// short a period, so the output does not glitch.
+//
+// Writing COMPARE arms the update; writing PERIOD disarms it until COMPARE is
+// written again. A period and compare written in that order are always applied
+// together, even if a period boundary falls between the two writes. A write in
+// the same clock as the boundary counts for the next boundary.
+//
+// While the generator is disabled its output is low, the counter is held at 0 and
+// the shadow registers are copied straight through, so the first period after
+// enabling already uses them. The output is high for the first 'compare' clocks
+// of every period of 'period' clocks: compare = 0 is 0% and compare >= period is
+// 100%. A period of less than 2 clocks turns the output off.
+//
+// With dithering on, COMPARE_FRAC adds a fraction of a clock (in 1/65536ths) to
+// the high time. A first-order sigma-delta accumulator adds COMPARE_FRAC once per
+// period and stretches the high time by one clock whenever it overflows, so the
+// high time averaged over 65536 periods is compare + compare_frac / 65536 clocks:
+// 16 more bits of duty cycle resolution than the clock alone gives. What is left
+// of the fraction after each period is carried into the next, so the average
+// never drifts.
+// Writing COMPARE_FRAC disarms the update like PERIOD, so it has to be written
+// before COMPARE.
+//
+// The generator has NUM_PHASES interleaved phases that share the period counter
+// (pwmgen_phase.v). Each phase has its own offset and compare registers; phase 0
+// uses COMPARE (and the dither) for its high time and drives 'pwm'. Every phase
+// also drives a complementary pair 'pwm_h' / 'pwm_l' with DEAD_TIME clocks of
+// dead time for a half bridge. Writing a phase register disarms the update like
+// PERIOD, so writing every phase first and COMPARE last copies all phases at the
+// same counter wrap. Each phase then applies its new values at the start of its
+// own period, which is 'offset' clocks after the wrap, so a phase's pulse is never
+// changed half way through. A phase whose offset changes stays low until the
+// counter reaches its new start: one low time is stretched, no pulse is cut short.
+// DEAD_TIME is not double-buffered; it takes effect at the next transition.
+//
+// The registers are:
+//
+//		slv_reg0		(ctrl) [0] enable, [1] dither (read/write)
+//		slv_reg1		(period) PWM period in clock cycles, shadow copy (read/write)
+//		slv_reg2		(compare) high time in clock cycles, shadow copy; writing arms the update (read/write)
+//		slv_reg3		(status) [0] update armed, waiting for the end of the period (read-only)
+//		slv_reg4		(active_period) period in use (read-only)
+//		slv_reg5		(active_compare) high time in use (read-only)
+//		slv_reg6		(count) clock cycles into the current period (read-only)
+//		slv_reg7		(periods) whole periods generated since enabled (read-only)
+//		slv_reg8		(loads) shadow registers applied since enabled (read-only)
+//		slv_reg9		(clk_freq) CLK_FREQUENCY_HZ, the clock the counter runs on (read-only)
+//		slv_reg10		(compare_frac) [15:0] fraction of a clock added to the high time, shadow copy (read/write)
+//		slv_reg11		(dead_time) [15:0] dead time of the complementary outputs in clock cycles (read/write)
+//		slv_reg12		(num_phases) NUM_PHASES (read-only)
+//		slv_reg13-15	*RESERVED* (read as 0)
+//		slv_reg16-23	(phase_offset) start of phase 0 - 7's period in clocks after the counter wraps,
+//						shadow copies (read/write)
+//		slv_reg24		*RESERVED* (phase 0's high time is COMPARE)
+//		slv_reg25-31	(phase_compare) high time of phase 1 - 7 in clock cycles, shadow copies (read/write)
+//
+// Phase registers of phases >= NUM_PHASES read as 0 and ignore writes.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+module pwmgen #(
+
+	parameter integer 	CLK_FREQUENCY_HZ = 100000000,
+	parameter integer 	NUM_PHASES = 1)				// number of interleaved phases (1 - 8)
+
+	(
+
+	/******************************************************************/
+	/* Port declarations							                  */
+	/******************************************************************/
+
+	input 								clock,			// 100MHz system clock
+	input 								reset,			// active-high synchronous reset
+
+	input 								wr_en,			// register write strobe
+	input		[4:0]					wr_addr,		// register being written
+	input		[31:0]					wr_data,		// write data
+	input		[3:0]					wr_strb,		// byte enables for 'wr_data'
+
+	input		[4:0]					rd_addr,		// register being read
+	output reg	[31:0]					rd_data,		// contents of register 'rd_addr'
+
+	output 								pwm,			// PWM output (phase 0)
+	output		[NUM_PHASES-1:0]		pwm_h,			// high-side switch of each phase (with dead time)
+	output		[NUM_PHASES-1:0]		pwm_l,			// low-side switch of each phase (with dead time)
+	output 								active);		// generator is enabled
+
+	/******************************************************************/
+	/* Local parameters and values		                  	  		  */
+	/******************************************************************/
+
+	reg			[31:0]					slv_reg0;
+	reg			[31:0]					slv_reg1;
+	reg			[31:0]					slv_reg2;
+	reg			[31:0]					slv_reg10;
+	reg			[31:0]					slv_reg11;
+	reg			[31:0]					phase_offset [0:7];
+	reg			[31:0]					phase_compare [0:7];	// [0] is not used
+	wire								phase_wr;		// a phase register is written this clock
+	wire								phase_rd;		// a phase register is read
+	integer	 							byte_index;
+	integer	 							phase_index;
+
+	wire								enable;
+	wire								dither;
+	wire								arm;			// COMPARE is written this clock
+	wire								disarm;			// PERIOD, COMPARE_FRAC or a phase register is written this clock
+	wire								wrap;			// last clock of the current period
+	wire								load;			// shadow registers are copied this clock
+	wire		[NUM_PHASES-1:0]		phase_pwm;		// PWM of each phase
+
+	reg									pending;		// shadow registers wait for the end of the period
+	reg			[31:0]					active_period;
+	reg			[31:0]					active_compare;
+	reg			[15:0]					active_frac;
+	reg			[15:0]					dither_acc;		// sigma-delta accumulator, fraction of a clock
+	reg			[31:0]					high_time;		// high time of the current period, dither included
+	reg			[31:0]					count;
+	reg			[31:0]					periods;
+	reg			[31:0]					loads;
+
+	reg			[31:0]					n_count;		// values for the next clock
+	reg			[31:0]					n_period;
+	reg			[31:0]					n_compare;
+	reg			[15:0]					n_frac;
+	reg			[16:0]					n_acc;			// [16] is the carry into the high time
+	reg			[31:0]					n_high;
+
+	/******************************************************************/
+	/* Register writes								                  */
+	/******************************************************************/
+
+	always @( posedge clock )
+	begin
+	  if ( reset )
+	    begin
+	      slv_reg0 <= 0;
+	      slv_reg1 <= 0;
+	      slv_reg2 <= 0;
+	      slv_reg10 <= 0;
+	      slv_reg11 <= 0;
+
+	      for ( phase_index = 0; phase_index <= 7; phase_index = phase_index+1 )
+	        begin
+	          phase_offset[phase_index] <= 0;
+	          phase_compare[phase_index] <= 0;
+	        end
+	    end
+	  else begin
+	    if (wr_en)
+	      begin
+	        case ( wr_addr )
+	          5'h00:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes
+	                // Slave register 0
+	                slv_reg0[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end
+	          5'h01:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes
+	                // Slave register 1
+	                slv_reg1[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end
+	          5'h02:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes
+	                // Slave register 2
+	                slv_reg2[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end
+	          5'h0A:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes
+	                // Slave register 10
+	                slv_reg10[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end
+	          5'h0B:
+	            for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	              if ( wr_strb[byte_index] == 1 ) begin
+	                // Respective byte enables are asserted as per write strobes
+	                // Slave register 11
+	                slv_reg11[(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	              end
+	          default : begin
+	                      // all other slave registers are read-only; writes are ignored
+	                      slv_reg0 <= slv_reg0;
+	                      slv_reg1 <= slv_reg1;
+	                      slv_reg2 <= slv_reg2;
+	                      slv_reg10 <= slv_reg10;
+	                      slv_reg11 <= slv_reg11;
+	                    end
+	        endcase
+	      end
+
+	    // phase offsets (slave registers 16 - 23) and compares (slave registers 25 - 31)
+
+	    if (phase_wr)
+	      for ( byte_index = 0; byte_index <= 3; byte_index = byte_index+1 )
+	        if ( wr_strb[byte_index] == 1 ) begin
+	          if (wr_addr[3])
+	            phase_compare[wr_addr[2:0]][(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	          else
+	            phase_offset[wr_addr[2:0]][(byte_index*8) +: 8] <= wr_data[(byte_index*8) +: 8];
+	        end
+	  end
+	end
+
+	/******************************************************************/
+	/* Register reads								                  */
+	/******************************************************************/
+
+	always @(*)
+	begin
+	      // Address decoding for reading registers
+	      case ( rd_addr )
+	        5'h00   : rd_data <= {30'b0, slv_reg0[1:0]};
+	        5'h01   : rd_data <= slv_reg1;
+	        5'h02   : rd_data <= slv_reg2;
+	        5'h03   : rd_data <= {31'b0, pending};
+	        5'h04   : rd_data <= active_period;
+	        5'h05   : rd_data <= active_compare;
+	        5'h06   : rd_data <= count;
+	        5'h07   : rd_data <= periods;
+	        5'h08   : rd_data <= loads;
+	        5'h09   : rd_data <= CLK_FREQUENCY_HZ;
+	        5'h0A   : rd_data <= {16'b0, slv_reg10[15:0]};
+	        5'h0B   : rd_data <= {16'b0, slv_reg11[15:0]};
+	        5'h0C   : rd_data <= NUM_PHASES;
+	        default : rd_data <= !phase_rd ? 0 :
+	                             rd_addr[3] ? phase_compare[rd_addr[2:0]] : phase_offset[rd_addr[2:0]];
+	      endcase
+	end
+
+	/******************************************************************/
+	/* Period counter & shadow registers			                  */
+	/******************************************************************/
+
+    assign enable = slv_reg0[0];
+    assign dither = slv_reg0[1];
+    assign active = enable;
+
+    assign phase_wr = wr_en && wr_addr[4] && (wr_addr[2:0] < NUM_PHASES) && (wr_addr != 5'h18);
+    assign phase_rd = rd_addr[4] && (rd_addr[2:0] < NUM_PHASES) && (rd_addr != 5'h18);
+
+    assign arm    = wr_en && (wr_addr == 5'h02);
+    assign disarm = (wr_en && ((wr_addr == 5'h01) || (wr_addr == 5'h0A))) || phase_wr;
+
+    assign wrap   = ({1'b0, count} + 1'b1 >= {1'b0, active_period});
+    assign load   = !enable || (wrap && pending);
+
+    // the shadow registers are only copied on the last clock of a period, and
+    // only if COMPARE was written (and PERIOD or COMPARE_FRAC not rewritten)
+    // since the last copy
+
+    always @(*)
+    begin
+      n_count   = count + 1'b1;
+      n_period  = active_period;
+      n_compare = active_compare;
+      n_frac    = active_frac;
+      n_acc     = {1'b0, dither_acc};
+      n_high    = high_time;
+
+      if (!enable)
+        begin
+          n_count   = 0;
+          n_period  = slv_reg1;
+          n_compare = slv_reg2;
+          n_frac    = slv_reg10[15:0];
+          n_acc     = 0;
+          n_high    = slv_reg2;
+        end
+      else if (wrap)
+        begin
+          n_count = 0;
+
+          if (pending)
+            begin
+              n_period  = slv_reg1;
+              n_compare = slv_reg2;
+              n_frac    = slv_reg10[15:0];
+            end
+
+          // once per period: add the fraction and stretch the next period's
+          // high time by one clock on a carry
+
+          n_acc  = {1'b0, dither_acc} + (dither ? n_frac : 16'b0);
+          n_high = (n_acc[16] && (n_compare != 32'hFFFFFFFF)) ? (n_compare + 1'b1) : n_compare;
+        end
+    end
+
+    always @( posedge clock )
+    begin
+      if ( reset )
+        begin
+          pending        <= 1'b0;
+          active_period  <= 0;
+          active_compare <= 0;
+          active_frac    <= 0;
+          dither_acc     <= 0;
+          high_time      <= 0;
+          count          <= 0;
+          periods        <= 0;
+          loads          <= 0;
+        end
+      else
+        begin
+          active_period  <= n_period;
+          active_compare <= n_compare;
+          active_frac    <= n_frac;
+          dither_acc     <= n_acc[15:0];
+          high_time      <= n_high;
+          count          <= n_count;
+
+          if (!enable)
+            begin
+              pending <= 1'b0;
+              periods <= 0;
+              loads   <= 0;
+            end
+          else
+            begin
+              if (arm)
+                pending <= 1'b1;
+              else if (disarm || (wrap && pending))
+                pending <= 1'b0;
+
+              if (wrap)
+                periods <= periods + 1;
+
+              if (wrap && pending)
+                loads <= loads + 1;
+            end
+        end
+    end
+
+	/******************************************************************/
+	/* Phases										                  */
+	/******************************************************************/
+
+    // each phase's offset & compare are copied from the shadow registers along
+    // with the period, then wait in the phase until its own period starts (for
+    // phase 0 the dithered high time changes at every wrap). The phases are given
+    // the next counter state, so their registered outputs line up with the counter
+
+    assign pwm = phase_pwm[0];
+
+    genvar p;
+
+    generate
+      for (p = 0; p < NUM_PHASES; p = p + 1)
+        begin : PHASE
+
+          reg     [31:0]      active_offset;
+          reg     [31:0]      active_pcompare;
+          wire    [31:0]      n_offset;
+          wire    [31:0]      n_pcompare;
+
+          assign n_offset   = load ? phase_offset[p] : active_offset;
+          assign n_pcompare = load ? phase_compare[p] : active_pcompare;
+
+          always @( posedge clock )
+          begin
+            if ( reset )
+              begin
+                active_offset   <= 0;
+                active_pcompare <= 0;
+              end
+            else
+              begin
+                active_offset   <= n_offset;
+                active_pcompare <= n_pcompare;
+              end
+          end
+
+          pwmgen_phase PWMGEN_PHASE (
+
+              .clock          (clock),            // I [ 0 ] 100MHz system clock
+              .reset          (reset),            // I [ 0 ] active-high reset
+
+              .enable         (enable),           // I [ 0 ] generator is enabled
+              .count          (n_count),          // I [31:0] shared period counter
+              .period         (n_period),         // I [31:0] period of the shared counter
+              .offset         (n_offset),         // I [31:0] start of this phase's period
+              .compare        ((p == 0) ? n_high : n_pcompare),   // I [31:0] high time (phase 0 is dithered)
+              .update         ((p == 0) ? (load || wrap) : load), // I [ 0 ] offset / compare change this clock
+              .dead_time      (slv_reg11[15:0]),  // I [15:0] dead time of the complementary outputs
+
+              .pwm            (phase_pwm[p]),     // O [ 0 ] PWM of this phase
+              .pwm_h          (pwm_h[p]),         // O [ 0 ] high-side switch
+              .pwm_l          (pwm_l[p]));        // O [ 0 ] low-side switch
+
+        end
+    endgenerate
+
+endmodule
@@ -0,0 +1,154 @@
+// pwmgen_phase.v --> one phase of the PWM generator, with complementary dead-time outputs
+//
+//
+// Author:	Rehan Iqbal
+// Organization: Portland State University
+//
+// Description:
+//
+// This hardware module generates one phase of an interleaved PWM from the period
+// counter shared by all phases (pwmgen.v). The phase starts its period 'offset'
+// clocks after the shared counter wraps and is high for the first 'compare' clocks
+// of it, so with N phases at offsets of period * k / N the switching ripple of N
+// interleaved converter stages appears at N times the PWM frequency. An offset
+// that is not less than the period counts as 0.
+//
+// The phase keeps its own count of clocks into its period, and the period and
+// high time it uses are only taken at the start of its own period, which for a
+// non-zero offset is not where the shared counter wraps. 'update' marks new
+// 'offset' / 'compare' values; they wait ('pending') for the next start of this
+// phase's period. The offset is only looked at there: if the shared counter is
+// not where the phase should start, the phase stays low ('waiting') until it
+// gets there, so moving a phase stretches one low time instead of cutting a
+// pulse short. The same happens after 'enable' rises for a phase whose offset
+// is not 0.
+//
+// 'pwm_h' and 'pwm_l' drive the high-side and low-side switches of a half bridge.
+// 'pwm_h' follows the PWM and 'pwm_l' its complement, but after every transition
+// both stay low for 'dead_time' clocks before the switch being turned on follows,
+// so the two switches are never on at the same time. A pulse shorter than the dead
+// time is swallowed. With 'dead_time' = 0 the outputs follow the PWM directly.
+//
+// Every output is registered. pwmgen.v gives the module the counter, period,
+// offset and compare for the next clock, so the outputs line up with the counter.
+// While 'enable' is low every output is low, which turns both switches off.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+module pwmgen_phase (
+
+	/******************************************************************/
+	/* Port declarations							                  */
+	/******************************************************************/
+
+	input 						clock,			// 100MHz system clock
+	input 						reset,			// active-high synchronous reset
+
+	input 						enable,			// generator is enabled
+	input		[31:0]			count,			// shared period counter (next clock)
+	input		[31:0]			period,			// period of the shared counter, in clock cycles
+	input		[31:0]			offset,			// start of this phase's period, in clocks after the counter wraps
+	input		[31:0]			compare,		// high time, in clock cycles
+	input 						update,			// 'offset' / 'compare' change this clock
+	input		[15:0]			dead_time,		// clocks both switches stay off after a transition
+
+	output reg 					pwm,			// PWM of this phase
+	output reg 					pwm_h,			// high-side switch (PWM with dead time)
+	output reg 					pwm_l);			// low-side switch (complement with dead time)
+
+	/******************************************************************/
+	/* Local parameters and values		                  	  		  */
+	/******************************************************************/
+
+	reg			[31:0]			phase_count;	// clocks into this phase's period
+	reg			[31:0]			phase_period;	// period in use, taken at the start of this phase's period
+	reg			[31:0]			phase_compare;	// high time in use, taken at the start of this phase's period
+	reg							pending;		// new offset / compare wait for the start of this phase's period
+	reg							waiting;		// held low until the shared counter reaches this phase's start
+
+	wire		[31:0]			start;			// shared count at which this phase's periods start
+	wire						boundary;		// this phase's period is over (or not started yet)
+	wire						starts;			// this phase's period starts in the next clock
+
+	wire		[31:0]			n_phase_count;	// values for the next clock
+	wire		[31:0]			n_phase_period;
+	wire		[31:0]			n_phase_compare;
+	wire						n_pending;
+	wire						n_waiting;
+
+	wire						raw;			// PWM of this phase before the output register
+	reg			[15:0]			dead_count;		// clocks of dead time left
+
+	assign start    = (offset >= period) ? 32'b0 : offset;
+	assign boundary = !enable || waiting || ({1'b0, phase_count} + 1'b1 >= {1'b0, phase_period});
+	assign starts   = boundary && (count == start);
+
+	assign n_phase_count   = starts ? 32'b0 : (phase_count + 1'b1);
+	assign n_phase_period  = starts ? period : phase_period;
+	assign n_phase_compare = (starts && (pending || update)) ? compare : phase_compare;
+	assign n_pending       = (pending || update) && !starts;
+	assign n_waiting       = boundary && !starts;
+
+	assign raw = enable && !n_waiting && (n_phase_period > 1) && (n_phase_count < n_phase_compare);
+
+	/******************************************************************/
+	/* Phase counter								                  */
+	/******************************************************************/
+
+	always@(posedge clock) begin
+
+		if (reset) begin
+			phase_count <= 32'b0;
+			phase_period <= 32'b0;
+			phase_compare <= 32'b0;
+			pending <= 1'b0;
+			waiting <= 1'b1;
+		end
+
+		else begin
+			phase_count <= n_phase_count;
+			phase_period <= n_phase_period;
+			phase_compare <= n_phase_compare;
+			pending <= n_pending;
+			waiting <= n_waiting;
+		end
+
+	end
+
+	/******************************************************************/
+	/* PWM & dead-time outputs						                  */
+	/******************************************************************/
+
+	always@(posedge clock) begin
+
+		if (reset || !enable) begin
+			pwm <= 1'b0;
+			pwm_h <= 1'b0;
+			pwm_l <= 1'b0;
+			dead_count <= 16'b0;
+		end
+
+		else begin
+
+			pwm <= raw;
+
+			if ((raw != pwm) && (dead_time != 16'b0)) begin	// transition --> both switches off...
+				pwm_h <= 1'b0;
+				pwm_l <= 1'b0;
+				dead_count <= dead_time - 1'b1;
+			end
+
+			else if (dead_count != 16'b0) begin				// ...for the rest of the dead time...
+				dead_count <= dead_count - 1'b1;
+			end
+
+			else begin										// ...then the new switch follows the PWM
+				pwm_h <= raw;
+				pwm_l <= !raw;
+			end
+
+		end
+
+	end
+
+endmodule
@@ -0,0 +1,505 @@
+// pwmgen_tb.v --> self-checking testbench for pwmgen.v and pwmgen_phase.v
+//
+//
+// Author:	Rehan Iqbal
+// Organization: Portland State University
+//
+// Description:
+//
+// This testbench runs a 4-phase PWMGEN through the register interface and checks
+// its outputs cycle by cycle. It is not part of the peripheral; add it to the
+// simulation sources only (e.g. xvlog pwmgen.v pwmgen_phase.v pwmgen_tb.v). It
+// covers:
+//
+//		phase alignment		each phase rises 'offset' clocks after phase 0, with the
+//							set high time and period
+//		dead time			pwm_h / pwm_l are never on together, every turn-on waits
+//							DEAD_TIME clocks and the high time shrinks by DEAD_TIME
+//		runt swallowing		a phase whose high time is not longer than the dead time
+//							never turns its high-side switch on
+//		shadow registers	PERIOD alone is not applied, COMPARE arms the update,
+//							PERIOD after COMPARE disarms it
+//		phase updates		a new compare, offset or period never cuts a pulse short:
+//							every pulse is either the old or the new high time
+//		dither				the high time of phase 0 averaged over 64 periods is
+//							COMPARE + COMPARE_FRAC / 65536 clocks exactly
+//
+// The monitor counts every violation; the run ends with "PASS" or "FAIL" and the
+// number of errors.
+//
+////////////////////////////////////////////////////////////////////////////////////////////////
+
+`timescale 1ns / 1ps
+
+module pwmgen_tb;
+
+	/******************************************************************/
+	/* Local parameters and values		                  	  		  */
+	/******************************************************************/
+
+	localparam integer	NUM_PHASES = 4;
+	localparam integer	PERIOD = 100;				// clock cycles
+	localparam integer	HIGH = 30;					// clock cycles
+	localparam integer	DEAD = 5;					// clock cycles
+
+	// register addresses (32-bit word index)
+
+	localparam [4:0]	CTRL = 5'h00;
+	localparam [4:0]	PERIOD_REG = 5'h01;
+	localparam [4:0]	COMPARE = 5'h02;
+	localparam [4:0]	STATUS = 5'h03;
+	localparam [4:0]	ACTIVE_PERIOD = 5'h04;
+	localparam [4:0]	ACTIVE_COMPARE = 5'h05;
+	localparam [4:0]	LOADS = 5'h08;
+	localparam [4:0]	COMPARE_FRAC = 5'h0A;
+	localparam [4:0]	DEAD_TIME = 5'h0B;
+	localparam [4:0]	PHASE_OFFSET = 5'h10;		// + phase
+	localparam [4:0]	PHASE_COMPARE = 5'h18;		// + phase (1 - 7)
+
+	reg 								clock;
+	reg 								reset;
+	reg 								wr_en;
+	reg			[4:0]					wr_addr;
+	reg			[31:0]					wr_data;
+	reg			[3:0]					wr_strb;
+	reg			[4:0]					rd_addr;
+	wire		[31:0]					rd_data;
+	wire								pwm;
+	wire		[NUM_PHASES-1:0]		pwm_h;
+	wire		[NUM_PHASES-1:0]		pwm_l;
+	wire								active;
+
+	integer								errors;
+	integer								cycle;
+	integer								k;
+	integer								m;							// monitor loop index
+	integer								n;
+	reg			[31:0]					data;
+	reg			[31:0]					loads0;
+	integer								high0;
+
+	// monitor state, one entry per phase
+
+	reg			[NUM_PHASES-1:0]		prev_h;
+	reg			[NUM_PHASES-1:0]		prev_l;
+	integer								h_rise [0:NUM_PHASES-1];	// cycle of the last pwm_h rising edge
+	integer								h_fall [0:NUM_PHASES-1];	// cycle of the last pwm_h falling edge
+	integer								l_fall [0:NUM_PHASES-1];	// cycle of the last pwm_l falling edge
+	integer								h_rises [0:NUM_PHASES-1];	// pwm_h rising edges seen
+	integer								h_high [0:NUM_PHASES-1];	// length of the last pwm_h pulse
+	integer								h_period [0:NUM_PHASES-1];	// clocks between the last two pwm_h rises
+	integer								width_a [0:NUM_PHASES-1];	// pwm_h pulse lengths allowed while
+	integer								width_b [0:NUM_PHASES-1];	// 'width_chk' is set
+	reg 								width_chk;
+	integer								dead_chk;					// minimum dead time checked (0 = off)
+
+	reg 								prev_pwm;
+	integer								pwm_rises;					// 'pwm' rising edges seen
+	integer								pwm_high;					// clocks 'pwm' was high
+	integer								pwm_high_at_rise;			// 'pwm_high' at the last rising edge
+
+	/******************************************************************/
+	/* Device under test							                  */
+	/******************************************************************/
+
+	pwmgen #(
+		.CLK_FREQUENCY_HZ	(100000000),
+		.NUM_PHASES			(NUM_PHASES))
+
+	DUT (
+		.clock				(clock),				// I [ 0 ] 100MHz system clock
+		.reset				(reset),				// I [ 0 ] active-high reset
+		.wr_en				(wr_en),				// I [ 0 ] register write strobe
+		.wr_addr			(wr_addr),				// I [4:0] register being written
+		.wr_data			(wr_data),				// I [31:0] write data
+		.wr_strb			(wr_strb),				// I [3:0] byte enables
+		.rd_addr			(rd_addr),				// I [4:0] register being read
+		.rd_data			(rd_data),				// O [31:0] contents of register 'rd_addr'
+		.pwm				(pwm),					// O [ 0 ] PWM output (phase 0)
+		.pwm_h				(pwm_h),				// O [NUM_PHASES-1:0] high-side switches
+		.pwm_l				(pwm_l),				// O [NUM_PHASES-1:0] low-side switches
+		.active				(active));				// O [ 0 ] generator is enabled
+
+	always #5 clock = ~clock;						// 100MHz
+
+	/******************************************************************/
+	/* Output monitor								                  */
+	/******************************************************************/
+
+	// samples the outputs on every rising edge; the outputs are registered, so
+	// the values seen are the ones of the clock that just ended
+
+	always @( posedge clock )
+	begin
+	  if ( !reset )
+	    begin
+	      for ( m = 0; m < NUM_PHASES; m = m+1 )
+	        begin
+	          if (pwm_h[m] && pwm_l[m])
+	            fail("both switches of a phase are on", m, cycle);
+
+	          if (pwm_h[m] && !prev_h[m])
+	            begin
+	              if (h_rises[m] > 0)
+	                h_period[m] = cycle - h_rise[m];
+
+	              h_rise[m] = cycle;
+	              h_rises[m] = h_rises[m] + 1;
+
+	              if ((dead_chk != 0) && (cycle - l_fall[m] < dead_chk))
+	                fail("pwm_h turned on inside the dead time", m, cycle - l_fall[m]);
+	            end
+
+	          if (!pwm_h[m] && prev_h[m])
+	            begin
+	              h_high[m] = cycle - h_rise[m];
+	              h_fall[m] = cycle;
+
+	              if (width_chk && (h_high[m] != width_a[m]) && (h_high[m] != width_b[m]))
+	                fail("pwm_h pulse with an unexpected length", m, h_high[m]);
+	            end
+
+	          if (pwm_l[m] && !prev_l[m] && (dead_chk != 0) && (cycle - h_fall[m] < dead_chk))
+	            fail("pwm_l turned on inside the dead time", m, cycle - h_fall[m]);
+
+	          if (!pwm_l[m] && prev_l[m])
+	            l_fall[m] = cycle;
+	        end
+
+	      if (pwm && !prev_pwm)
+	        begin
+	          pwm_rises = pwm_rises + 1;
+	          pwm_high_at_rise = pwm_high;
+	        end
+
+	      if (pwm)
+	        pwm_high = pwm_high + 1;
+
+	      prev_h = pwm_h;
+	      prev_l = pwm_l;
+	      prev_pwm = pwm;
+	      cycle = cycle + 1;
+	    end
+	end
+
+	/******************************************************************/
+	/* Tasks										                  */
+	/******************************************************************/
+
+	task fail;
+	  input [8*48-1:0]	msg;
+	  input integer		phase;
+	  input integer		value;
+	  begin
+	    errors = errors + 1;
+	    $display("%0t: FAIL: %0s (phase %0d, %0d)", $time, msg, phase, value);
+	  end
+	endtask
+
+	task check;
+	  input				cond;
+	  input [8*48-1:0]	msg;
+	  input integer		value;
+	  begin
+	    if (!cond)
+	      begin
+	        errors = errors + 1;
+	        $display("%0t: FAIL: %0s (%0d)", $time, msg, value);
+	      end
+	  end
+	endtask
+
+	// one register write; the stimulus changes on the falling edge so it is
+	// stable when the DUT samples it
+
+	task write_reg;
+	  input [4:0]		addr;
+	  input [31:0]		value;
+	  begin
+	    @( negedge clock );
+	    wr_en = 1'b1;
+	    wr_addr = addr;
+	    wr_data = value;
+	    wr_strb = 4'hF;
+	    @( negedge clock );
+	    wr_en = 1'b0;
+	  end
+	endtask
+
+	task read_reg;
+	  input [4:0]		addr;
+	  output [31:0]		value;
+	  begin
+	    rd_addr = addr;
+	    #1 value = rd_data;
+	  end
+	endtask
+
+	task wait_clocks;
+	  input integer		clocks;
+	  begin
+	    repeat (clocks) @( negedge clock );
+	  end
+	endtask
+
+	task wait_pwm_rises;
+	  input integer		rises;
+	  begin
+	    n = pwm_rises + rises;
+	    while (pwm_rises < n)
+	      @( negedge clock );
+	  end
+	endtask
+
+	// every pwm_h pulse of every phase must be 'width' clocks long
+
+	task expect_width;
+	  input integer		width;
+	  begin
+	    for ( k = 0; k < NUM_PHASES; k = k+1 )
+	      begin
+	        width_a[k] = width;
+	        width_b[k] = width;
+	      end
+	  end
+	endtask
+
+	// rising edge of phase 'phase' relative to phase 0, modulo the period
+
+	task check_offset;
+	  input integer		phase;
+	  input integer		offset;
+	  input integer		period;
+	  begin
+	    check((((h_rise[phase] - h_rise[0]) % period + period) % period) == offset,
+	          "phase rises at the wrong offset", h_rise[phase] - h_rise[0]);
+	  end
+	endtask
+
+	/******************************************************************/
+	/* Test sequence								                  */
+	/******************************************************************/
+
+	initial
+	begin
+	  clock = 1'b0;
+	  reset = 1'b1;
+	  wr_en = 1'b0;
+	  wr_addr = 5'b0;
+	  wr_data = 32'b0;
+	  wr_strb = 4'b0;
+	  rd_addr = 5'b0;
+
+	  errors = 0;
+	  cycle = 0;
+	  prev_h = 0;
+	  prev_l = 0;
+	  prev_pwm = 1'b0;
+	  pwm_rises = 0;
+	  pwm_high = 0;
+	  pwm_high_at_rise = 0;
+	  width_chk = 1'b0;
+	  dead_chk = 0;
+
+	  for ( k = 0; k < NUM_PHASES; k = k+1 )
+	    begin
+	      h_rise[k] = 0;
+	      h_fall[k] = 0;
+	      l_fall[k] = 0;
+	      h_rises[k] = 0;
+	      h_high[k] = 0;
+	      h_period[k] = 0;
+	      width_a[k] = 0;
+	      width_b[k] = 0;
+	    end
+
+	  wait_clocks(10);
+	  reset = 1'b0;
+
+	  // phase alignment: 4 phases a quarter period apart, no dead time
+
+	  $display("phase alignment");
+
+	  write_reg(PERIOD_REG, PERIOD);
+	  write_reg(COMPARE, HIGH);
+
+	  for ( k = 1; k < NUM_PHASES; k = k+1 )
+	    begin
+	      write_reg(PHASE_OFFSET + k, (PERIOD / NUM_PHASES) * k);
+	      write_reg(PHASE_COMPARE + k, HIGH);
+	    end
+
+	  write_reg(CTRL, 32'h1);
+	  wait_clocks(3 * PERIOD);
+
+	  expect_width(HIGH);
+	  width_chk = 1'b1;
+	  wait_clocks(3 * PERIOD);
+
+	  for ( k = 0; k < NUM_PHASES; k = k+1 )
+	    begin
+	      check(h_high[k] == HIGH, "wrong high time", h_high[k]);
+	      check(h_period[k] == PERIOD, "wrong period", h_period[k]);
+	      check_offset(k, (PERIOD / NUM_PHASES) * k, PERIOD);
+	    end
+
+	  // dead time: the high side loses DEAD clocks, the phases stay aligned
+
+	  $display("dead time");
+
+	  width_chk = 1'b0;
+	  write_reg(DEAD_TIME, DEAD);
+	  wait_clocks(2 * PERIOD);
+
+	  expect_width(HIGH - DEAD);
+	  width_chk = 1'b1;
+	  dead_chk = DEAD;
+	  wait_clocks(4 * PERIOD);
+
+	  for ( k = 0; k < NUM_PHASES; k = k+1 )
+	    begin
+	      check(h_high[k] == HIGH - DEAD, "wrong high time with dead time", h_high[k]);
+	      check(h_period[k] == PERIOD, "wrong period with dead time", h_period[k]);
+	      check_offset(k, (PERIOD / NUM_PHASES) * k, PERIOD);
+	    end
+
+	  // runt swallowing: a pulse no longer than the dead time never turns the
+	  // high side on (the monitor keeps checking the other phases)
+
+	  $display("runt swallowing");
+
+	  write_reg(PHASE_COMPARE + 1, DEAD - 2);
+	  write_reg(COMPARE, HIGH);
+	  wait_clocks(3 * PERIOD);
+
+	  n = h_rises[1];
+	  wait_clocks(5 * PERIOD);
+	  check(h_rises[1] == n, "runt pulse reached pwm_h", h_rises[1] - n);
+
+	  write_reg(PHASE_COMPARE + 1, HIGH);
+	  write_reg(COMPARE, HIGH);
+	  wait_clocks(3 * PERIOD);
+	  check(h_high[1] == HIGH - DEAD, "phase did not recover after the runt", h_high[1]);
+
+	  dead_chk = 0;
+	  width_chk = 1'b0;
+	  write_reg(DEAD_TIME, 0);
+	  wait_clocks(2 * PERIOD);
+
+	  // shadow registers: PERIOD alone is not applied, COMPARE arms the update,
+	  // PERIOD written after COMPARE disarms it again
+
+	  $display("shadow registers");
+
+	  read_reg(LOADS, loads0);
+
+	  write_reg(PERIOD_REG, 2 * PERIOD);
+	  wait_clocks(4 * PERIOD);
+	  read_reg(ACTIVE_PERIOD, data);
+	  check(data == PERIOD, "PERIOD applied without COMPARE", data);
+	  read_reg(STATUS, data);
+	  check(data == 0, "update armed by PERIOD", data);
+	  read_reg(LOADS, data);
+	  check(data == loads0, "shadow registers loaded while disarmed", data - loads0);
+
+	  write_reg(COMPARE, HIGH);
+	  read_reg(STATUS, data);
+	  check(data == 1, "COMPARE did not arm the update", data);
+	  wait_clocks(2 * PERIOD + 10);
+	  read_reg(ACTIVE_PERIOD, data);
+	  check(data == 2 * PERIOD, "armed PERIOD not applied", data);
+	  read_reg(STATUS, data);
+	  check(data == 0, "update still armed after the boundary", data);
+	  read_reg(LOADS, data);
+	  check(data == loads0 + 1, "wrong number of loads", data - loads0);
+	  wait_clocks(4 * PERIOD);
+	  check(h_period[0] == 2 * PERIOD, "new period not generated", h_period[0]);
+
+	  write_reg(COMPARE, 2 * HIGH);
+	  write_reg(PERIOD_REG, PERIOD);
+	  read_reg(STATUS, data);
+	  check(data == 0, "PERIOD did not disarm the update", data);
+	  wait_clocks(6 * PERIOD);
+	  read_reg(ACTIVE_PERIOD, data);
+	  check(data == 2 * PERIOD, "disarmed PERIOD applied", data);
+	  read_reg(ACTIVE_COMPARE, data);
+	  check(data == HIGH, "disarmed COMPARE applied", data);
+
+	  write_reg(PERIOD_REG, PERIOD);
+	  write_reg(COMPARE, HIGH);
+	  wait_clocks(6 * PERIOD);
+	  read_reg(ACTIVE_PERIOD, data);
+	  check(data == PERIOD, "PERIOD not restored", data);
+
+	  // phase updates: phase 3 is high when the counter wraps, so a new compare,
+	  // offset or period applied there would cut its pulse short
+
+	  $display("phase updates");
+
+	  expect_width(HIGH);
+	  width_b[3] = HIGH / 3;
+	  width_chk = 1'b1;
+
+	  write_reg(PHASE_COMPARE + 3, HIGH / 3);
+	  write_reg(COMPARE, HIGH);
+	  wait_clocks(5 * PERIOD);
+	  check(h_high[3] == HIGH / 3, "new phase compare not applied", h_high[3]);
+
+	  write_reg(PHASE_OFFSET + 3, 40);
+	  write_reg(PHASE_COMPARE + 3, HIGH);
+	  write_reg(COMPARE, HIGH);
+	  wait_clocks(5 * PERIOD);
+	  check(h_high[3] == HIGH, "phase compare not restored", h_high[3]);
+	  check_offset(3, 40, PERIOD);
+
+	  expect_width(HIGH);
+	  write_reg(PERIOD_REG, PERIOD - 20);
+	  write_reg(COMPARE, HIGH);
+	  wait_clocks(5 * PERIOD);
+
+	  for ( k = 0; k < NUM_PHASES; k = k+1 )
+	    check(h_period[k] == PERIOD - 20, "phase did not follow the new period", h_period[k]);
+
+	  check_offset(1, PERIOD / NUM_PHASES, PERIOD - 20);
+	  check_offset(3, 40, PERIOD - 20);
+
+	  write_reg(PERIOD_REG, PERIOD);
+	  write_reg(COMPARE, HIGH);
+	  wait_clocks(5 * PERIOD);
+
+	  // dither: 1/4 clock on top of HIGH, so 64 periods hold 16 extra clocks
+
+	  $display("dither");
+
+	  width_a[0] = HIGH;
+	  width_b[0] = HIGH + 1;
+
+	  write_reg(COMPARE_FRAC, 32'h4000);
+	  write_reg(COMPARE, HIGH);
+	  write_reg(CTRL, 32'h3);
+	  wait_clocks(4 * PERIOD);
+
+	  wait_pwm_rises(1);
+	  high0 = pwm_high_at_rise;
+	  wait_pwm_rises(64);
+	  check(pwm_high_at_rise - high0 == 64 * HIGH + 16, "dithered high time is off", pwm_high_at_rise - high0);
+	  check(h_period[0] == PERIOD, "dither changed the period", h_period[0]);
+
+	  if (errors == 0)
+	    $display("pwmgen_tb: PASS");
+	  else
+	    $display("pwmgen_tb: FAIL (%0d errors)", errors);
+
+	  $finish;
+	end
+
+	// a hung test is a failure too
+
+	initial
+	begin
+	  #2000000;
+	  $display("pwmgen_tb: FAIL (timeout)");
+	  $finish;
+	end
+
+endmodule
@@ -0,0 +1,652 @@
+/**
+*
+* @file pwm_gen.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file provides an API for Pulse-width modulation using the PWMGEN peripheral.  The calls
+* match those in pwm_tmrctr.c, but because PWMGEN applies a new period and compare value at the
+* end of the current PWM period, PWMGEN_SetParams() does not stop the PWM and PWMGEN_Start()
+* does not restart a PWM that is already running.  Changing only the duty cycle is a single
+* register write and does not disturb the output.
+*
+* With dithering on, PWMGEN_SetDutyHR() sets the duty cycle to a fraction of a clock
+* cycle: the hardware stretches the high time by one clock in the right share of the
+* periods, adding 16 bits of resolution to the clock count.
+*
+* A PWMGEN built with more than one phase drives a complementary pair of outputs with
+* dead time per phase.  PWMGEN_SetPhases() writes every phase and then the compare
+* register of phase 0, which arms the update, so all phases are updated together: each
+* one at the start of its own period after the same counter wrap.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	03/05/16	First release of driver
+* 1.01a	ri	03/08/16	Added PWMGEN_SetDither(), PWMGEN_SetCompareFrac() and PWMGEN_SetDutyHR()
+* 1.02a	ri	03/10/16	Added PWMGEN_SetDeadTime(), PWMGEN_SetPhases() and PWMGEN_SetInterleaved()
+* </pre>
+*
+******************************************************************************/
+/***************************** Include Files *********************************/
+#include "pwm_gen.h"
+
+
+/************************** Constant Definitions *****************************/
+
+/**************************** Type Definitions *******************************/
+
+
+/***************** Macros (Inline Functions) Definitions *********************/
+
+
+/************************** Function Prototypes ******************************/
+
+
+/************************** Variable Definitions *****************************/
+
+/*****************************************************************************/
+/**
+* Initializes a PWMGEN instance/driver.
+*
+* Looks up the base address of the device, stops the PWM, turns dithering off and
+* clears the period, compare, fraction, dead time and phase registers.
+*
+* @param    InstancePtr is a pointer to the PWMGEN instance to be used for PWM.
+* @param    DeviceId is the unique id of the PWMGEN device (XPAR_PWMGEN_n_DEVICE_ID)
+* @param	EnableInterrupts is ignored; PWMGEN has no interrupt.  It is kept so the
+*			call matches PWM_Initialize()
+* @param	clkfreq is the input clock frequency for the PWM counter
+*
+* @return
+*
+*   - XST_SUCCESS if initialization was successful
+*   - XST_DEVICE_NOT_FOUND if the device doesn't exist
+*
+******************************************************************************/
+int PWMGEN_Initialize(PWMGEN *InstancePtr, u16 DeviceId, bool EnableInterrupts, u32 clkfreq)
+{
+	u32		BaseAddress = 0;
+	u32		phase;
+
+	(void) EnableInterrupts;
+
+#ifdef XPAR_PWMGEN_0_DEVICE_ID
+	if (DeviceId == XPAR_PWMGEN_0_DEVICE_ID)
+	{
+		BaseAddress = XPAR_PWMGEN_0_S00_AXI_BASEADDR;
+	}
+#else
+	(void) DeviceId;
+#endif
+
+	if (BaseAddress == 0)  // no PWMGEN with this device ID in xparameters.h
+	{
+		return XST_DEVICE_NOT_FOUND;
+	}
+
+	// stop the PWM and clear the shadow registers; with the PWM stopped they
+	// are copied straight into the active registers
+	PWMGEN_WriteReg(BaseAddress, PWMGEN_CTRL_OFFSET, 0);
+	PWMGEN_WriteReg(BaseAddress, PWMGEN_PERIOD_OFFSET, 0);
+	PWMGEN_WriteReg(BaseAddress, PWMGEN_COMPARE_FRAC_OFFSET, 0);
+	PWMGEN_WriteReg(BaseAddress, PWMGEN_DEAD_TIME_OFFSET, 0);
+	for (phase = 0; phase < PWMGEN_MAX_PHASES; phase++)
+	{
+		PWMGEN_WriteReg(BaseAddress, PWMGEN_PHASE_OFFSET_OFFSET + 4 * phase, 0);
+		PWMGEN_WriteReg(BaseAddress, PWMGEN_PHASE_COMPARE_OFFSET + 4 * phase, 0);
+	}
+	PWMGEN_WriteReg(BaseAddress, PWMGEN_COMPARE_OFFSET, 0);
+
+	InstancePtr->BaseAddress = BaseAddress;
+	InstancePtr->ClockFreq = clkfreq;
+	InstancePtr->Period = 0;
+	InstancePtr->Frac = 0;
+	InstancePtr->NumPhases = PWMGEN_ReadReg(BaseAddress, PWMGEN_NUM_PHASES_OFFSET);
+	InstancePtr->IsReady = XIL_COMPONENT_IS_READY;
+
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+* Starts the specified PWM
+*
+* Enables the PWM with the period and compare values last written.  Unlike
+* PWM_Start(), a PWM that is already running is left alone, so calling this
+* after every PWMGEN_SetParams() does not restart the period.
+*
+* @param    InstancePtr is a pointer to the PWM instance to be worked on.
+*
+* @return
+*
+*   - XST_SUCCESS if the PWM was started
+*   - XST_FAILURE if the PWM instance is not initialized
+*
+******************************************************************************/
+int PWMGEN_Start(PWMGEN *InstancePtr)
+{
+	u32		ctlbits;
+
+	if (InstancePtr->IsReady != XIL_COMPONENT_IS_READY) // check that instance is initialized
+	{
+		return XST_FAILURE;
+	}
+
+	ctlbits = PWMGEN_ReadReg(InstancePtr->BaseAddress, PWMGEN_CTRL_OFFSET);
+	if ((ctlbits & PWMGEN_CTRL_ENABLE_MASK) == 0)
+	{
+		PWMGEN_WriteReg(InstancePtr->BaseAddress, PWMGEN_CTRL_OFFSET, ctlbits | PWMGEN_CTRL_ENABLE_MASK);
+	}
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* PWMGEN_Stop() - Stops the specified PWM instance
+*
+* Stops the PWM immediately and drives its output low.
+*
+* @param    InstancePtr is a pointer to the PWM instance to be worked on.
+*
+* @return
+*
+*   - XST_SUCCESS if the PWM was stopped
+*   - XST_FAILURE if the PWM instance is not initialized
+*
+******************************************************************************/
+int PWMGEN_Stop(PWMGEN *InstancePtr)
+{
+	u32		ctlbits;
+
+	if (InstancePtr->IsReady != XIL_COMPONENT_IS_READY) // check that instance is initialized
+	{
+		return XST_FAILURE;
+	}
+
+	ctlbits = PWMGEN_ReadReg(InstancePtr->BaseAddress, PWMGEN_CTRL_OFFSET);
+	PWMGEN_WriteReg(InstancePtr->BaseAddress, PWMGEN_CTRL_OFFSET, ctlbits & ~PWMGEN_CTRL_ENABLE_MASK);
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* PWMGEN_SetParams() - Set the PWM parameters
+*
+* Sets the frequency and duty cycle for the PWM.  The PWM keeps running; the new values
+* take effect together at the end of the current period.  The period register is only
+* written when the frequency changes, so a new duty cycle is a single register write.
+*
+* @param    InstancePtr is a pointer to the PWM instance to be worked on.
+* @param    PWM frequency (in Hz).
+* @param	PWM high time (in pct of PWM period - 0 to 100)
+*
+* @return
+*
+*   - XST_SUCCESS if the PWM parameters were loaded
+*   - XST_FAILURE if the PWM instance is not initialized
+*	- XST_INVALID_PARAM if one or both of the parameters is invalid
+*
+* @note
+* Formulas for calculating counts (the PWM counter counts up from 0):
+* 	PERIOD = PWM_PERIOD / CLOCK_PERIOD
+* 	COMPARE = PERIOD * (DUTY CYCLE / 100)
+*
+* The period must be written before the compare value: writing the period disarms the
+* update and writing the compare value arms it again, so both are always applied at the
+* same period boundary.  A fraction left by PWMGEN_SetDutyHR() is cleared the same way.
+*
+******************************************************************************/
+int PWMGEN_SetParams(PWMGEN *InstancePtr, u32 freq, u32 dutyfactor)
+{
+	float	period,
+			compare;
+
+	if (InstancePtr->IsReady != XIL_COMPONENT_IS_READY) // check that instance is initialized
+	{
+		return XST_FAILURE;
+	}
+
+	// check to see if parameters are valid
+	if ((freq == 0) || (dutyfactor > 100))  // cannot have a duty cycle > 100%
+	{
+		return XST_INVALID_PARAM;
+	}
+
+	// calculate the PWM period and high time in clock cycles
+	period = (float) InstancePtr->ClockFreq / freq;
+	compare = (period * dutyfactor) / 100.00;
+
+	if ((period < 2.0) || (period > PWMGEN_MAXCNT))  // period is too short or too long for the counter
+	{
+		return XST_INVALID_PARAM;
+	}
+
+	// period and duty cycle are within range of the counter - write the shadow registers
+	if ((u32) lroundf(period) != InstancePtr->Period)
+	{
+		InstancePtr->Period = (u32) lroundf(period);
+		PWMGEN_WriteReg(InstancePtr->BaseAddress, PWMGEN_PERIOD_OFFSET, InstancePtr->Period);
+	}
+	if (InstancePtr->Frac != 0)
+	{
+		InstancePtr->Frac = 0;
+		PWMGEN_WriteReg(InstancePtr->BaseAddress, PWMGEN_COMPARE_FRAC_OFFSET, 0);
+	}
+	PWMGEN_WriteReg(InstancePtr->BaseAddress, PWMGEN_COMPARE_OFFSET, (u32) lroundf(compare));
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* PWMGEN_GetParams() - Get the PWM parameters
+*
+* Returns the frequency (Hz) and duty cycle (%) last set for the PWM.  Unlike
+* PWM_GetParams() the PWM is not stopped.
+*
+* @param    InstancePtr is a pointer to the PWM instance to be worked on.
+* @param    pointer to PWM frequency (in Hz).
+* @param	pointer to PWM high time (in pct of PWM period - 0 to 100)
+*
+* @return
+*
+*   - XST_SUCCESS if the PWM parameters were read
+*   - XST_FAILURE if the PWM instance is not initialized
+*
+* @note
+* The values are those of the shadow registers, which may not have been applied yet.
+* A period of 0 (never set) is returned as 0 Hz and 0%.
+*
+******************************************************************************/
+int PWMGEN_GetParams(PWMGEN *InstancePtr, u32 *freq, u32 *dutyfactor)
+{
+	u32		period,
+			compare;
+
+	if (InstancePtr->IsReady != XIL_COMPONENT_IS_READY) // check that instance is initialized
+	{
+		return XST_FAILURE;
+	}
+
+	period = PWMGEN_ReadReg(InstancePtr->BaseAddress, PWMGEN_PERIOD_OFFSET);
+	compare = PWMGEN_ReadReg(InstancePtr->BaseAddress, PWMGEN_COMPARE_OFFSET);
+
+	if (period == 0)
+	{
+		*freq = 0;
+		*dutyfactor = 0;
+		return XST_SUCCESS;
+	}
+
+	if (compare > period)  // compare >= period is a 100% duty cycle
+	{
+		compare = period;
+	}
+
+	// round the values and return them
+	*freq = lroundf((float) InstancePtr->ClockFreq / period);
+	*dutyfactor = lroundf(((float) compare * 100.00) / period);
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* PWMGEN_SetCompare() - Set the PWM high time in clock cycles
+*
+* Writes the compare register directly, for duty cycle steps finer than 1%.  This is
+* a single register write; the new high time takes effect at the end of the current
+* period along with the last period set by PWMGEN_SetParams().
+*
+* @param    InstancePtr is a pointer to the PWM instance to be worked on.
+* @param    compare is the high time in clock cycles (>= the period is 100%)
+*
+* @return
+*
+*   - XST_SUCCESS if the compare value was written
+*   - XST_FAILURE if the PWM instance is not initialized
+*
+******************************************************************************/
+int PWMGEN_SetCompare(PWMGEN *InstancePtr, u32 compare)
+{
+	if (InstancePtr->IsReady != XIL_COMPONENT_IS_READY) // check that instance is initialized
+	{
+		return XST_FAILURE;
+	}
+
+	PWMGEN_WriteReg(InstancePtr->BaseAddress, PWMGEN_COMPARE_OFFSET, compare);
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* PWMGEN_SetDither() - Turn the dithered (sigma-delta) duty cycle on or off
+*
+* With dithering on, the fraction set by PWMGEN_SetCompareFrac() or PWMGEN_SetDutyHR()
+* is added to the high time on average: a first-order sigma-delta accumulator in the
+* hardware stretches the high time by one clock in that share of the periods.  With
+* dithering off the fraction is ignored.
+*
+* @param    InstancePtr is a pointer to the PWM instance to be worked on.
+* @param    enable is true to turn dithering on, false to turn it off
+*
+* @return
+*
+*   - XST_SUCCESS if the mode was set
+*   - XST_FAILURE if the PWM instance is not initialized
+*
+* @note
+* The dither adds ripple at sub-multiples of the PWM frequency (down to 1/65536 of it
+* for the smallest fractions), which the sensor and the control loop must average out.
+*
+******************************************************************************/
+int PWMGEN_SetDither(PWMGEN *InstancePtr, bool enable)
+{
+	u32		ctlbits;
+
+	if (InstancePtr->IsReady != XIL_COMPONENT_IS_READY) // check that instance is initialized
+	{
+		return XST_FAILURE;
+	}
+
+	ctlbits = PWMGEN_ReadReg(InstancePtr->BaseAddress, PWMGEN_CTRL_OFFSET);
+	if (enable)
+	{
+		ctlbits |= PWMGEN_CTRL_DITHER_MASK;
+	}
+	else
+	{
+		ctlbits &= ~PWMGEN_CTRL_DITHER_MASK;
+	}
+	PWMGEN_WriteReg(InstancePtr->BaseAddress, PWMGEN_CTRL_OFFSET, ctlbits);
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* PWMGEN_SetCompareFrac() - Set the PWM high time in 1/65536 clock cycles
+*
+* Writes the fraction and then the compare register, so both take effect together at
+* the end of the current period.  The average high time is compare + frac / 65536
+* clock cycles when dithering is on, and compare clock cycles when it is off.  Only
+* the compare register is written when the fraction has not changed.
+*
+* @param    InstancePtr is a pointer to the PWM instance to be worked on.
+* @param    compare is the whole number of clock cycles of the high time
+* @param    frac is the fraction of a clock cycle added to it, in 1/65536ths
+*
+* @return
+*
+*   - XST_SUCCESS if the high time was written
+*   - XST_FAILURE if the PWM instance is not initialized
+*
+******************************************************************************/
+int PWMGEN_SetCompareFrac(PWMGEN *InstancePtr, u32 compare, u16 frac)
+{
+	if (InstancePtr->IsReady != XIL_COMPONENT_IS_READY) // check that instance is initialized
+	{
+		return XST_FAILURE;
+	}
+
+	if (frac != InstancePtr->Frac)
+	{
+		InstancePtr->Frac = frac;
+		PWMGEN_WriteReg(InstancePtr->BaseAddress, PWMGEN_COMPARE_FRAC_OFFSET, frac);
+	}
+	PWMGEN_WriteReg(InstancePtr->BaseAddress, PWMGEN_COMPARE_OFFSET, compare);
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* PWMGEN_SetDutyHR() - Set a high-resolution duty cycle
+*
+* Sets the duty cycle in percent with a fractional part, for the period last set by
+* PWMGEN_SetParams().  The high time is resolved to 1/65536 of a clock cycle, so a
+* 10KHz PWM from a 100MHz clock has 10,000 x 65,536 (about 29 bits) duty cycle steps
+* instead of 10,000.  Dithering must be on (PWMGEN_SetDither()) for the fraction to
+* take effect.
+*
+* @param    InstancePtr is a pointer to the PWM instance to be worked on.
+* @param	dutyfactor is the PWM high time (in pct of PWM period - 0.0 to 100.0)
+*
+* @return
+*
+*   - XST_SUCCESS if the duty cycle was written
+*   - XST_FAILURE if the PWM instance is not initialized or no period has been set
+*	- XST_INVALID_PARAM if the duty cycle is out of range
+*
+* @note
+* The high time is calculated in 32.16 fixed point:
+* 	HIGH_TIME = PERIOD * (DUTY CYCLE / 100) * 65536
+* 	COMPARE = HIGH_TIME >> 16, COMPARE_FRAC = HIGH_TIME & 0xFFFF
+*
+******************************************************************************/
+int PWMGEN_SetDutyHR(PWMGEN *InstancePtr, float dutyfactor)
+{
+	u64		high_time;
+
+	if ((InstancePtr->IsReady != XIL_COMPONENT_IS_READY) || (InstancePtr->Period == 0))
+	{
+		return XST_FAILURE;
+	}
+
+	if ((dutyfactor < 0.0) || (dutyfactor > 100.0))  // duty cycle must be 0% - 100%
+	{
+		return XST_INVALID_PARAM;
+	}
+
+	// float only has 24 bits of mantissa, so the duty cycle is scaled to a 32-bit
+	// fraction first and the product with the period is done in integer
+	if (dutyfactor >= 100.0)
+	{
+		return PWMGEN_SetCompareFrac(InstancePtr, InstancePtr->Period, 0);
+	}
+	high_time = (u64) ((double) dutyfactor * (4294967296.0 / 100.0));
+	high_time = (high_time * InstancePtr->Period) >> 16;
+
+	return PWMGEN_SetCompareFrac(InstancePtr, (u32) (high_time >> 16), (u16) (high_time & 0xFFFF));
+}
+
+
+/*****************************************************************************/
+/**
+*
+* PWMGEN_SetDeadTime() - Set the dead time of the complementary outputs
+*
+* After every transition of a phase both of its outputs (high side and low side)
+* stay low for the dead time before the switch being turned on follows the PWM.
+* The new dead time takes effect at the next transition.
+*
+* @param    InstancePtr is a pointer to the PWM instance to be worked on.
+* @param    dead_ns is the dead time in nanoseconds (0 = none)
+*
+* @return
+*
+*   - XST_SUCCESS if the dead time was written
+*   - XST_FAILURE if the PWM instance is not initialized
+*	- XST_INVALID_PARAM if the dead time is too long for the hardware
+*
+* @note
+* The dead time is rounded up to whole clock cycles so it is never shorter than asked for.
+*
+******************************************************************************/
+int PWMGEN_SetDeadTime(PWMGEN *InstancePtr, u32 dead_ns)
+{
+	u64		dead_clocks;
+
+	if (InstancePtr->IsReady != XIL_COMPONENT_IS_READY) // check that instance is initialized
+	{
+		return XST_FAILURE;
+	}
+
+	dead_clocks = ((u64) dead_ns * InstancePtr->ClockFreq + 999999999) / 1000000000;
+	if (dead_clocks > PWMGEN_MAX_DEAD_TIME)
+	{
+		return XST_INVALID_PARAM;
+	}
+
+	PWMGEN_WriteReg(InstancePtr->BaseAddress, PWMGEN_DEAD_TIME_OFFSET, (u32) dead_clocks);
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* PWMGEN_SetPhases() - Set the frequency, duty cycle and phase of every phase
+*
+* Sets the PWM frequency shared by all phases and the duty cycle and phase offset of
+* each phase.  Every phase register is written before the compare register of phase 0,
+* so the whole set is taken at the same counter wrap and the PWM keeps running.  Each
+* phase changes at the start of its own period; a phase whose offset moves stays low
+* until its new start, so no pulse is cut short.
+*
+* @param    InstancePtr is a pointer to the PWM instance to be worked on.
+* @param    PWM frequency (in Hz).
+* @param	dutyfactor is an array with the high time of each phase (in pct of PWM
+*			period - 0.0 to 100.0)
+* @param	phase_deg is an array with the phase of each phase (in degrees of the
+*			PWM period - 0.0 to 360.0).  The entry for phase 0 is normally 0.0
+* @param	nphases is the number of entries in the arrays (1 to the number of
+*			phases in the hardware)
+*
+* @return
+*
+*   - XST_SUCCESS if the PWM parameters were loaded
+*   - XST_FAILURE if the PWM instance is not initialized
+*	- XST_INVALID_PARAM if one of the parameters is invalid
+*
+* @note
+* Phases past 'nphases' are left as they are.  A fraction left by PWMGEN_SetDutyHR()
+* is cleared.
+*
+******************************************************************************/
+int PWMGEN_SetPhases(PWMGEN *InstancePtr, u32 freq, const float *dutyfactor, const float *phase_deg, u32 nphases)
+{
+	float	period;
+	u32		phase,
+			offset;
+
+	if (InstancePtr->IsReady != XIL_COMPONENT_IS_READY) // check that instance is initialized
+	{
+		return XST_FAILURE;
+	}
+
+	// check to see if parameters are valid
+	if ((freq == 0) || (nphases == 0) || (nphases > InstancePtr->NumPhases))
+	{
+		return XST_INVALID_PARAM;
+	}
+
+	period = (float) InstancePtr->ClockFreq / freq;
+	if ((period < 2.0) || (period > PWMGEN_MAXCNT))  // period is too short or too long for the counter
+	{
+		return XST_INVALID_PARAM;
+	}
+
+	for (phase = 0; phase < nphases; phase++)
+	{
+		if ((dutyfactor[phase] < 0.0) || (dutyfactor[phase] > 100.0) ||
+			(phase_deg[phase] < 0.0) || (phase_deg[phase] > 360.0))
+		{
+			return XST_INVALID_PARAM;
+		}
+	}
+
+	// period first, then the phases, then COMPARE to arm the update
+	if ((u32) lroundf(period) != InstancePtr->Period)
+	{
+		InstancePtr->Period = (u32) lroundf(period);
+		PWMGEN_WriteReg(InstancePtr->BaseAddress, PWMGEN_PERIOD_OFFSET, InstancePtr->Period);
+	}
+	if (InstancePtr->Frac != 0)
+	{
+		InstancePtr->Frac = 0;
+		PWMGEN_WriteReg(InstancePtr->BaseAddress, PWMGEN_COMPARE_FRAC_OFFSET, 0);
+	}
+
+	for (phase = 0; phase < nphases; phase++)
+	{
+		offset = (u32) lroundf((InstancePtr->Period * phase_deg[phase]) / 360.0);
+		if (offset >= InstancePtr->Period)  // 360 degrees is the same as 0
+		{
+			offset = 0;
+		}
+		PWMGEN_WriteReg(InstancePtr->BaseAddress, PWMGEN_PHASE_OFFSET_OFFSET + 4 * phase, offset);
+
+		if (phase != 0)
+		{
+			PWMGEN_WriteReg(InstancePtr->BaseAddress, PWMGEN_PHASE_COMPARE_OFFSET + 4 * phase,
+				(u32) lroundf((InstancePtr->Period * dutyfactor[phase]) / 100.0));
+		}
+	}
+
+	PWMGEN_WriteReg(InstancePtr->BaseAddress, PWMGEN_COMPARE_OFFSET,
+		(u32) lroundf((InstancePtr->Period * dutyfactor[0]) / 100.0));
+	return XST_SUCCESS;
+}
+
+
+/*****************************************************************************/
+/**
+*
+* PWMGEN_SetInterleaved() - Run every phase at the same duty cycle, evenly interleaved
+*
+* Sets all of the phases in the hardware to the same frequency and duty cycle, with
+* phase k offset by k * 360 / N degrees.  The switching ripple of N interleaved
+* converter stages is then at N times the PWM frequency and partly cancels.  All
+* phases change at the same period boundary.
+*
+* @param    InstancePtr is a pointer to the PWM instance to be worked on.
+* @param    PWM frequency (in Hz).
+* @param	dutyfactor is the high time of every phase (in pct of PWM period - 0.0 to 100.0)
+*
+* @return
+*
+*   - XST_SUCCESS if the PWM parameters were loaded
+*   - XST_FAILURE if the PWM instance is not initialized
+*	- XST_INVALID_PARAM if one of the parameters is invalid
+*
+******************************************************************************/
+int PWMGEN_SetInterleaved(PWMGEN *InstancePtr, u32 freq, float dutyfactor)
+{
+	float	duty[PWMGEN_MAX_PHASES],
+			phase_deg[PWMGEN_MAX_PHASES];
+	u32		phase;
+
+	if (InstancePtr->IsReady != XIL_COMPONENT_IS_READY) // check that instance is initialized
+	{
+		return XST_FAILURE;
+	}
+
+	if ((InstancePtr->NumPhases == 0) || (InstancePtr->NumPhases > PWMGEN_MAX_PHASES))
+	{
+		return XST_FAILURE;
+	}
+
+	for (phase = 0; phase < InstancePtr->NumPhases; phase++)
+	{
+		duty[phase] = dutyfactor;
+		phase_deg[phase] = (360.0 * phase) / InstancePtr->NumPhases;
+	}
+
+	return PWMGEN_SetPhases(InstancePtr, freq, duty, phase_deg, InstancePtr->NumPhases);
+}
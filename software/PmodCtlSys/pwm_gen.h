@@ -0,0 +1,105 @@
+/**
+*
+* @file pwm_gen.h
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* This file contain the constant definitions and function prototypes for pwm_gen.c.
+* pwm_gen.c provides an API for Pulse-width modulation using the PWMGEN peripheral.  The API
+* has the same calls as pwm_tmrctr.c so an application can use either one, but PWMGEN's
+* period and compare registers are double-buffered: new values take effect at the end of
+* the current PWM period, so the PWM never has to be stopped to change them.
+*
+* <pre>
+* MODIFICATION HISTORY:
+*
+* Ver   Who  Date     Changes
+* ----- ---- -------- -----------------------------------------------
+* 1.00a	ri	03/05/16	First release of driver for the PWMGEN peripheral
+* 1.01a	ri	03/08/16	Added dithered (sigma-delta) high-resolution duty cycle
+* 1.02a	ri	03/10/16	Added interleaved phases with dead-time complementary outputs
+* </pre>
+*
+******************************************************************************/
+
+#ifndef PWM_GEN_H	/* prevent circular inclusions */
+#define PWM_GEN_H	/* by using protection macros */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/***************************** Include Files *********************************/
+#include "stdbool.h"
+#include "math.h"
+#include "xil_types.h"
+#include "xil_io.h"
+#include "xstatus.h"
+#include "xparameters.h"
+
+/************************** Constant Definitions *****************************/
+#define PWMGEN_MAXCNT			4294967295.00
+#define PWMGEN_MAX_PHASES		8
+#define PWMGEN_MAX_DEAD_TIME	65535
+
+// register offsets (see pwmgen.v)
+#define PWMGEN_CTRL_OFFSET				0
+#define PWMGEN_PERIOD_OFFSET			4
+#define PWMGEN_COMPARE_OFFSET			8
+#define PWMGEN_STATUS_OFFSET			12
+#define PWMGEN_ACTIVE_PERIOD_OFFSET		16
+#define PWMGEN_ACTIVE_COMPARE_OFFSET	20
+#define PWMGEN_COUNT_OFFSET				24
+#define PWMGEN_PERIODS_OFFSET			28
+#define PWMGEN_LOADS_OFFSET				32
+#define PWMGEN_CLK_FREQ_OFFSET			36
+#define PWMGEN_COMPARE_FRAC_OFFSET		40
+#define PWMGEN_DEAD_TIME_OFFSET			44
+#define PWMGEN_NUM_PHASES_OFFSET		48
+#define PWMGEN_PHASE_OFFSET_OFFSET		64		// + 4 * phase (phases 0 - 7)
+#define PWMGEN_PHASE_COMPARE_OFFSET		96		// + 4 * phase (phases 1 - 7; phase 0 uses COMPARE)
+
+// register bits
+#define PWMGEN_CTRL_ENABLE_MASK			0x00000001
+#define PWMGEN_CTRL_DITHER_MASK			0x00000002
+#define PWMGEN_STATUS_PENDING_MASK		0x00000001
+
+/**************************** Type Definitions *******************************/
+typedef struct {
+	u32		BaseAddress;		// base address of the PWMGEN registers
+	u32		IsReady;			// XIL_COMPONENT_IS_READY once initialized
+	u32		ClockFreq;			// frequency of the clock the PWM counter runs on
+	u32		Period;				// last period written, in clock cycles
+	u16		Frac;				// last compare fraction written, in 1/65536 clock cycles
+	u32		NumPhases;			// number of interleaved phases in the hardware
+} PWMGEN;
+
+/***************** Macros (Inline Functions) Definitions *********************/
+#define PWMGEN_ReadReg(BaseAddress, RegOffset) \
+	Xil_In32((BaseAddress) + (RegOffset))
+
+#define PWMGEN_WriteReg(BaseAddress, RegOffset, Data) \
+	Xil_Out32((BaseAddress) + (RegOffset), (u32)(Data))
+
+/************************** Function Prototypes ******************************/
+int PWMGEN_Initialize(PWMGEN *InstancePtr, u16 DeviceId, bool EnableInterrupts, u32 clkfreq);
+int PWMGEN_Start(PWMGEN *InstancePtr);
+int PWMGEN_Stop(PWMGEN *InstancePtr);
+int PWMGEN_SetParams(PWMGEN *InstancePtr, u32 freq, u32 dutyfactor);
+int PWMGEN_GetParams(PWMGEN *InstancePtr, u32 *freq, u32 *dutyfactor);
+int PWMGEN_SetCompare(PWMGEN *InstancePtr, u32 compare);
+int PWMGEN_SetDither(PWMGEN *InstancePtr, bool enable);
+int PWMGEN_SetCompareFrac(PWMGEN *InstancePtr, u32 compare, u16 frac);
+int PWMGEN_SetDutyHR(PWMGEN *InstancePtr, float dutyfactor);
+int PWMGEN_SetDeadTime(PWMGEN *InstancePtr, u32 dead_ns);
+int PWMGEN_SetPhases(PWMGEN *InstancePtr, u32 freq, const float *dutyfactor, const float *phase_deg, u32 nphases);
+int PWMGEN_SetInterleaved(PWMGEN *InstancePtr, u32 freq, float dutyfactor);
+
+/************************** Variable Definitions *****************************/
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* end of protection macro */
@@ -47,6 +47,7 @@
 #include "PMod544IOR2.h"
 #include "HWDET.h"
 #include "pwm_tmrctr.h"
+#include "pwm_gen.h"
 #include "mb_interface.h"
 
 /****************************************************************************/
@@ -85,10 +86,28 @@
 
 // PWM timer parameters
 // Set PWM frequency = 10KHz, duty cycle increments by 5%
-
+//
+// If the design has the PWMGEN peripheral the LED is driven by it instead of
+// the AXI timer. Its PWM keeps running while the duty cycle changes (a single
+// register write that takes effect at the end of the period), so the PWM_xxx()
+// calls below are mapped onto its driver.
+
+#ifdef XPAR_PWMGEN_0_DEVICE_ID
+#define PWM_TIMER_DEVICE_ID		XPAR_PWMGEN_0_DEVICE_ID
+#define PWM_TIMER_BASEADDR		XPAR_PWMGEN_0_S00_AXI_BASEADDR
+#define PWM_TIMER_HIGHADDR		XPAR_PWMGEN_0_S00_AXI_HIGHADDR
+#define PWM_INSTANCE			PWMGEN
+#define PWM_Initialize			PWMGEN_Initialize
+#define PWM_Start				PWMGEN_Start
+#define PWM_Stop				PWMGEN_Stop
+#define PWM_SetParams			PWMGEN_SetParams
+#define PWM_GetParams			PWMGEN_GetParams
+#else
 #define PWM_TIMER_DEVICE_ID		XPAR_AXI_TIMER_0_DEVICE_ID
 #define PWM_TIMER_BASEADDR		XPAR_AXI_TIMER_0_BASEADDR
 #define PWM_TIMER_HIGHADDR		XPAR_AXI_TIMER_0_HIGHADDR
+#define PWM_INSTANCE			XTmrCtr
+#endif
 #define PWM_FREQUENCY			10000	
 #define PWM_VIN					3.3	
 #define DUTY_CYCLE_CHANGE		2
@@ -105,6 +124,13 @@
 #define INTC_HIGHADDR			XPAR_AXI_INTC_0_HIGHADDR
 #define TIMER_INTERRUPT_ID		XPAR_MICROBLAZE_0_AXI_INTC_AXI_TIMER_0_INTERRUPT_INTR
 #define FIT_INTERRUPT_ID		XPAR_MICROBLAZE_0_AXI_INTC_FIT_TIMER_0_INTERRUPT_INTR
+
+// HWDET measurement-ready interrupt. Only present if the HWDET 'irq' output
+// is connected to the interrupt controller; otherwise the sensor is polled
+
+#ifdef XPAR_MICROBLAZE_0_AXI_INTC_HWDET_0_IRQ_INTR
+#define HWDET_INTERRUPT_ID		XPAR_MICROBLAZE_0_AXI_INTC_HWDET_0_IRQ_INTR
+#endif
 				
 // Fixed Interval timer - 100MHz input clock, 5KHz output clock
 // FIT_COUNT_1MSEC = FIT_CLOCK_FREQ_HZ * .001
@@ -118,6 +144,21 @@
 
 #define NUM_FRQ_SAMPLES			250	
 
+// the sensor is read over this many whole PWM periods (HWDET carrier-synchronous
+// windows), so the LED ripple at PWM_FREQUENCY doesn't alias into sample[].
+// 10 periods at 10KHz = 1ms per reading; 0 = use the last complete sensor period
+
+#define SENSOR_SYNC_PERIODS		10
+
+// the HWDET interrupt is only used for the synchronous windows (one interrupt
+// per window, 1KHz with the settings above). Without them it would have to fire
+// on every sensor period, up to 500K times a second at full light, so the
+// sensor is polled instead
+
+#if defined(HWDET_INTERRUPT_ID) && (SENSOR_SYNC_PERIODS != 0)
+#define SENSOR_USE_IRQ
+#endif
+
 /****************************************************************************/
 /***************** Macros (Inline Functions) Definitions ********************/
 /****************************************************************************/
@@ -155,8 +196,9 @@ typedef struct {
 // Microblaze peripheral instances
 
 XIntc 	IntrptCtlrInst;								// Interrupt Controller instance
-XTmrCtr	PWMTimerInst;								// PWM timer instance
+PWM_INSTANCE	PWMTimerInst;						// PWM timer (or PWMGEN) instance
 XGpio	GPIOInst;									// GPIO instance
+HWDET	HWDETInst;									// HWDET instance
 
 // The following variables are shared between non-interrupt processing and
 // interrupt processing such that they must be global and declared volatile) -
@@ -165,6 +207,12 @@ XGpio	GPIOInst;									// GPIO instance
 volatile unsigned long	timestamp;					// timestamp since the program began
 volatile u32			gpio_port = 0;				// GPIO port register - maintained in program
 
+// sensor_updates is counted by the HWDET interrupt handler; sensor_freq is
+// worked out from the window it reports by get_sensor_freq()
+
+unsigned int			sensor_freq = 0;			// latest sensor frequency from HWDET
+volatile unsigned int	sensor_updates = 0;			// number of HWDET synchronous window interrupts
+
 // The following variables are shared between the functions in the program
 // such that they must be global
 
@@ -199,6 +247,8 @@ float 			freq2volt(short freq); 									// converts sensor frequency --> voltag
 
 void			delay_msecs(u32 msecs);									// busy-wait delay for "msecs" milliseconds
 void			FIT_Handler(void);										// fixed interval timer interrupt handler
+void			HWDET_Callback(void *CallBackRef, u32 IrqStatus);		// HWDET measurement-ready callback
+unsigned int	get_sensor_freq(void);									// latest sensor frequency (Hz)
 
 void			update_lcd(int vin_dccnt, short vout_frqcnt);			// updates the LCD display
 unsigned		update_menu(sPID * testPIDptr);							// updates the PID menu interface
@@ -661,7 +711,7 @@ XStatus DoTest_Characterize(void) {
         // then make the light sensor measurement
 		
 		delay_msecs(50);
-		sample[smpl_idx++] = HWDET_calc_freq();
+		sample[smpl_idx++] = HWDET_calc_freq(&HWDETInst);
 		
 		n++;
 	}		
@@ -715,13 +765,15 @@ XStatus do_init(void) {
 
 	// initialize the HWDET
 
-	status = HWDET_initialize(HWDET_BASEADDR);
+	status = HWDET_initialize(&HWDETInst, HWDET_DEVICE_ID);
 
 	if (status != XST_SUCCESS) {
 		xil_printf("\nFailed on HWDET initialization!\n");
 		return XST_FAILURE;
 	}
 
+	HWDET_set_sync_window(&HWDETInst, SENSOR_SYNC_PERIODS);
+
 	// initialize the GPIO instance
 
 	status = XGpio_Initialize(&GPIOInst, GPIO_DEVICE_ID);
@@ -761,6 +813,22 @@ XStatus do_init(void) {
     if (status != XST_SUCCESS) {
         return XST_FAILURE;
     }
+
+#ifdef SENSOR_USE_IRQ
+
+	// connect the HWDET handler to the interrupt and have it report
+	// every time a synchronous window closes
+
+    status = XIntc_Connect(&IntrptCtlrInst, HWDET_INTERRUPT_ID, (XInterruptHandler)HWDET_InterruptHandler, &HWDETInst);
+
+    if (status != XST_SUCCESS) {
+        return XST_FAILURE;
+    }
+
+    HWDET_SetHandler(&HWDETInst, HWDET_Callback, &HWDETInst);
+    HWDET_EnableInterrupt(&HWDETInst, HWDET_IRQ_SYNC_MASK);
+
+#endif
  
  	// start the interrupt controller such that interrupts are enabled for
 	// all devices that cause interrupts, specifically real mode so that
@@ -776,6 +844,14 @@ XStatus do_init(void) {
 
     XIntc_Enable(&IntrptCtlrInst, FIT_INTERRUPT_ID);
 
+#ifdef SENSOR_USE_IRQ
+
+    // enable the HWDET interrupt
+
+    XIntc_Enable(&IntrptCtlrInst, HWDET_INTERRUPT_ID);
+
+#endif
+
     // all initialization completed successfully... return from function now
 
 	return XST_SUCCESS;
@@ -958,6 +1034,77 @@ void FIT_Handler(void) {
 	}
 }
 
+/****************************************************************************
+ * HWDET_Callback() - HWDET measurement-ready callback
+ *  
+ * called from HWDET_InterruptHandler() whenever a synchronous window
+ * closes. It only counts the windows in "sensor_updates"; the frequency
+ * (float math) is worked out by get_sensor_freq() outside the interrupt
+ * handler, once per window
+ *
+ ****************************************************************************/
+
+void HWDET_Callback(void *CallBackRef, u32 IrqStatus) {
+
+	(void) CallBackRef;
+
+	if (IrqStatus & HWDET_IRQ_SYNC_MASK) {
+		sensor_updates++;
+	}
+}
+
+/****************************************************************************
+ * get_sensor_freq() - returns the latest sensor frequency (Hz)
+ *  
+ * reads the last synchronous window (whole PWM periods, see
+ * SENSOR_SYNC_PERIODS). A window with fewer than two sensor edges gives no
+ * reading, so the hardware divider result is used instead, as it is with
+ * the windows off. When the interrupt is in use (see SENSOR_USE_IRQ) the
+ * window is only read once after the handler reports it, and the result
+ * is kept in "sensor_freq" until the next one.
+ *
+ * with the LED dim the sensor period gets long; once the period in progress
+ * has outlasted the last one, the HWDET estimate is used instead so the loop
+ * reacts right away rather than one (long) period later
+ *
+ ****************************************************************************/
+
+unsigned int get_sensor_freq(void) {
+
+#ifdef SENSOR_USE_IRQ
+	static unsigned int	windows = 0;		// "sensor_updates" when "sensor_freq" was worked out
+#endif
+	float freq;
+
+	if (HWDET_is_stale(&HWDETInst)) {
+		return HWDET_get_freq_estimate(&HWDETInst);
+	}
+
+#ifdef SENSOR_USE_IRQ
+	if (sensor_updates == windows) {
+		return sensor_freq;
+	}
+
+	windows = sensor_updates;
+#else
+	if (SENSOR_SYNC_PERIODS == 0) {
+		return HWDET_ReadFreqHz(HWDETInst.BaseAddress);
+	}
+#endif
+
+	freq = HWDET_get_freq_sync(&HWDETInst);
+
+	if (freq > 0.0f) {
+		sensor_freq = (unsigned int) (freq + 0.5f);
+	}
+
+	else {
+		sensor_freq = HWDET_ReadFreqHz(HWDETInst.BaseAddress);
+	}
+
+	return sensor_freq;
+}
+
 /****************************************************************************
  * DoTest_BangBang() - On/off control loop algorithm
  *  
@@ -1011,10 +1158,11 @@ XStatus DoTest_BangBang(unsigned int setpoint) {
 	while (smpl_idx < NUM_FRQ_SAMPLES) {
 
 		// light sensor measurement using HWDET...
+		// frequency over the last synchronous window (see get_sensor_freq())
 		// store values in global array sample[ ]
 		// also, increment the sample index
 
-		sensor_value = HWDET_calc_freq();
+		sensor_value = get_sensor_freq();
 		sample[smpl_idx++] = sensor_value;
 
 		// bang-bang control algorithm (in one line)
@@ -1127,10 +1275,11 @@ XStatus DoTest_PID(unsigned int setpoint, sPID * PID) {
 	while (smpl_idx < NUM_FRQ_SAMPLES) {
 
 		// light sensor measurement using HWDET...
+		// frequency over the last synchronous window (see get_sensor_freq())
 		// store values in global array sample[ ]
 		// also, increment the sample index
 
-		sensor_value = HWDET_calc_freq();
+		sensor_value = get_sensor_freq();
 		sample[smpl_idx++] = sensor_value;
 
 
@@ -0,0 +1,353 @@
+/**
+*
+* @file divbench.c
+*
+* @author Rehan Iqbal (riqbal@pdx.edu)
+* @copyright Portland State University, 2016
+*
+* Description:
+*
+* This program compares the two ways the HWDET driver can turn a measured period into a
+* frequency or duty cycle: the C '/' operator and the reciprocal divide in HWDET_div_u32()
+* (see HWDET_DIV in HWDET.h). On a MicroBlaze without the optional hardware divider every
+* '/' is a call to a library routine, which matters inside the control loop.
+*
+* For a table of periods spread over the range the TSL235R can produce (500kHz down to
+* 0.4Hz at 100MHz), the program times both versions of the frequency and duty cycle
+* calculations with the HWDET cycle counter and checks every result against the exact
+* one. It prints the average cycles per calculation and the largest error.
+*
+* The duty cycle calculations follow HWDET_duty_pct(), so high intervals too long for
+* 100 * high to fit in 32 bits (above about 43M clocks) are timed and checked as well.
+*
+* Run it once on a MicroBlaze built with the hardware divider and once without it, then
+* set HWDET_DIV_RECIP for the applications if the default choice is not the faster one.
+*
+* Configuration Notes:
+*
+* The minimal hardware configuration for this test is a Microblaze-based system with at least 32KB of memory,
+* an instance of HWDET clocked at the CPU clock (its cycle counter is used as the time base) and an
+* instance of an axi_uartlite (used for xil_printf() console output)
+*/
+
+/****************************************************************************/
+/***************************** Include Files ********************************/
+/****************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "xparameters.h"
+#include "xstatus.h"
+#include "xil_printf.h"
+#include "platform.h"
+#include "HWDET.h"
+
+/****************************************************************************/
+/************************** Constant Definitions ****************************/
+/****************************************************************************/
+
+// Clock frequencies
+
+#define CPU_CLOCK_FREQ_HZ		XPAR_CPU_CORE_CLOCK_FREQ_HZ
+
+// HWDET parameters
+
+#define HWDET_DEVICE_ID			XPAR_HWDET_0_DEVICE_ID
+
+// Benchmark parameters
+
+#define NUM_PERIODS				256				// periods in the test table
+#define NUM_PASSES				16				// timed passes over the table
+#define MIN_PERIOD				200				// 500kHz at 100MHz
+#define MAX_PERIOD				250000000		// 0.4Hz at 100MHz
+#define NUM_SWEEP				100000			// consecutive periods checked for errors
+
+/****************************************************************************/
+/************************** Variable Definitions ****************************/
+/****************************************************************************/
+
+HWDET			HWDETInst;						// HWDET instance (cycle counter)
+
+u32				period[NUM_PERIODS];			// measured periods, in clock cycles
+u32				high[NUM_PERIODS];				// high intervals, in clock cycles
+volatile u32	result;							// keeps the compiler from dropping the loops
+
+/****************************************************************************/
+/************************** Function Prototypes *****************************/
+/****************************************************************************/
+
+void 	fill_table(void);									// spreads the periods over the valid range
+u32 	time_freq_div(void);								// cycles for the frequency table with '/'
+u32 	time_freq_recip(void);								// cycles for the frequency table with HWDET_div_u32()
+u32 	time_duty_div(void);								// cycles for the duty cycle table with '/'
+u32 	time_duty_recip(void);								// cycles for the duty cycle table with HWDET_div_u32()
+u32 	duty_div(u32 h, u32 p);								// HWDET_duty_pct() with '/'
+u32 	duty_recip(u32 h, u32 p);							// HWDET_duty_pct() with HWDET_div_u32()
+u32 	time_empty(void);									// cycles for the loop overhead
+u32 	check_errors(u32 *max_err);							// compares both versions with the exact results
+
+/****************************************************************************/
+/************************** MAIN PROGRAM ************************************/
+/****************************************************************************/
+
+int main() {
+
+	XStatus status;
+	u32 overhead;
+	u32 max_err = 0;
+	u32 mismatches;
+	u32 calcs = NUM_PERIODS * NUM_PASSES;
+
+	init_platform();
+
+	status = HWDET_initialize(&HWDETInst, HWDET_DEVICE_ID);
+
+	if (status != XST_SUCCESS) {
+		xil_printf("\nFailed on HWDET initialization!\n");
+		return XST_FAILURE;
+	}
+
+	xil_printf("\nECE 544 HWDET divide benchmark\n");
+	xil_printf("HWDET_DIV_RECIP = %d, hardware divider = %s\n", HWDET_DIV_RECIP,
+#if defined(XPAR_MICROBLAZE_USE_DIV) && (XPAR_MICROBLAZE_USE_DIV == 0)
+				"no");
+#else
+				"yes");
+#endif
+
+	fill_table();
+
+	// cycles per calculation, with the loop overhead taken out
+
+	overhead = time_empty();
+
+	xil_printf("\ncycles per calculation (%d periods x %d passes)\n", NUM_PERIODS, NUM_PASSES);
+	xil_printf("freq '/'           : %d\n", (time_freq_div() - overhead) / calcs);
+	xil_printf("freq HWDET_div_u32 : %d\n", (time_freq_recip() - overhead) / calcs);
+	xil_printf("duty '/'           : %d\n", (time_duty_div() - overhead) / calcs);
+	xil_printf("duty HWDET_div_u32 : %d\n", (time_duty_recip() - overhead) / calcs);
+
+	// every result should match the exact (64-bit) one
+
+	mismatches = check_errors(&max_err);
+
+	xil_printf("\nerrors: %d mismatches, largest error %d\n", mismatches, max_err);
+	xil_printf("%s\n", (mismatches == 0) ? "PASS" : "FAIL");
+
+	cleanup_platform();
+
+	return 0;
+}
+
+/****************************************************************************/
+/************************** Benchmark Functions *****************************/
+/****************************************************************************/
+
+/* 	fill_table - spreads the periods over the valid range
+
+	each period is 1/16 larger than the last (wrapping back to the low end), so
+	every divisor size from MIN_PERIOD to MAX_PERIOD is covered. the high
+	intervals give duty cycles from 1% to 99%
+*/
+
+void fill_table(void) {
+
+	unsigned int i;
+	u32 p = MIN_PERIOD;
+
+	for (i = 0; i < NUM_PERIODS; i++) {
+
+		period[i] = p;
+		high[i] = (u32) (((u64) p * ((i % 99) + 1)) / 100);
+
+		p += (p >> 4) + (i & 0x7);
+
+		if (p > MAX_PERIOD) {
+			p = MIN_PERIOD + i;
+		}
+	}
+}
+
+/****************************************************************************/
+
+/* 	time_xxx - cycles for NUM_PASSES passes over the table
+
+	the frequency loops do what HWDET_scale_freq() does for range 0, and the
+	duty cycle loops what HWDET_duty_pct() does for HWDET_get_measurement()
+*/
+
+u32 time_freq_div(void) {
+
+	unsigned int i, n;
+	u32 sum = 0;
+	u64 start = HWDET_get_cycle_count(&HWDETInst);
+
+	for (n = 0; n < NUM_PASSES; n++) {
+		for (i = 0; i < NUM_PERIODS; i++) {
+			sum += CPU_CLOCK_FREQ_HZ / period[i];
+		}
+	}
+
+	result = sum;
+	return (u32) (HWDET_get_cycle_count(&HWDETInst) - start);
+}
+
+u32 time_freq_recip(void) {
+
+	unsigned int i, n;
+	u32 sum = 0;
+	u64 start = HWDET_get_cycle_count(&HWDETInst);
+
+	for (n = 0; n < NUM_PASSES; n++) {
+		for (i = 0; i < NUM_PERIODS; i++) {
+			sum += HWDET_div_u32(CPU_CLOCK_FREQ_HZ, period[i]);
+		}
+	}
+
+	result = sum;
+	return (u32) (HWDET_get_cycle_count(&HWDETInst) - start);
+}
+
+u32 time_duty_div(void) {
+
+	unsigned int i, n;
+	u32 sum = 0;
+	u64 start = HWDET_get_cycle_count(&HWDETInst);
+
+	for (n = 0; n < NUM_PASSES; n++) {
+		for (i = 0; i < NUM_PERIODS; i++) {
+			sum += duty_div(high[i] + 1, period[i]);
+		}
+	}
+
+	result = sum;
+	return (u32) (HWDET_get_cycle_count(&HWDETInst) - start);
+}
+
+u32 time_duty_recip(void) {
+
+	unsigned int i, n;
+	u32 sum = 0;
+	u64 start = HWDET_get_cycle_count(&HWDETInst);
+
+	for (n = 0; n < NUM_PASSES; n++) {
+		for (i = 0; i < NUM_PERIODS; i++) {
+			sum += duty_recip(high[i] + 1, period[i]);
+		}
+	}
+
+	result = sum;
+	return (u32) (HWDET_get_cycle_count(&HWDETInst) - start);
+}
+
+u32 time_empty(void) {
+
+	unsigned int i, n;
+	u32 sum = 0;
+	u64 start = HWDET_get_cycle_count(&HWDETInst);
+
+	for (n = 0; n < NUM_PASSES; n++) {
+		for (i = 0; i < NUM_PERIODS; i++) {
+			sum += period[i] ^ high[i];
+		}
+	}
+
+	result = sum;
+	return (u32) (HWDET_get_cycle_count(&HWDETInst) - start);
+}
+
+/****************************************************************************/
+
+/* 	duty_xxx - HWDET_duty_pct() built with either divide
+
+	100 * h overflows 32 bits above about 43M clocks. the quotient is then
+	estimated from h and p shifted right by 7 bits and corrected with 64-bit
+	multiplies, as in the driver
+*/
+
+u32 duty_div(u32 h, u32 p) {
+
+	u64 n = 100 * (u64) h;
+	u32 q;
+
+	if (p == 0) return 0;
+	if (h >= p) return 100;
+	if (n <= 0xFFFFFFFF) return (u32) n / p;
+
+	q = (u32) (n >> 7) / (p >> 7);
+
+	while ((u64) q * p > n) q--;
+	while ((u64) (q + 1) * p <= n) q++;
+
+	return q;
+}
+
+u32 duty_recip(u32 h, u32 p) {
+
+	u64 n = 100 * (u64) h;
+	u32 q;
+
+	if (p == 0) return 0;
+	if (h >= p) return 100;
+	if (n <= 0xFFFFFFFF) return HWDET_div_u32((u32) n, p);
+
+	q = HWDET_div_u32((u32) (n >> 7), p >> 7);
+
+	while ((u64) q * p > n) q--;
+	while ((u64) (q + 1) * p <= n) q++;
+
+	return q;
+}
+
+/****************************************************************************/
+
+/* 	check_errors - compares both versions against the exact results
+
+	checks the table, then NUM_SWEEP consecutive periods from MIN_PERIOD, and
+	returns the number of results that differ. the exact duty cycle is taken
+	with a 64-bit divide. max_err is set to the largest difference in Hz (or %)
+*/
+
+u32 check_errors(u32 *max_err) {
+
+	unsigned int i;
+	u32 exact, recip, err;
+	u32 mismatches = 0;
+
+	*max_err = 0;
+
+	for (i = 0; i < NUM_PERIODS + NUM_SWEEP; i++) {
+
+		u32 p = (i < NUM_PERIODS) ? period[i] : (MIN_PERIOD + i - NUM_PERIODS);
+		u32 h = (i < NUM_PERIODS) ? high[i] : (p >> 1);
+
+		exact = CPU_CLOCK_FREQ_HZ / p;
+		recip = HWDET_div_u32(CPU_CLOCK_FREQ_HZ, p);
+		err = (exact > recip) ? (exact - recip) : (recip - exact);
+
+		if (err != 0) {
+			mismatches++;
+			*max_err = MAX(*max_err, err);
+		}
+
+		exact = (u32) ((100 * ((u64) h + 1)) / p);
+		recip = duty_recip(h + 1, p);
+		err = (exact > recip) ? (exact - recip) : (recip - exact);
+
+		if (err != 0) {
+			mismatches++;
+			*max_err = MAX(*max_err, err);
+		}
+
+		recip = duty_div(h + 1, p);
+		err = (exact > recip) ? (exact - recip) : (recip - exact);
+
+		if (err != 0) {
+			mismatches++;
+			*max_err = MAX(*max_err, err);
+		}
+	}
+
+	return mismatches;
+}
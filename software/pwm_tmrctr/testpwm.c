@@ -134,6 +134,7 @@
 XIntc 	IntrptCtlrInst;						// Interrupt Controller instance
 XTmrCtr	PWMTimerInst;						// PWM timer instance
 XGpio	GPIOInst0;							// GPIO instance - used for PWM duty & AXI Timer
+HWDET	HWDETInst;							// HWDET instance
 
 // The following variables are shared between non-interrupt processing and
 // interrupt processing such that they must be global(and declared volatile)
@@ -331,8 +332,8 @@ int main() {
 
 					if (hw_switch) {
 
-						detect_freq = HWDET_calc_freq();
-						detect_duty = HWDET_calc_duty();
+						detect_freq = HWDET_calc_freq(&HWDETInst);
+						detect_duty = HWDET_calc_duty(&HWDETInst);
 					}
 
 					else {
@@ -418,7 +419,7 @@ int do_init(void) {
 		return XST_FAILURE;
 	}
 	
-	status = HWDET_initialize(HWDET_BASEADDR);
+	status = HWDET_initialize(&HWDETInst, HWDET_DEVICE_ID);
 
 	if (status != XST_SUCCESS) {
 		xil_printf("\nFailed on HWDET initialization!\n");
@@ -638,8 +639,8 @@ void FIT_Handler(void) {
 
 	// update HWDET high & low counts by reading GPIO
 
-	hw_high_count = HWDET_get_count(high_reg);
-	hw_low_count  = HWDET_get_count(low_reg);
+	hw_high_count = HWDET_get_count(&HWDETInst, high_reg);
+	hw_low_count  = HWDET_get_count(&HWDETInst, low_reg);
 
 	// update the SWDET high & low counts through state machine
 	// this detect low-to-high and high-to-low transitions
@@ -699,7 +700,7 @@ unsigned int calc_freq(unsigned int high, unsigned int low, bool hw_switch) {
 	unsigned int frq;
 
 	sum = (high + 1) + (low + 1);
-	frq = hw_switch ? (CPU_CLOCK_FREQ_HZ / sum) : (FIT_CLOCK_FREQ_HZ / sum);
+	frq = hw_switch ? HWDET_DIV(CPU_CLOCK_FREQ_HZ, sum) : HWDET_DIV(FIT_CLOCK_FREQ_HZ, sum);
 
 	return frq;
 };
@@ -717,7 +718,7 @@ unsigned int calc_duty(unsigned int high, unsigned int low) {
 	unsigned int duty;
 
 	sum = (high + 1) + (low + 1);
-	duty = (100 * (high + 1)) / sum;
+	duty = HWDET_duty_pct(high + 1, sum);
 
 	return duty;
 };